@@ -0,0 +1,300 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como capture.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Load captured host traffic.
+ *
+ */
+
+#include "private.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+
+#include <arpa_telnet.h>
+
+/// @brief Host side of a TN3270 negotiation, used to replay record captures.
+static const unsigned char tn3270_negotiation[] = {
+	IAC, DO, TELOPT_TTYPE,
+	IAC, SB, TELOPT_TTYPE, TELQUAL_SEND, IAC, SE,
+	IAC, DO, TELOPT_EOR,
+	IAC, WILL, TELOPT_EOR,
+	IAC, DO, TELOPT_BINARY,
+	IAC, WILL, TELOPT_BINARY
+};
+
+/*---[ Implement ]------------------------------------------------------------------------------------------*/
+
+static int hexvalue(int c) {
+	if(c >= '0' && c <= '9')
+		return c - '0';
+	c = tolower(c);
+	if(c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	return -1;
+}
+
+static BENCHMARK_BLOCK * new_block(BENCHMARK_CAPTURE *capture) {
+
+	if(capture->length >= capture->size) {
+		capture->size += 256;
+		capture->blocks = realloc(capture->blocks,capture->size * sizeof(BENCHMARK_BLOCK));
+	}
+
+	BENCHMARK_BLOCK *block = capture->blocks + capture->length++;
+	memset(block,0,sizeof(BENCHMARK_BLOCK));
+	return block;
+
+}
+
+static void append(BENCHMARK_CAPTURE *capture, BENCHMARK_BLOCK *block, const unsigned char *data, size_t length) {
+	block->data = realloc(block->data,block->length+length);
+	memcpy(block->data+block->length,data,length);
+	block->length += length;
+	capture->bytes += length;
+}
+
+/// @brief Check for a record line (optional direction followed by hex pairs only).
+static int is_record(const char *line) {
+
+	size_t digits = 0;
+
+	if(*line == '<' || *line == '>')
+		line++;
+
+	for(;*line;line++) {
+		if(isspace(*line))
+			continue;
+		if(hexvalue(*line) < 0)
+			return 0;
+		digits++;
+	}
+
+	return digits && !(digits % 2);
+}
+
+/// @brief Add a record with TN3270 framing (IACs doubled, IAC EOR).
+static void append_record(BENCHMARK_CAPTURE *capture, const char *line) {
+
+	BENCHMARK_BLOCK *block = new_block(capture);
+
+	while(*line) {
+
+		if(isspace(*line)) {
+			line++;
+			continue;
+		}
+
+		unsigned char c = (unsigned char) ((hexvalue(line[0]) << 4) | hexvalue(line[1]));
+		line += 2;
+
+		append(capture,block,&c,1);
+		if(c == IAC)
+			append(capture,block,&c,1);
+
+	}
+
+	static const unsigned char eor[] = { IAC, EOR };
+	append(capture,block,eor,sizeof(eor));
+
+}
+
+BENCHMARK_CAPTURE * benchmark_capture_load(const char *filename) {
+
+	FILE				* in = fopen(filename,"r");
+	BENCHMARK_CAPTURE	* capture;
+	BENCHMARK_BLOCK		* block		= NULL;		// Current trace block (NULL for client data).
+	char				  hi[1024];				// High nibbles from network trace.
+	unsigned int		  group		= 0;		// Line in network trace group.
+	int					  netdata	= 0;		// Inside a network trace block.
+	int					  records	= 0;		// Record capture.
+	char				  line[65536];
+
+	if(!in) {
+		perror(filename);
+		return NULL;
+	}
+
+	capture = calloc(1,sizeof(BENCHMARK_CAPTURE));
+	capture->filename = filename;
+
+	while(fgets(line,sizeof(line),in)) {
+
+		char			* ptr;
+		char			  direction;
+		unsigned int	  offset;
+		int				  skip;
+
+		// Remove line terminator.
+		for(ptr = line + strlen(line); ptr > line && (ptr[-1] == '\n' || ptr[-1] == '\r'); ptr--)
+			ptr[-1] = 0;
+
+		if(!*line)
+			continue;
+
+		if((*line == '<' || *line == '>') && line[1] == ' ' && strstr(line," data len=")) {
+
+			// Network trace header: "< date time RECV data len=n"
+			netdata = 1;
+			group = 0;
+			block = (*line == '<') ? new_block(capture) : NULL;
+
+		} else if(netdata && *line == '\t') {
+
+			// Network trace data: text, high nibbles and low nibbles.
+			switch(group++ % 3) {
+			case 1:
+				strncpy(hi,line+1,sizeof(hi)-1);
+				hi[sizeof(hi)-1] = 0;
+				break;
+
+			case 2:
+				if(block) {
+					size_t ix;
+					for(ix = 0; hi[ix] && line[ix+1]; ix++) {
+						unsigned char c = (unsigned char) ((hexvalue(hi[ix]) << 4) | hexvalue(line[ix+1]));
+						append(capture,block,&c,1);
+					}
+				}
+				break;
+			}
+
+		} else if(sscanf(line,"%c 0x%x %n",&direction,&offset,&skip) == 2 && (direction == '<' || direction == '>') && !strncmp(line+1," 0x",3)) {
+
+			// Data stream trace: "< 0x0   f5c3..."
+			netdata = 0;
+
+			if(!offset)
+				block = (direction == '<') ? new_block(capture) : NULL;
+
+			if(block) {
+				for(ptr = line+skip; hexvalue(ptr[0]) >= 0 && hexvalue(ptr[1]) >= 0; ptr += 2) {
+					unsigned char c = (unsigned char) ((hexvalue(ptr[0]) << 4) | hexvalue(ptr[1]));
+					append(capture,block,&c,1);
+				}
+			}
+
+		} else if(*line != '#' && is_record(line)) {
+
+			// Simulator capture, one record per line.
+			netdata = 0;
+			block = NULL;
+
+			if(!records) {
+				append(capture,new_block(capture),tn3270_negotiation,sizeof(tn3270_negotiation));
+				records = 1;
+			}
+
+			if(*line != '>')
+				append_record(capture,(*line == '<') ? line+1 : line);
+
+		}
+
+	}
+
+	fclose(in);
+
+	// Remove empty blocks.
+	{
+		size_t src, dst = 0;
+		for(src = 0; src < capture->length; src++) {
+			if(capture->blocks[src].length)
+				capture->blocks[dst++] = capture->blocks[src];
+			else
+				free(capture->blocks[src].data);
+		}
+		capture->length = dst;
+	}
+
+	if(!capture->bytes) {
+		fprintf(stderr,"%s: No host data\n",filename);
+		benchmark_capture_free(capture);
+		return NULL;
+	}
+
+	return capture;
+
+}
+
+void benchmark_capture_free(BENCHMARK_CAPTURE *capture) {
+
+	size_t ix;
+
+	if(!capture)
+		return;
+
+	for(ix = 0; ix < capture->length; ix++)
+		free(capture->blocks[ix].data);
+
+	free(capture->blocks);
+	free(capture);
+
+}
+
+int benchmark_capture_rechunk(BENCHMARK_CAPTURE *capture, size_t chunk) {
+
+	size_t				  ix;
+	size_t				  offset = 0;
+	unsigned char		* stream;
+	BENCHMARK_BLOCK		* blocks;
+	size_t				  length = 0;
+
+	if(!chunk)
+		return 0;
+
+	stream = malloc(capture->bytes);
+	for(ix = 0; ix < capture->length; ix++) {
+		memcpy(stream+offset,capture->blocks[ix].data,capture->blocks[ix].length);
+		offset += capture->blocks[ix].length;
+		free(capture->blocks[ix].data);
+	}
+
+	blocks = calloc((capture->bytes / chunk) + 1,sizeof(BENCHMARK_BLOCK));
+
+	for(offset = 0; offset < capture->bytes; offset += chunk) {
+		size_t sz = capture->bytes - offset;
+		if(sz > chunk)
+			sz = chunk;
+		blocks[length].length = sz;
+		blocks[length].data = malloc(sz);
+		memcpy(blocks[length].data,stream+offset,sz);
+		length++;
+	}
+
+	free(stream);
+	free(capture->blocks);
+
+	capture->blocks = blocks;
+	capture->length = length;
+	capture->size = length;
+
+	return 0;
+}
@@ -0,0 +1,141 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como charset.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Charset conversion benchmark.
+ *
+ * Converts a buffer with every EBCDIC code through the bulk converters of each
+ * host code page and compares them with a byte at a time table lookup.
+ *
+ */
+
+#include "private.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include <lib3270.h>
+#include <lib3270/charset.h>
+
+/// @brief Buffer size, about the size of a DFT transfer block.
+#define BUFFER_LENGTH	65536
+
+static const char * codepages[] = { "us", "bracket", "cp500" };
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+static double mbytes_per_second(unsigned int iterations, double seconds) {
+	return seconds > 0 ? (((double) BUFFER_LENGTH) * iterations) / (seconds * 1000000.0) : 0.0;
+}
+
+static int benchmark_codepage(H3270 *hSession, const char *codepage, unsigned int iterations) {
+	unsigned char	  table[256];
+	unsigned char	* source	= malloc(BUFFER_LENGTH);
+	unsigned char	* expected	= malloc(BUFFER_LENGTH);
+	unsigned char	* buffer	= malloc(BUFFER_LENGTH);
+	unsigned int	  iteration;
+	size_t			  ix;
+	double			  started, scalar, bulk, utf8;
+	int				  rc		= 0;
+
+	if(lib3270_set_host_charset(hSession,codepage)) {
+		fprintf(stderr,"%s: %s\n",codepage,strerror(errno));
+		rc = errno;
+	}
+
+	for(ix = 0; ix < 256; ix++)
+		table[ix] = (unsigned char) ix;
+	lib3270_ebc2asc(hSession,table,256);
+
+	for(ix = 0; ix < BUFFER_LENGTH; ix++)
+		source[ix] = (unsigned char) ((ix * 7) + (ix >> 8));
+
+	// Byte at a time reference.
+	started = now();
+	for(iteration = 0; iteration < iterations; iteration++) {
+		for(ix = 0; ix < BUFFER_LENGTH; ix++)
+			expected[ix] = table[source[ix]];
+	}
+	scalar = now() - started;
+
+	started = now();
+	for(iteration = 0; iteration < iterations; iteration++) {
+		memcpy(buffer,source,BUFFER_LENGTH);
+		lib3270_ebc2asc(hSession,buffer,BUFFER_LENGTH);
+	}
+	bulk = now() - started;
+
+	if(!rc && memcmp(buffer,expected,BUFFER_LENGTH)) {
+		fprintf(stderr,"%s: Bulk conversion doesn't match the table\n",codepage);
+		rc = EINVAL;
+	}
+
+	started = now();
+	for(iteration = 0; iteration < iterations; iteration++)
+		lib3270_free(lib3270_ebc2utf8(hSession,source,BUFFER_LENGTH));
+	utf8 = now() - started;
+
+	if(!rc) {
+		printf(
+			"%-10s %14.0f %14.0f %14.0f\n",
+				codepage,
+				mbytes_per_second(iterations,scalar),
+				mbytes_per_second(iterations,bulk),
+				mbytes_per_second(iterations,utf8)
+		);
+	}
+
+	free(source);
+	free(expected);
+	free(buffer);
+
+	return rc;
+}
+
+int benchmark_charset(unsigned int iterations) {
+	H3270	* hSession	= lib3270_session_new("");
+	size_t	  ix;
+	int		  rc		= 0;
+
+	printf("Converting %u blocks of %u bytes (MB/sec)\n\n",iterations,(unsigned int) BUFFER_LENGTH);
+	printf("%-10s %14s %14s %14s\n","Codepage","Table lookup","ebc2asc","ebc2utf8");
+
+	for(ix = 0; ix < (sizeof(codepages)/sizeof(codepages[0])) && !rc; ix++)
+		rc = benchmark_codepage(hSession,codepages[ix],iterations);
+
+	lib3270_session_free(hSession);
+
+	return rc;
+}
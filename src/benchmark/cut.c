@@ -0,0 +1,341 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como cut.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief CUT file transfer benchmark.
+ *
+ * Runs a CUT mode IND$FILE transfer in each direction on a replay session: the
+ * host frames are built here and injected with lib3270_data_recv(), so the time
+ * measured is the client side frame processing and data conversion.
+ *
+ */
+
+#include "private.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <lib3270.h>
+#include <lib3270/internals.h>
+#include <lib3270/charset.h>
+#include <lib3270/filetransfer.h>
+
+/// @brief Frames on each direction per iteration.
+#define CUT_FRAMES		16
+
+/// @brief Data bytes on each host data frame.
+#define CUT_FRAME_DATA	1900
+
+#define CUT_OPTIONS		(LIB3270_FT_OPTION_ASCII|LIB3270_FT_OPTION_CRLF|LIB3270_FT_OPTION_REMAP)
+
+/// @brief CUT alphabet (same as ft_cut.c).
+static const char alphas[] = " ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789%&_()<+,-./:>?";
+
+/// @brief 6 bit encoding (same as ft_cut.c).
+static const char table6[] = "abcdefghijklmnopqrstuvwxyz&-.,:+ABCDEFGHIJKLMNOPQRSTUVWXYZ012345";
+
+typedef struct _cut_transfer {
+	unsigned long	  current;
+	unsigned long	  length;
+	int				  done;
+	int				  failed;
+} CUT_TRANSFER;
+
+typedef struct _cut_frame {
+	unsigned char	  data[2048];
+	size_t			  length;
+} CUT_FRAME;
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+static void update(H3270 *hSession, unsigned long current, unsigned long length, double kbytes_sec, void *userdata) {
+	CUT_TRANSFER *transfer = (CUT_TRANSFER *) lib3270_ft_get_user_data(hSession);
+	transfer->current = current;
+	transfer->length = length;
+}
+
+static void complete(H3270 *hSession, unsigned long length, double kbytes_sec, const char *msg, void *userdata) {
+	CUT_TRANSFER *transfer = (CUT_TRANSFER *) lib3270_ft_get_user_data(hSession);
+	transfer->current = length;
+	transfer->done = 1;
+}
+
+static void failed(H3270 *hSession, unsigned long length, double kbytes_sec, const char *msg, void *userdata) {
+	CUT_TRANSFER *transfer = (CUT_TRANSFER *) lib3270_ft_get_user_data(hSession);
+	fprintf(stderr,"Transfer failed: %s\n",msg);
+	transfer->failed = 1;
+}
+
+/// @brief Start an Erase/Write record, the frame starts at the first position.
+static void frame_begin(CUT_FRAME *frame, unsigned char type) {
+	static const unsigned char header[] = { 0xf5, 0xc3, 0x11, 0x40, 0x40 };
+	memcpy(frame->data,header,sizeof(header));
+	frame->length = sizeof(header);
+	frame->data[frame->length++] = type;
+}
+
+/// @brief Close the record with the 'magic' skip field on the last position.
+static void frame_end(H3270 *hSession, CUT_FRAME *frame) {
+	static const unsigned char trailer[] = { 0x11, 0x5d, 0x7f, 0x1d, 0xf0, 0xff, 0xef };
+	memcpy(frame->data+frame->length,trailer,sizeof(trailer));
+	frame->length += sizeof(trailer);
+	lib3270_data_recv(hSession,frame->length,frame->data);
+}
+
+static void send_control(H3270 *hSession, unsigned char code) {
+	CUT_FRAME frame;
+	frame_begin(&frame,0xc3);
+	frame.data[frame.length++] = 0x81;		// Frame sequence.
+	frame.data[frame.length++] = 0x81;		// Status code.
+	frame.data[frame.length++] = code;
+	frame_end(hSession,&frame);
+}
+
+static unsigned char to6(H3270 *hSession, unsigned int value) {
+	unsigned char c = table6[value & 0x3f];
+	lib3270_asc2ebc(hSession,&c,1);
+	return c;
+}
+
+static H3270 * cut_session_new(void) {
+	static const unsigned char negotiation[] = {
+		0xff, 0xfd, 0x18,								// DO TERMINAL-TYPE
+		0xff, 0xfa, 0x18, 0x01, 0xff, 0xf0,				// SB TERMINAL-TYPE SEND SE
+		0xff, 0xfd, 0x19, 0xff, 0xfb, 0x19,				// DO/WILL EOR
+		0xff, 0xfd, 0x00, 0xff, 0xfb, 0x00				// DO/WILL BINARY
+	};
+
+	// Input field for the IND$FILE command.
+	static const unsigned char screen[] = { 0xf5, 0xc3, 0x11, 0x40, 0x40, 0x1d, 0x40, 0x13, 0xff, 0xef };
+
+	H3270 *hSession = lib3270_session_new("");
+
+	// There's no event loop, the keyboard must unlock as soon as the host asks.
+	lib3270_set_unlock_delay(hSession,0);
+
+	if(lib3270_replay_connect(hSession)) {
+		lib3270_session_free(hSession);
+		return NULL;
+	}
+
+	lib3270_data_recv(hSession,sizeof(negotiation),negotiation);
+	lib3270_data_recv(hSession,sizeof(screen),screen);
+
+	if(!lib3270_in_3270(hSession)) {
+		fprintf(stderr,"Can't negotiate 3270 mode on replay session\n");
+		lib3270_session_free(hSession);
+		return NULL;
+	}
+
+	return hSession;
+}
+
+static int cut_start(H3270 *hSession, CUT_TRANSFER *transfer, LIB3270_FT_OPTION options, const char *filename) {
+	struct lib3270_ft_callbacks	* cbk;
+	const char					* message = NULL;
+
+	memset(transfer,0,sizeof(CUT_TRANSFER));
+
+	if(!lib3270_ft_new(hSession,options,filename,"BENCHMARK",0,0,0,0,0,&message)) {
+		fprintf(stderr,"%s: %s\n",filename,message ? message : strerror(errno));
+		return EINVAL;
+	}
+
+	lib3270_ft_set_user_data(hSession,transfer);
+
+	cbk = lib3270_get_ft_callbacks(hSession,sizeof(struct lib3270_ft_callbacks));
+	cbk->update = update;
+	cbk->complete = complete;
+	cbk->failed = failed;
+
+	if(lib3270_ft_start(hSession))
+		return EINVAL;
+
+	send_control(hSession,0x81);		// Host ack.
+
+	return 0;
+}
+
+/// @brief Host to local: decode the data frames.
+static int benchmark_decode(const char *filename, unsigned int frames, double *seconds, unsigned long *bytes) {
+	H3270			* hSession	= cut_session_new();
+	CUT_FRAME		* data		= calloc(frames,sizeof(CUT_FRAME));
+	CUT_FRAME		  eof;
+	CUT_TRANSFER	  transfer;
+	unsigned int	  ix;
+	double			  started;
+	int				  rc;
+
+	if(!hSession) {
+		free(data);
+		return ENOTCONN;
+	}
+
+	// Build the frames: runs of characters switching between the uppercase and lowercase quadrants.
+	srand(3270);
+	for(ix = 0; ix < frames; ix++) {
+		size_t			  pos	= 0;
+		unsigned char	* ptr;
+
+		frame_begin(data+ix,0xc1);
+		ptr = data[ix].data + data[ix].length;
+
+		ptr[0] = 0x81;											// Frame sequence.
+		ptr[1] = 0x40;											// Checksum (not verified).
+		ptr[2] = to6(hSession,CUT_FRAME_DATA >> 6);
+		ptr[3] = to6(hSession,CUT_FRAME_DATA);
+		ptr += 4;
+
+		while(pos < CUT_FRAME_DATA) {
+			size_t run = 1 + (rand() % 40);
+
+			ptr[pos++] = (rand() & 1) ? 0x5e : 0x7e;			// Quadrant selector.
+			while(run-- && pos < CUT_FRAME_DATA) {
+				unsigned char c = alphas[rand() % (sizeof(alphas)-1)];
+				lib3270_asc2ebc(hSession,&c,1);
+				ptr[pos++] = c;
+			}
+		}
+
+		data[ix].length += 4 + CUT_FRAME_DATA;
+	}
+
+	frame_begin(&eof,0xc1);
+	eof.data[eof.length++] = 0x81;
+	eof.data[eof.length++] = 0x40;
+	eof.data[eof.length++] = to6(hSession,0);
+	eof.data[eof.length++] = to6(hSession,2);
+	eof.data[eof.length++] = 0x5c;								// EOF_DATA1
+	eof.data[eof.length++] = 0xa9;								// EOF_DATA2
+
+	rc = cut_start(hSession,&transfer,LIB3270_FT_OPTION_RECEIVE|CUT_OPTIONS,filename);
+
+	started = now();
+	for(ix = 0; ix < frames && !rc && !transfer.failed; ix++)
+		frame_end(hSession,data+ix);
+	*seconds = now() - started;
+
+	if(!rc && !transfer.failed) {
+		frame_end(hSession,&eof);
+		send_control(hSession,0x89);							// Transfer complete.
+	}
+
+	if(!rc && !transfer.done)
+		rc = EIO;
+
+	*bytes = transfer.current;
+
+	lib3270_ft_destroy(hSession,NULL);
+	lib3270_session_free(hSession);
+	free(data);
+
+	return rc;
+}
+
+/// @brief Local to host: encode the file on data requests.
+static int benchmark_encode(const char *filename, double *seconds, unsigned long *bytes) {
+	H3270			* hSession	= cut_session_new();
+	CUT_FRAME		  request;
+	CUT_TRANSFER	  transfer;
+	double			  started;
+	int				  rc;
+	int				  eof		= 0;
+
+	if(!hSession)
+		return ENOTCONN;
+
+	rc = cut_start(hSession,&transfer,LIB3270_FT_OPTION_SEND|CUT_OPTIONS,filename);
+
+	frame_begin(&request,0xc2);
+	request.data[request.length++] = 0x1d;						// Data field.
+	request.data[request.length++] = 0x40;
+	request.data[request.length++] = 0xc1;						// Data code.
+	request.data[request.length++] = 0x81;						// Frame sequence.
+
+	started = now();
+	while(!rc && !transfer.failed && !eof) {
+		// One more request after the last byte to get the EOF frame.
+		eof = (transfer.length && transfer.current >= transfer.length);
+		frame_end(hSession,&request);
+		request.length -= 7;
+	}
+	*seconds = now() - started;
+
+	if(!rc && !transfer.failed)
+		send_control(hSession,0x89);
+
+	if(!rc && !transfer.done)
+		rc = EIO;
+
+	*bytes = transfer.current;
+
+	lib3270_ft_destroy(hSession,NULL);
+	lib3270_session_free(hSession);
+
+	return rc;
+}
+
+int benchmark_cut(unsigned int iterations) {
+	char			  filename[] = "/tmp/lib3270-cut-XXXXXX";
+	unsigned int	  frames = iterations * CUT_FRAMES;
+	double			  seconds;
+	unsigned long	  bytes = 0;
+	int				  fd = mkstemp(filename);
+	int				  rc;
+
+	if(fd < 0) {
+		perror(filename);
+		return errno;
+	}
+	close(fd);
+
+	printf("Transferring %u frames on each direction (MB/sec)\n\n",frames);
+
+	rc = benchmark_decode(filename,frames,&seconds,&bytes);
+	if(!rc)
+		printf("%-20s %10lu bytes %14.1f\n","Decode (host->local)",bytes,seconds > 0 ? bytes / (seconds * 1000000.0) : 0.0);
+
+	if(!rc) {
+		// Send back what was received (text with CR/LF line ends).
+		rc = benchmark_encode(filename,&seconds,&bytes);
+		if(!rc)
+			printf("%-20s %10lu bytes %14.1f\n","Encode (local->host)",bytes,seconds > 0 ? bytes / (seconds * 1000000.0) : 0.0);
+	}
+
+	unlink(filename);
+
+	return rc;
+}
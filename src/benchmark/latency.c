@@ -0,0 +1,124 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como latency.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief AID round trip benchmark.
+ *
+ * Sends ENTER to the loopback simulator running src/benchmark/aid-latency.script
+ * and waits for the keyboard to unlock, once for each network profile, and
+ * reports the round trip times.
+ *
+ */
+
+#include "private.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include <lib3270.h>
+#include <lib3270/actions.h>
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+static int compare(const void *a, const void *b) {
+	double da = *((const double *) a);
+	double db = *((const double *) b);
+	return (da > db) - (da < db);
+}
+
+/// @brief Send 'iterations' AIDs on a session with the network profile and print the round trip times.
+static int run_profile(const char *url, LIB3270_NETWORK_PROFILE profile, unsigned int iterations, double *times) {
+	H3270			* hSession	= lib3270_session_new("");
+	double			  total		= 0;
+	unsigned int	  ix;
+	int				  rc;
+
+	lib3270_set_url(hSession,url);
+	lib3270_set_unlock_delay(hSession,0);
+	lib3270_set_network_profile(hSession,profile);
+
+	rc = lib3270_reconnect(hSession,10);
+	if(!rc)
+		rc = lib3270_wait_for_ready(hSession,10);
+
+	for(ix = 0; ix < iterations && !rc; ix++) {
+
+		double started = now();
+
+		rc = lib3270_enter(hSession);
+		if(!rc)
+			rc = lib3270_wait_for_ready(hSession,10);
+
+		times[ix] = now() - started;
+		total += times[ix];
+
+	}
+
+	if(rc) {
+		fprintf(stderr,"%s: %s\n",url,strerror(rc));
+	} else {
+		qsort(times,iterations,sizeof(double),compare);
+		printf(
+			"%-12s %12.1f %12.1f %12.1f %12.1f\n",
+				lib3270_get_network_profile_name(hSession),
+				(total / iterations) * 1e6,
+				times[iterations / 2] * 1e6,
+				times[(iterations * 99) / 100] * 1e6,
+				times[iterations - 1] * 1e6
+		);
+	}
+
+	lib3270_disconnect(hSession);
+	lib3270_session_free(hSession);
+
+	return rc;
+}
+
+int benchmark_latency(const char *url, unsigned int iterations) {
+
+	double	* times	= calloc(iterations,sizeof(double));
+	int		  profile;
+	int		  rc	= 0;
+
+	printf("Sending %u AIDs to %s\n\n",iterations,url);
+	printf("%-12s %12s %12s %12s %12s\n","Profile","Mean (us)","p50 (us)","p99 (us)","Max (us)");
+
+	for(profile = 0; profile < LIB3270_NETWORK_PROFILE_COUNT && !rc; profile++)
+		rc = run_profile(url,(LIB3270_NETWORK_PROFILE) profile,iterations,times);
+
+	free(times);
+
+	return rc;
+}
@@ -0,0 +1,405 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como main.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Data stream replay benchmark.
+ *
+ * Usage: lib3270-benchmark [--threads=1] [--iterations=100] [--chunk=0] [--trace=file] [--binary-trace=file] capture [capture...]
+ *        lib3270-benchmark --charset [--iterations=100]
+ *        lib3270-benchmark --cut [--iterations=100]
+ *        lib3270-benchmark --paste=lines
+ *        lib3270-benchmark --nvt [--iterations=100]
+ *        lib3270-benchmark --upload=file [--url=tn3270://127.0.0.1:3270] [--buffer=4096|auto|sweep] [--text]
+ *        lib3270-benchmark --latency [--url=tn3270://127.0.0.1:3270] [--iterations=100]
+ *
+ * Every thread runs its own session, each iteration puts the session online with
+ * lib3270_replay_connect() and feeds all the captures through lib3270_data_recv().
+ *
+ * With --charset measures the EBCDIC conversion of each host code page instead.
+ *
+ * With --cut measures the CUT mode file transfer encoding and decoding.
+ *
+ * With --paste measures the clipboard paste on a multi field screen.
+ *
+ * With --nvt measures the NVT (line mode) text processing.
+ *
+ * With --upload sends the file with DFT to a simulator running src/benchmark/dft-upload.script;
+ * --buffer=sweep repeats the transfer with every buffer size.
+ *
+ * With --latency measures the AID round trip on each network profile against a simulator
+ * running src/benchmark/aid-latency.script.
+ *
+ */
+
+#include "private.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <lib3270.h>
+#include <lib3270/internals.h>
+#include <lib3270/stats.h>
+#include <lib3270/toggle.h>
+#include <lib3270/trace.h>
+#include <lib3270/filetransfer.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#define TICKS_UNIT	"cycles"
+#else
+#define TICKS_UNIT	"ns"
+#endif
+
+typedef struct _worker {
+	pthread_t					  thread;
+	BENCHMARK_CAPTURE			**captures;
+	size_t						  count;
+	unsigned int				  iterations;
+	const char					* trace;		///< @brief Trace file (NULL to disable).
+	const char					* binary;		///< @brief Binary trace file (NULL to disable).
+
+	int							  rc;
+	double						  seconds;		///< @brief Time inside lib3270_data_recv().
+	unsigned long long			  bytes;
+	LIB3270_STAGE_COUNTER		  counters[LIB3270_STAGE_COUNT];
+} WORKER;
+
+/*---[ Implement ]------------------------------------------------------------------------------------------*/
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+static void * worker_run(void *arg) {
+
+	WORKER			* worker	= (WORKER *) arg;
+	H3270			* hSession	= lib3270_session_new("");
+	unsigned int	  iteration;
+	size_t			  ix;
+
+	lib3270_set_stage_timing(hSession,1);
+
+	if(worker->trace) {
+		lib3270_set_trace_filename(hSession,worker->trace);
+		lib3270_set_toggle(hSession,LIB3270_TOGGLE_DS_TRACE,1);
+	}
+
+	if(worker->binary)
+		lib3270_set_binary_trace_filename(hSession,worker->binary);
+
+	for(iteration = 0; iteration < worker->iterations && !worker->rc; iteration++) {
+
+		for(ix = 0; ix < worker->count && !worker->rc; ix++) {
+
+			const BENCHMARK_CAPTURE	* capture = worker->captures[ix];
+			size_t					  block;
+			double					  started;
+
+			worker->rc = lib3270_replay_connect(hSession);
+			if(worker->rc)
+				break;
+
+			started = now();
+			for(block = 0; block < capture->length; block++)
+				lib3270_data_recv(hSession,capture->blocks[block].length,capture->blocks[block].data);
+			worker->seconds += (now() - started);
+			worker->bytes += capture->bytes;
+
+			if(!lib3270_is_connected(hSession)) {
+				fprintf(stderr,"%s: Session was disconnected during replay\n",capture->filename);
+				worker->rc = ENOTCONN;
+			}
+
+			lib3270_disconnect(hSession);
+
+		}
+
+	}
+
+	lib3270_get_stage_counters(hSession,worker->counters,LIB3270_STAGE_COUNT);
+	lib3270_session_free(hSession);
+
+	return NULL;
+}
+
+int main(int argc, char *argv[]) {
+
+	static const struct option options[] = {
+		{ "threads",	required_argument,	0,	't' },
+		{ "iterations",	required_argument,	0,	'i' },
+		{ "chunk",		required_argument,	0,	'c' },
+		{ "trace",		required_argument,	0,	'T' },
+		{ "binary-trace",	required_argument,	0,	'B' },
+		{ "charset",	no_argument,		0,	'C' },
+		{ "cut",		no_argument,		0,	'X' },
+		{ "paste",		required_argument,	0,	'P' },
+		{ "nvt",		no_argument,		0,	'N' },
+		{ "upload",		required_argument,	0,	'U' },
+		{ "url",		required_argument,	0,	'u' },
+		{ "buffer",		required_argument,	0,	'b' },
+		{ "text",		no_argument,		0,	'x' },
+		{ "latency",	no_argument,		0,	'L' },
+		{ 0, 0, 0, 0}
+	};
+
+	unsigned int		  threads		= 1;
+	unsigned int		  iterations	= 100;
+	size_t				  chunk			= 0;
+	const char			* trace			= NULL;
+	const char			* binary		= NULL;
+	int					  charset		= 0;
+	int					  cut			= 0;
+	unsigned int		  paste			= 0;
+	int					  nvt			= 0;
+	int					  latency		= 0;
+	const char			* upload		= NULL;
+	const char			* url			= "tn3270://127.0.0.1:3270";
+	int					  buffer		= 0;
+	int					  sweep			= 0;
+	LIB3270_FT_OPTION	  ftoptions		= 0;
+	int					  opt;
+	int					  rc			= 0;
+	size_t				  ix;
+
+	while((opt = getopt_long(argc, argv, "t:i:c:T:B:CXP:NU:u:b:xL", options, NULL)) != -1) {
+		switch(opt) {
+		case 't':
+			threads = (unsigned int) atoi(optarg);
+			break;
+
+		case 'i':
+			iterations = (unsigned int) atoi(optarg);
+			break;
+
+		case 'c':
+			chunk = (size_t) atoi(optarg);
+			break;
+
+		case 'T':
+			trace = optarg;
+			break;
+
+		case 'B':
+			binary = optarg;
+			break;
+
+		case 'C':
+			charset = 1;
+			break;
+
+		case 'X':
+			cut = 1;
+			break;
+
+		case 'P':
+			paste = (unsigned int) atoi(optarg);
+			break;
+
+		case 'N':
+			nvt = 1;
+			break;
+
+		case 'U':
+			upload = optarg;
+			break;
+
+		case 'u':
+			url = optarg;
+			break;
+
+		case 'b':
+			if(!strcmp(optarg,"auto"))
+				buffer = LIB3270_DFT_BUFFER_AUTO;
+			else if(!strcmp(optarg,"sweep"))
+				sweep = 1;
+			else
+				buffer = atoi(optarg);
+			break;
+
+		case 'x':
+			ftoptions = LIB3270_FT_OPTION_ASCII|LIB3270_FT_OPTION_REMAP|LIB3270_FT_OPTION_UNIX;
+			break;
+
+		case 'L':
+			latency = 1;
+			break;
+
+		default:
+			optind = argc;
+			threads = 0;
+		}
+	}
+
+	if(charset && threads && iterations)
+		return benchmark_charset(iterations) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	if(cut && threads && iterations)
+		return benchmark_cut(iterations) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	if(paste && threads)
+		return benchmark_paste(paste) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	if(nvt && threads && iterations)
+		return benchmark_nvt(iterations) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	if(latency && threads && iterations)
+		return benchmark_latency(url,iterations) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	if(upload && threads && sweep)
+		return benchmark_upload_sweep(url,upload,ftoptions) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	if(upload && threads)
+		return benchmark_upload(url,upload,ftoptions,buffer) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	if(optind >= argc || !threads || !iterations) {
+		fprintf(stderr,"Usage: %s [--threads=1] [--iterations=100] [--chunk=0] [--trace=file] [--binary-trace=file] capture [capture...]\n",argv[0]);
+		fprintf(stderr,"       %s --charset [--iterations=100]\n",argv[0]);
+		fprintf(stderr,"       %s --cut [--iterations=100]\n",argv[0]);
+		fprintf(stderr,"       %s --paste=lines\n",argv[0]);
+		fprintf(stderr,"       %s --nvt [--iterations=100]\n",argv[0]);
+		fprintf(stderr,"       %s --upload=file [--url=tn3270://127.0.0.1:3270] [--buffer=4096|auto|sweep] [--text]\n",argv[0]);
+		fprintf(stderr,"       %s --latency [--url=tn3270://127.0.0.1:3270] [--iterations=100]\n",argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	// Load captures.
+	size_t				  count		= argc - optind;
+	BENCHMARK_CAPTURE	**captures	= calloc(count,sizeof(BENCHMARK_CAPTURE *));
+	unsigned long long	  bytes		= 0;
+
+	for(ix = 0; ix < count; ix++) {
+		captures[ix] = benchmark_capture_load(argv[optind+ix]);
+		if(!captures[ix]) {
+			rc = EINVAL;
+			break;
+		}
+		benchmark_capture_rechunk(captures[ix],chunk);
+		printf("%s: %u blocks, %u bytes\n",captures[ix]->filename,(unsigned int) captures[ix]->length,(unsigned int) captures[ix]->bytes);
+		bytes += captures[ix]->bytes;
+	}
+
+	if(!rc) {
+
+		WORKER				* workers = calloc(threads,sizeof(WORKER));
+		LIB3270_STAGE_COUNTER counters[LIB3270_STAGE_COUNT];
+		double				  slowest	= 0;
+		double				  wall		= now();
+		unsigned long long	  ticks		= lib3270_get_ticks();
+		unsigned long long	  records;
+
+		memset(counters,0,sizeof(counters));
+
+		printf("Running %u iteration(s) on %u thread(s)\n\n",iterations,threads);
+
+		for(ix = 0; ix < threads; ix++) {
+			workers[ix].captures = captures;
+			workers[ix].count = count;
+			workers[ix].iterations = iterations;
+			workers[ix].trace = trace;
+			workers[ix].binary = binary;
+			pthread_create(&workers[ix].thread,NULL,worker_run,workers+ix);
+		}
+
+		for(ix = 0; ix < threads; ix++) {
+
+			size_t stage;
+
+			pthread_join(workers[ix].thread,NULL);
+
+			if(workers[ix].rc) {
+				fprintf(stderr,"Thread %u failed: %s\n",(unsigned int) ix,strerror(workers[ix].rc));
+				rc = workers[ix].rc;
+			}
+
+			if(workers[ix].seconds > slowest)
+				slowest = workers[ix].seconds;
+
+			for(stage = 0; stage < LIB3270_STAGE_COUNT; stage++) {
+				counters[stage].calls += workers[ix].counters[stage].calls;
+				counters[stage].ticks += workers[ix].counters[stage].ticks;
+			}
+
+		}
+
+		wall = now() - wall;
+		ticks = lib3270_get_ticks() - ticks;
+
+		// One 3270 record per process_ds() call.
+		records = counters[LIB3270_STAGE_PROCESS_DS].calls;
+		bytes *= ((unsigned long long) iterations) * threads;
+
+		if(!rc && slowest > 0) {
+
+			size_t stage;
+
+			printf("Records:     %llu (%llu bytes)\n",records,bytes);
+			printf("Throughput:  %.0f records/sec, %.0f bytes/sec\n",records / slowest, bytes / slowest);
+			if(threads > 1)
+				printf("Per thread:  %.0f records/sec\n",(records / slowest) / threads);
+			printf("Timer:       %.0f %s/sec\n\n",ticks / wall, TICKS_UNIT);
+
+			printf("%-16s %14s %16s %16s\n","Stage","Calls",TICKS_UNIT "/call",TICKS_UNIT "/screen");
+
+			for(stage = 0; stage < LIB3270_STAGE_COUNT; stage++) {
+				printf(
+					"%-16s %14llu %16.0f %16.0f\n",
+						lib3270_get_stage_name(stage),
+						counters[stage].calls,
+						counters[stage].calls ? ((double) counters[stage].ticks) / counters[stage].calls : 0.0,
+						records ? ((double) counters[stage].ticks) / records : 0.0
+				);
+			}
+
+			// Stages are nested; process_ds() is only called from the telnet parser.
+			if(records && counters[LIB3270_STAGE_TELNET].ticks > counters[LIB3270_STAGE_PROCESS_DS].ticks) {
+				printf(
+					"\ntelnet_fsm (without process_ds): %.0f %s/screen\n",
+						((double) (counters[LIB3270_STAGE_TELNET].ticks - counters[LIB3270_STAGE_PROCESS_DS].ticks)) / records,
+						TICKS_UNIT
+				);
+			}
+
+		}
+
+		free(workers);
+
+	}
+
+	for(ix = 0; ix < count; ix++)
+		benchmark_capture_free(captures[ix]);
+	free(captures);
+
+	return rc ? EXIT_FAILURE : EXIT_SUCCESS;
+
+}
@@ -0,0 +1,135 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como nvt.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief NVT benchmark.
+ *
+ * Feeds line mode text to a replay session (the first byte puts it on NVT mode)
+ * in network sized blocks: once redrawing the screen from the top, as full screen
+ * applications do, and once as a log scrolling at the bottom.
+ *
+ */
+
+#include "private.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include <lib3270.h>
+#include <lib3270/internals.h>
+
+/// @brief Bytes per iteration.
+#define NVT_BLOCK	65536
+
+/// @brief Bytes on each lib3270_data_recv() call.
+#define NVT_RECV	4096
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+/// @brief Build 'length' bytes of log lines ending with 'eol'; 'home' is sent before every 20 lines.
+static unsigned char * build_text(size_t length, const char *eol, const char *home) {
+	unsigned char	* text	= malloc(length + 256);
+	size_t			  pos	= 0;
+	unsigned int	  line	= 0;
+
+	while(pos < length) {
+
+		if(home && !(line % 20))
+			pos += snprintf((char *) text+pos,256,"%s",home);
+
+		pos += snprintf(
+					(char *) text+pos,
+					256,
+					"2026-10-18 12:%02u:%02u INFO  worker[%05u]: processed batch %u in %u ms%s",
+					(line / 60) % 60,
+					line % 60,
+					line % 100000,
+					line * 7,
+					line % 997,
+					eol
+				);
+
+		line++;
+	}
+
+	return text;
+}
+
+static int run(const char *name, const unsigned char *text, size_t length) {
+	H3270	* hSession	= lib3270_session_new("");
+	double	  started;
+	double	  seconds;
+	size_t	  pos;
+
+	if(lib3270_replay_connect(hSession)) {
+		lib3270_session_free(hSession);
+		return ENOTCONN;
+	}
+
+	started = now();
+	for(pos = 0; pos < length; pos += NVT_RECV)
+		lib3270_data_recv(hSession,(length - pos) < NVT_RECV ? (length - pos) : NVT_RECV,text+pos);
+	seconds = now() - started;
+
+	if(!lib3270_in_ansi(hSession)) {
+		fprintf(stderr,"%s: Session isn't on NVT mode\n",name);
+		lib3270_session_free(hSession);
+		return EINVAL;
+	}
+
+	printf("%-20s %10lu bytes %14.1f\n",name,(unsigned long) length,seconds > 0 ? length / (seconds * 1000000.0) : 0.0);
+
+	lib3270_session_free(hSession);
+	return 0;
+}
+
+int benchmark_nvt(unsigned int iterations) {
+	size_t			  length	= ((size_t) iterations) * NVT_BLOCK;
+	unsigned char	* screen	= build_text(length,"",	"\033[H");
+	unsigned char	* scroll	= build_text(length,"\r\n",NULL);
+	int				  rc;
+
+	printf("Processing %u blocks of NVT text (MB/sec)\n\n",iterations);
+
+	rc = run("Full screen",screen,length);
+
+	if(!rc)
+		rc = run("Scrolling",scroll,length);
+
+	free(screen);
+	free(scroll);
+
+	return rc;
+}
@@ -0,0 +1,215 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como paste.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Paste benchmark.
+ *
+ * Pastes a JCL like text on an editor screen (a protected line number and an
+ * unprotected field on each row) of a replay session; the host screen is sent
+ * again before each lib3270_paste_next(), only the paste calls are timed.
+ *
+ */
+
+#include "private.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include <lib3270.h>
+#include <lib3270/internals.h>
+#include <lib3270/selection.h>
+
+#define PASTE_ROWS	24
+#define PASTE_COLS	80
+
+/// @brief Column of the unprotected field attribute on each row.
+#define PASTE_FIELD	7
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+/// @brief Add a 14 bit SBA order.
+static size_t set_address(unsigned char *ptr, unsigned int baddr) {
+	ptr[0] = 0x11;
+	ptr[1] = (baddr >> 8) & 0x3f;
+	ptr[2] = baddr & 0xff;
+	return 3;
+}
+
+/// @brief Build the Erase/Write record with the editor screen, the cursor goes to the first input field.
+static size_t build_screen(unsigned char *buffer) {
+	size_t			length	= 0;
+	unsigned int	row;
+
+	buffer[length++] = 0xf5;
+	buffer[length++] = 0xc3;
+
+	for(row = 0; row < PASTE_ROWS; row++) {
+
+		unsigned int	line	= (row + 1) * 100;
+		int				digit;
+
+		length += set_address(buffer+length,row * PASTE_COLS);
+		buffer[length++] = 0x1d;		// SF
+		buffer[length++] = 0xf0;		// Protected, skip.
+
+		for(digit = 5; digit >= 0; digit--) {
+			buffer[length+digit] = 0xf0 + (line % 10);
+			line /= 10;
+		}
+		length += 6;
+
+		buffer[length++] = 0x1d;		// SF on PASTE_FIELD
+		buffer[length++] = 0x40;		// Unprotected.
+
+		if(!row)
+			buffer[length++] = 0x13;	// IC
+
+	}
+
+	buffer[length++] = 0xff;
+	buffer[length++] = 0xef;
+
+	return length;
+}
+
+/// @brief Build 'lines' lines of JCL, from 16 to the field length.
+static char * build_text(unsigned int lines, size_t *length) {
+	static const char * statements[] = {
+		"//STEP%05u EXEC PGM=IEBGENER,REGION=0M,PARM='LINE %u'",
+		"//SYSUT1   DD DSN=USER.BENCHMARK.DATA(M%05u),DISP=SHR",
+		"//SYSUT2   DD DSN=USER.BENCHMARK.COPY.D%05u,DISP=(NEW,CATLG,DELETE),UNIT=SYSDA",
+		"//SYSPRINT DD SYSOUT=*",
+		"//* %u"
+	};
+
+	char			* text	= malloc((PASTE_COLS + 2) * lines + 1);
+	char			* ptr	= text;
+	unsigned int	  line;
+
+	srand(3270);
+
+	for(line = 0; line < lines; line++) {
+
+		char	buffer[PASTE_COLS * 2];
+		int		sz = snprintf(buffer,sizeof(buffer),statements[rand() % 5],line,line);
+		int		max = PASTE_COLS - PASTE_FIELD - 1;
+
+		if(sz > max)
+			sz = max;
+
+		memcpy(ptr,buffer,sz);
+		ptr += sz;
+		*(ptr++) = '\n';
+	}
+
+	*ptr = 0;
+	*length = (ptr - text);
+
+	return text;
+}
+
+int benchmark_paste(unsigned int lines) {
+	static const unsigned char negotiation[] = {
+		0xff, 0xfd, 0x18,								// DO TERMINAL-TYPE
+		0xff, 0xfa, 0x18, 0x01, 0xff, 0xf0,				// SB TERMINAL-TYPE SEND SE
+		0xff, 0xfd, 0x19, 0xff, 0xfb, 0x19,				// DO/WILL EOR
+		0xff, 0xfd, 0x00, 0xff, 0xfb, 0x00				// DO/WILL BINARY
+	};
+
+	unsigned char	  screen[PASTE_ROWS * 16 + 8];
+	size_t			  length	= build_screen(screen);
+	size_t			  bytes;
+	char			* text		= build_text(lines,&bytes);
+	H3270			* hSession	= lib3270_session_new("");
+	unsigned int	  screens	= 0;
+	double			  seconds	= 0;
+	double			  started;
+	int				  rc		= 0;
+	int				  pending;
+
+	lib3270_set_unlock_delay(hSession,0);
+
+	if(lib3270_replay_connect(hSession)) {
+		lib3270_session_free(hSession);
+		free(text);
+		return ENOTCONN;
+	}
+
+	lib3270_data_recv(hSession,sizeof(negotiation),negotiation);
+	lib3270_data_recv(hSession,length,screen);
+
+	if(!lib3270_in_3270(hSession)) {
+		fprintf(stderr,"Can't negotiate 3270 mode on replay session\n");
+		lib3270_session_free(hSession);
+		free(text);
+		return ENOTCONN;
+	}
+
+	printf("Pasting %u lines (%u bytes) on %ux%u screens\n\n",lines,(unsigned int) bytes,PASTE_ROWS,PASTE_COLS);
+
+	started = now();
+	pending = lib3270_paste_text(hSession,(const unsigned char *) text);
+	seconds += (now() - started);
+	screens++;
+
+	while(pending > 0) {
+
+		lib3270_data_recv(hSession,length,screen);
+
+		started = now();
+		pending = lib3270_paste_next(hSession);
+		seconds += (now() - started);
+
+		if(++screens > lines) {
+			fprintf(stderr,"Paste isn't progressing\n");
+			pending = -EINVAL;
+		}
+
+	}
+
+	if(pending < 0) {
+		rc = -pending;
+	} else {
+		printf("%-20s %10u\n","Screens",screens);
+		printf("%-20s %10.3f\n","Seconds",seconds);
+		printf("%-20s %10.0f\n","Lines/sec",seconds > 0 ? lines / seconds : 0.0);
+		printf("%-20s %10.1f\n","MB/sec",seconds > 0 ? bytes / (seconds * 1000000.0) : 0.0);
+	}
+
+	lib3270_session_free(hSession);
+	free(text);
+
+	return rc;
+}
@@ -0,0 +1,96 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como private.h e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Data stream replay benchmark.
+ *
+ * Feeds captured host traffic to sessions through lib3270_data_recv() and
+ * reports the time spent on each processing stage.
+ *
+ */
+
+#ifndef BENCHMARK_PRIVATE_H_INCLUDED
+
+#define BENCHMARK_PRIVATE_H_INCLUDED
+
+#include <stdio.h>
+#include <stddef.h>
+
+/// @brief A block of host data, as received from the network.
+typedef struct _benchmark_block {
+	size_t				  length;
+	unsigned char		* data;
+} BENCHMARK_BLOCK;
+
+/// @brief Captured host traffic.
+typedef struct _benchmark_capture {
+	const char			* filename;
+	size_t				  bytes;		///< @brief Total bytes on all blocks.
+	size_t				  length;		///< @brief Number of blocks.
+	size_t				  size;
+	BENCHMARK_BLOCK		* blocks;
+} BENCHMARK_CAPTURE;
+
+/**
+ * @brief Load host traffic from capture file.
+ *
+ * Accepts network traces ('RECV data len=' blocks), data stream traces ('< 0x0 ...' lines)
+ * and simulator capture files (one hex record per line, '>' lines are ignored).
+ *
+ * @return Capture or NULL on error (message was printed).
+ *
+ */
+BENCHMARK_CAPTURE	* benchmark_capture_load(const char *filename);
+void				  benchmark_capture_free(BENCHMARK_CAPTURE *capture);
+
+/// @brief Split the capture in blocks of 'chunk' bytes (0 keeps the captured blocks).
+int					  benchmark_capture_rechunk(BENCHMARK_CAPTURE *capture, size_t chunk);
+
+/// @brief Run the charset conversion benchmark on every host code page.
+int					  benchmark_charset(unsigned int iterations);
+
+/// @brief Run a CUT transfer on each direction through a replay session.
+int					  benchmark_cut(unsigned int iterations);
+
+/// @brief Feed NVT text to a replay session, 'iterations' blocks of 64KB.
+int					  benchmark_nvt(unsigned int iterations);
+
+/// @brief Paste 'lines' lines of text on a multi field screen, report lines/sec.
+int					  benchmark_paste(unsigned int lines);
+
+/// @brief Send a file with DFT to the host at 'url' (see dft-upload.script); options are added to LIB3270_FT_OPTION_SEND.
+int					  benchmark_upload(const char *url, const char *filename, int options, int buffersize);
+
+/// @brief Send 'iterations' AIDs to the host at 'url' (see aid-latency.script) with each network profile, report the round trip times.
+int					  benchmark_latency(const char *url, unsigned int iterations);
+
+/// @brief Run the upload with every DFT buffer size from 256 to 32768 and in auto mode (the simulator must not use --once).
+int					  benchmark_upload_sweep(const char *url, const char *filename, int options);
+
+#endif // BENCHMARK_PRIVATE_H_INCLUDED
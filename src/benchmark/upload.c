@@ -0,0 +1,157 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como upload.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief DFT upload benchmark.
+ *
+ * Sends a local file with IND$FILE PUT to the loopback simulator running
+ * src/benchmark/dft-upload.script and reports the throughput.
+ *
+ * The session advertises the largest DFT buffer, the record size is set per
+ * transfer so a sweep can compare transfer time against buffer size.
+ *
+ */
+
+#include "private.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include <lib3270.h>
+#include <lib3270/filetransfer.h>
+
+typedef struct _upload {
+	unsigned long	  sent;
+	unsigned long	  length;
+	int				  done;
+	int				  failed;
+} UPLOAD;
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+static void update(H3270 *hSession, unsigned long current, unsigned long length, double kbytes_sec, void *userdata) {
+	UPLOAD *upload = (UPLOAD *) lib3270_ft_get_user_data(hSession);
+
+	upload->sent = current;
+	upload->length = length;
+
+	// The simulator keeps asking for data, the file is sent when the counter reaches the length.
+	if(length && current >= length)
+		upload->done = 1;
+}
+
+static void failed(H3270 *hSession, unsigned long length, double kbytes_sec, const char *msg, void *userdata) {
+	UPLOAD *upload = (UPLOAD *) lib3270_ft_get_user_data(hSession);
+
+	fprintf(stderr,"Transfer failed: %s\n",msg);
+	upload->failed = 1;
+}
+
+int benchmark_upload(const char *url, const char *filename, int options, int buffersize) {
+	H3270						* hSession	= lib3270_session_new("");
+	struct lib3270_ft_callbacks	* cbk;
+	const char					* message	= NULL;
+	UPLOAD						  upload;
+	double						  started;
+	int							  rc;
+
+	memset(&upload,0,sizeof(upload));
+
+	lib3270_set_url(hSession,url);
+	lib3270_set_dft_buffersize(hSession,LIB3270_DFT_BUFFER_AUTO);
+
+	rc = lib3270_reconnect(hSession,10);
+	if(!rc)
+		rc = lib3270_wait_for_ready(hSession,10);
+
+	if(rc) {
+		fprintf(stderr,"%s: %s\n",url,strerror(rc));
+		lib3270_session_free(hSession);
+		return rc;
+	}
+
+	if(!lib3270_ft_new(hSession,LIB3270_FT_OPTION_SEND|options,filename,"BENCHMARK",0,0,0,0,buffersize ? buffersize : 4096,&message)) {
+		fprintf(stderr,"%s: %s\n",filename,message ? message : strerror(errno));
+		lib3270_session_free(hSession);
+		return EINVAL;
+	}
+
+	lib3270_ft_set_user_data(hSession,&upload);
+
+	cbk = lib3270_get_ft_callbacks(hSession,sizeof(struct lib3270_ft_callbacks));
+	cbk->update = update;
+	cbk->failed = failed;
+
+	started = now();
+
+	rc = lib3270_ft_start(hSession);
+
+	while(!rc && !upload.done && !upload.failed && lib3270_is_connected(hSession))
+		lib3270_main_iterate(hSession,1);
+
+	started = now() - started;
+
+	if(!rc && upload.done) {
+		if(buffersize == LIB3270_DFT_BUFFER_AUTO)
+			printf("%-6s ","auto");
+		else
+			printf("%-6d ",buffersize ? buffersize : 4096);
+		printf("%s: %lu bytes in %.3f seconds, %.3f GB/s\n",filename,upload.sent,started,(upload.sent / started) / 1e9);
+	} else if(!rc) {
+		fprintf(stderr,"%s: Transfer stopped after %lu of %lu bytes\n",filename,upload.sent,upload.length);
+		rc = EIO;
+	}
+
+	lib3270_ft_cancel(hSession,1,"Benchmark complete");
+	lib3270_ft_destroy(hSession,NULL);
+	lib3270_disconnect(hSession);
+	lib3270_session_free(hSession);
+
+	return rc;
+}
+
+int benchmark_upload_sweep(const char *url, const char *filename, int options) {
+
+	int size;
+	int rc;
+
+	for(size = 256; size <= 32768; size *= 2) {
+		rc = benchmark_upload(url,filename,options,size);
+		if(rc)
+			return rc;
+	}
+
+	return benchmark_upload(url,filename,options,LIB3270_DFT_BUFFER_AUTO);
+}
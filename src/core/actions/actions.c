@@ -31,6 +31,7 @@
 #include <lib3270/log.h>
 #include <lib3270/trace.h>
 #include <lib3270/actions.h>
+#include <lib3270/properties.h>
 #include <utilc.h>
 
 struct lib3270_action_callback {
@@ -41,15 +42,15 @@ struct lib3270_action_callback {
 /*---[ Implement ]------------------------------------------------------------------------------------------------------------*/
 
 const LIB3270_ACTION * lib3270_action_get_by_name(const char *name) {
-	const LIB3270_ACTION * actions = lib3270_get_actions();
+	const LIB3270_RESOLVED_NAME * resolved = lib3270_find_name(name,LIB3270_NAME_ACTION);
+	const LIB3270_ACTION * actions;
 	size_t f;
 
-	for(f=0; actions[f].name; f++) {
-		if(!strcasecmp(name,actions[f].name))
-			return actions+f;
-	}
+	if(resolved)
+		return resolved->value.action;
 
-	// Check only alphabetic and numeric (for compatibility)
+	// Check for partial names (for compatibility)
+	actions = lib3270_get_actions();
 	for(f=0; actions[f].name; f++) {
 		if(!lib3270_compare_alnum(name,actions[f].name))
 			return actions+f;
@@ -1666,6 +1666,84 @@ ansi_process(H3270 *hSession, unsigned int c) {
 	hSession->state = (*fn)(hSession, n[0], n[1]);
 }
 
+/**
+ * @brief Process a run of printable characters.
+ *
+ * Fast path for the plain text from NVT hosts: on DATA state the characters are
+ * stored one row at a time, with the same results as ansi_printing() for each
+ * one but a single change notification per row and a single cursor move.
+ *
+ * @return Number of characters processed, the next one goes to ansi_process().
+ *
+ */
+size_t ansi_process_text(H3270 *hSession, const unsigned char *text, size_t length) {
+	unsigned char	  ebc[256];
+	int				  cols	= hSession->view.cols;
+	int				  baddr	= hSession->cursor_addr;
+	size_t			  ix	= 0;
+
+	if (hSession->state != DATA || hSession->insert_mode || hSession->once_cset != -1 || hSession->csd[hSession->cset] != CSD_US)
+		return 0;
+
+	if (trace_enabled(hSession,LIB3270_TOGGLE_SCREEN_TRACE))
+		return 0;
+
+#if defined(X3270_DBCS) /*[*/
+	if (dbcs)
+		return 0;
+#endif /*]*/
+
+	while (ix < length && st[DATA][text[ix]] == Pc) {
+		int col;
+		int count;
+
+		if (hSession->held_wrap) {
+			int nc = baddr + 1;
+
+			if (nc < hSession->scroll_bottom * cols)
+				baddr = nc;
+			else if (baddr / cols >= hSession->scroll_bottom)
+				baddr = baddr / cols * cols;
+			else {
+				ansi_scroll(hSession);
+				baddr = nc - cols;
+			}
+			hSession->held_wrap = 0;
+		}
+
+		col = baddr % cols;
+
+		// Below the scrolling region each character returns the cursor to the first column.
+		if (hSession->wraparound_mode && baddr / cols >= hSession->scroll_bottom && col != cols - 1)
+			break;
+
+		for (count = 0; count < (cols - col) && count < (int) sizeof(ebc) && ix < length && st[DATA][text[ix]] == Pc; count++)
+			ebc[count] = hSession->charset.asc2ebc[text[ix++]];
+
+		ctlr_add_string(hSession, baddr, ebc, count, CS_BASE, hSession->gr, hSession->fg, hSession->bg);
+
+		if (col + count < cols) {
+			baddr += count;
+		} else {
+			// Stuck on the last column, see ansi_printing().
+			baddr += count - 1;
+			if (hSession->wraparound_mode)
+				hSession->held_wrap = 1;
+		}
+
+	}
+
+	if (ix) {
+		hSession->ansi_ch = text[ix-1];
+		hSession->pmi = 0;
+	}
+
+	if (baddr != hSession->cursor_addr)
+		cursor_move(hSession,baddr);
+
+	return ix;
+}
+
 void
 ansi_send_up(H3270 *hSession) {
 	if (hSession->appl_cursor)
@@ -221,10 +221,14 @@ LIB3270_EXPORT void lib3270_reset_charset(H3270 *hSession, const char * host, co
 	replace_pointer(hSession->charset.display,display);
 
 	hSession->charset.cgcsgid = cgcsgid;
+	query_reply_reset(hSession);
 
 	memcpy(hSession->charset.ebc2asc,	ebc2asc0,	sizeof(hSession->charset.ebc2asc));
 	memcpy(hSession->charset.asc2ebc,	asc2ebc0,	sizeof(hSession->charset.asc2ebc));
 
+	lib3270_charset_bytes(hSession->charset_bytes.ebc2asc,hSession->charset.ebc2asc);
+	lib3270_charset_bytes(hSession->charset_bytes.asc2ebc,hSession->charset.asc2ebc);
+
 	for(f=0; f<UT_OFFSET; f++)
 		hSession->charset.asc2uc[f] = f;
 
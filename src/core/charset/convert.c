@@ -36,35 +36,236 @@
  */
 
 #include <internals.h>
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
 #include <lib3270/charset.h>
 #include <lib3270/log.h>
 #include <lib3270/trace.h>
 
+#if (defined(__i386__) || defined(__x86_64__)) && defined(__GNUC__)
+#define HAVE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+/*---[ Kernels ]--------------------------------------------------------------------------------------------------------------*/
+
+typedef void (*translate_method)(unsigned char *dst, const unsigned char *src, size_t len, const unsigned char *table);
+
+static void translate_scalar(unsigned char *dst, const unsigned char *src, size_t len, const unsigned char *table) {
+
+	while(len >= 4) {
+		dst[0] = table[src[0]];
+		dst[1] = table[src[1]];
+		dst[2] = table[src[2]];
+		dst[3] = table[src[3]];
+		dst += 4;
+		src += 4;
+		len -= 4;
+	}
+
+	while(len--)
+		*(dst++) = table[*(src++)];
+
+}
+
+#ifdef HAVE_X86_KERNELS
+
+//
+// The table is split in 16 rows of 16 entries, one pshufb per row. Subtracting
+// the row base and adding 0x70 with unsigned saturation leaves bit 7 clear (and
+// the column on the low nibble) only for the bytes on that row, pshufb zeroes
+// the other ones.
+//
+
+__attribute__((target("ssse3")))
+static void translate_ssse3(unsigned char *dst, const unsigned char *src, size_t len, const unsigned char *table) {
+	__m128i			  rows[16];
+	const __m128i	  bias	= _mm_set1_epi8(0x70);
+	const __m128i	  step	= _mm_set1_epi8(0x10);
+	size_t			  row;
+
+	for(row = 0; row < 16; row++)
+		rows[row] = _mm_loadu_si128((const __m128i *) (table + (row * 16)));
+
+	while(len >= 16) {
+		__m128i index	= _mm_loadu_si128((const __m128i *) src);
+		__m128i result	= _mm_setzero_si128();
+
+		for(row = 0; row < 16; row++) {
+			result = _mm_or_si128(result,_mm_shuffle_epi8(rows[row],_mm_adds_epu8(index,bias)));
+			index = _mm_sub_epi8(index,step);
+		}
+
+		_mm_storeu_si128((__m128i *) dst,result);
+		dst += 16;
+		src += 16;
+		len -= 16;
+	}
+
+	translate_scalar(dst,src,len,table);
+
+}
+
+__attribute__((target("avx2")))
+static void translate_avx2(unsigned char *dst, const unsigned char *src, size_t len, const unsigned char *table) {
+	__m256i			  rows[16];
+	const __m256i	  bias	= _mm256_set1_epi8(0x70);
+	const __m256i	  step	= _mm256_set1_epi8(0x10);
+	size_t			  row;
+
+	// vpshufb works on 128 bits lanes, use the same row on both.
+	for(row = 0; row < 16; row++)
+		rows[row] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) (table + (row * 16))));
+
+	while(len >= 32) {
+		__m256i index	= _mm256_loadu_si256((const __m256i *) src);
+		__m256i result	= _mm256_setzero_si256();
+
+		for(row = 0; row < 16; row++) {
+			result = _mm256_or_si256(result,_mm256_shuffle_epi8(rows[row],_mm256_adds_epu8(index,bias)));
+			index = _mm256_sub_epi8(index,step);
+		}
+
+		_mm256_storeu_si256((__m256i *) dst,result);
+		dst += 32;
+		src += 32;
+		len -= 32;
+	}
+
+	translate_scalar(dst,src,len,table);
+
+}
+
+#endif // HAVE_X86_KERNELS
+
+static translate_method select_method(void) {
+
+#ifdef HAVE_X86_KERNELS
+	__builtin_cpu_init();
+
+	if(__builtin_cpu_supports("avx2"))
+		return translate_avx2;
+
+	if(__builtin_cpu_supports("ssse3"))
+		return translate_ssse3;
+#endif // HAVE_X86_KERNELS
+
+	return translate_scalar;
+}
+
+void lib3270_charset_translate(unsigned char *dst, const unsigned char *src, size_t len, const unsigned char *table) {
+	static translate_method method = NULL;
+
+	if(len < 16) {
+		translate_scalar(dst,src,len,table);
+		return;
+	}
+
+	// Selecting twice is harmless, no lock needed.
+	if(!method)
+		method = select_method();
+
+	method(dst,src,len,table);
+}
+
+void lib3270_charset_bytes(unsigned char *bytes, const unsigned short *table) {
+	size_t ix;
+
+	// All the mappings are below 0x100.
+	for(ix = 0; ix < 256; ix++)
+		bytes[ix] = (unsigned char) table[ix];
+}
+
 /*---[ Implement ]------------------------------------------------------------------------------------------------------------*/
 
 LIB3270_EXPORT const char * lib3270_asc2ebc(H3270 *hSession, unsigned char *buffer, int sz) {
-	int f;
 	if(sz < 0)
 		sz = strlen((const char *) buffer);
 
-	if(sz > 0) {
-		for(f=0; f<sz; f++)
-			buffer[f] = hSession->charset.asc2ebc[buffer[f]];
-	}
+	if(sz > 0)
+		lib3270_charset_translate(buffer,buffer,(size_t) sz,hSession->charset_bytes.asc2ebc);
 
 	return (const char *) buffer;
 }
 
 LIB3270_EXPORT const char * lib3270_ebc2asc(H3270 *hSession, unsigned char *buffer, int sz) {
-	int f;
 	if(sz < 0)
 		sz = strlen((const char *) buffer);
 
-	if(sz > 0) {
-		for(f=0; f<sz; f++)
-			buffer[f] = hSession->charset.ebc2asc[buffer[f]];
-	}
+	if(sz > 0)
+		lib3270_charset_translate(buffer,buffer,(size_t) sz,hSession->charset_bytes.ebc2asc);
 
 	return (const char *) buffer;
 }
 
+LIB3270_EXPORT char * lib3270_ebc2utf8(H3270 *hSession, const unsigned char *buffer, int sz) {
+	unsigned char	* text;
+	unsigned char	* src;
+	size_t			  length;
+	size_t			  ix;
+	size_t			  out = 0;
+
+	if(sz < 0)
+		sz = strlen((const char *) buffer);
+
+	length = (size_t) sz;
+
+	// Translate to the display charset on the second half, expand to UTF-8 from the start.
+	text = lib3270_malloc((length * 2) + 1);
+	src = text + length;
+	lib3270_charset_translate(src,buffer,length,hSession->charset_bytes.ebc2asc);
+
+	if(hSession->charset.display && strcasecmp(hSession->charset.display,"ISO-8859-1")) {
+		// Not latin-1, let iconv do the expansion.
+		LIB3270_ICONV_BUFFER converted = { NULL, 0, 0 };
+
+		if(!(hSession->utf8.conv && hSession->utf8.charset && !strcmp(hSession->utf8.charset,hSession->charset.display))) {
+			// Display charset has changed, the converter tables are built only once for each charset.
+			if(hSession->utf8.conv)
+				lib3270_iconv_free(hSession->utf8.conv);
+			lib3270_free(hSession->utf8.charset);
+			hSession->utf8.conv = lib3270_iconv_new(hSession->charset.display,"UTF-8");
+			hSession->utf8.charset = lib3270_strdup(hSession->charset.display);
+		}
+
+		if(!(hSession->utf8.conv && lib3270_iconv_from_host_buffer(hSession->utf8.conv,&converted,(const char *) src,(int) length))) {
+			// Can't convert, the buffer may hold a partial conversion.
+			int rc = hSession->utf8.conv ? errno : EINVAL;
+			lib3270_iconv_buffer_free(&converted);
+			lib3270_free(text);
+			errno = rc;
+			return NULL;
+		}
+
+		lib3270_free(text);
+		return converted.text;
+	}
+
+	// Latin-1: the output never passes the input (every byte expands to at most two).
+	for(ix = 0; ix < length;) {
+		uint64_t block;
+
+		if(ix + 8 <= length && (memcpy(&block,src+ix,8), !(block & 0x8080808080808080ULL))) {
+			// ASCII run.
+			memmove(text+out,src+ix,8);
+			out += 8;
+			ix += 8;
+			continue;
+		}
+
+		unsigned char chr = src[ix++];
+
+		if(chr < 0x80) {
+			text[out++] = chr;
+		} else {
+			text[out++] = 0xc0 | (chr >> 6);
+			text[out++] = 0x80 | (chr & 0x3f);
+		}
+	}
+
+	text[out] = 0;
+	return (char *) text;
+
+}
@@ -39,6 +39,16 @@
 #include <lib3270/charset.h>
 #include <iconv.h>
 #include <string.h>
+#include <errno.h>
+#include <stdint.h>
+
+/// @brief Output of each byte for single byte charsets.
+typedef struct _iconv_table {
+	unsigned char		  length[256];		///< @brief Bytes on text (0 if the byte can't be converted).
+	unsigned char		  text[256][4];
+	unsigned char		  max;				///< @brief Longest output.
+	unsigned char		  ascii;			///< @brief Non zero if 0x00-0x7f are unchanged.
+} ICONV_TABLE;
 
 struct _lib3270_iconv {
 	/// @brief Convert strings from host codepage to local codepage.
@@ -46,10 +56,97 @@ struct _lib3270_iconv {
 
 	/// @brief Convert string from local codepage to host codepage.
 	iconv_t host;
+
+	/// @brief Precomputed host to local conversion (NULL if the host charset isn't single byte).
+	ICONV_TABLE * local_table;
+
+	/// @brief Precomputed local to host conversion (NULL if the local charset isn't single byte).
+	ICONV_TABLE * host_table;
+
+	/// @brief Buffer for conversions without a caller buffer.
+	LIB3270_ICONV_BUFFER buffer;
 };
 
 /*---[ Implement ]------------------------------------------------------------------------------------------------------------*/
 
+/// @brief Check if the conversion works one byte at a time and build the table.
+static ICONV_TABLE * build_table(iconv_t converter) {
+	ICONV_TABLE	* table;
+	char		  all[1024];
+	char		  check[1024];
+	size_t		  length = 0;
+	size_t		  in, out;
+	char		* ptr;
+	int			  chr;
+
+	if(converter == (iconv_t)(-1))
+		return NULL;
+
+	table = lib3270_malloc(sizeof(ICONV_TABLE));
+
+	for(chr = 0; chr < 256; chr++) {
+		char				  byte		= (char) chr;
+		ICONV_CONST char	* inBuffer	= &byte;
+
+		in	= 1;
+		out	= sizeof(table->text[chr]);
+		ptr	= (char *) table->text[chr];
+
+		iconv(converter,NULL,NULL,NULL,NULL);
+
+		if(iconv(converter,&inBuffer,&in,&ptr,&out) == ((size_t) -1) || iconv(converter,NULL,NULL,&ptr,&out) == ((size_t) -1)) {
+
+			if(errno != EILSEQ) {
+				// Incomplete or too long, not a single byte charset.
+				lib3270_free(table);
+				return NULL;
+			}
+
+			continue;
+		}
+
+		table->length[chr] = (unsigned char) (sizeof(table->text[chr]) - out);
+		if(table->length[chr] > table->max)
+			table->max = table->length[chr];
+
+		memcpy(all+length,table->text[chr],table->length[chr]);
+		length += table->length[chr];
+	}
+
+	table->ascii = 1;
+	for(chr = 0; chr < 0x80 && table->ascii; chr++) {
+		if(table->length[chr] != 1 || table->text[chr][0] != chr)
+			table->ascii = 0;
+	}
+
+	// Stateful charsets and byte order marks don't convert the same way byte by byte.
+	{
+		char				  bytes[256];
+		ICONV_CONST char	* inBuffer	= bytes;
+
+		in = 0;
+		for(chr = 0; chr < 256; chr++) {
+			if(table->length[chr])
+				bytes[in++] = (char) chr;
+		}
+
+		out	= sizeof(check);
+		ptr	= check;
+
+		iconv(converter,NULL,NULL,NULL,NULL);
+
+		if(!table->max
+		        || iconv(converter,&inBuffer,&in,&ptr,&out) == ((size_t) -1)
+		        || (sizeof(check) - out) != length
+		        || memcmp(all,check,length)) {
+			lib3270_free(table);
+			return NULL;
+		}
+	}
+
+	return table;
+}
+
 LIB3270_ICONV * lib3270_iconv_new(const char *remote, const char *local) {
 	LIB3270_ICONV * converter = lib3270_malloc(sizeof(LIB3270_ICONV));
 	memset(converter,0,sizeof(LIB3270_ICONV));
@@ -60,6 +157,9 @@ LIB3270_ICONV * lib3270_iconv_new(const char *remote, const char *local) {
 		converter->local = iconv_open(local, remote);
 		converter->host  = iconv_open(remote,local);
 
+		converter->local_table = build_table(converter->local);
+		converter->host_table  = build_table(converter->host);
+
 	} else {
 
 		// Same charset, doesn't convert
@@ -79,41 +179,190 @@ void lib3270_iconv_free(LIB3270_ICONV *conv) {
 
 	conv->local = conv->host = (iconv_t) (-1);
 
+	lib3270_free(conv->local_table);
+	lib3270_free(conv->host_table);
+	lib3270_iconv_buffer_free(&conv->buffer);
+
 	lib3270_free(conv);
 }
 
-static char *convert(iconv_t *converter, const char * str, int length) {
-	if(length < 0)
-		length = (int) strlen(str);
+void lib3270_iconv_buffer_free(LIB3270_ICONV_BUFFER *buffer) {
+	lib3270_free(buffer->text);
+	memset(buffer,0,sizeof(LIB3270_ICONV_BUFFER));
+}
 
-	if(length && converter != (iconv_t)(-1)) {
+/// @brief Make room for 'length' more bytes and the terminating nul.
+static void reserve(LIB3270_ICONV_BUFFER *buffer, size_t length) {
 
-		size_t				  in		= length;
-		size_t				  out		= (length << 1);
-		char				* ptr;
-		char				* outBuffer	= (char *) lib3270_malloc(out);
-		ICONV_CONST char	* inBuffer	= (ICONV_CONST char *) str;
+	if(buffer->length + length < buffer->size)
+		return;
+
+	buffer->size = (buffer->length + length + 1) < (buffer->size << 1) ? (buffer->size << 1) : (buffer->length + length + 1);
+	buffer->text = lib3270_realloc(buffer->text,(int) buffer->size);
+
+}
+
+/**
+ * @brief Append the converted string to the buffer.
+ *
+ * @return 0 if ok, error code if not (the buffer contents are unchanged).
+ *
+ */
+static int convert(iconv_t converter, const ICONV_TABLE *table, LIB3270_ICONV_BUFFER *buffer, const char *str, size_t length) {
+	size_t start = buffer->length;
+
+	if(table) {
+
+		const unsigned char	* src = (const unsigned char *) str;
+		unsigned char		* dst;
+		size_t				  ix;
+
+		// Each byte stores the four bytes of the table entry, keep room for the last one.
+		reserve(buffer,(length * table->max) + sizeof(table->text[0]));
+		dst = (unsigned char *) (buffer->text + buffer->length);
+
+		if(table->max == 1) {
+
+			for(ix = 0; ix < length; ix++) {
+				if(!table->length[src[ix]])
+					return EILSEQ;
+				dst[ix] = table->text[src[ix]][0];
+			}
+			dst += length;
+
+		} else {
 
-		memset(ptr=outBuffer,0,out);
+			for(ix = 0; ix < length; ix++) {
+				const unsigned char chr = src[ix];
+				uint64_t block;
+
+				if(table->ascii && ix + 8 <= length && (memcpy(&block,src+ix,8), !(block & 0x8080808080808080ULL))) {
+					// ASCII run.
+					memcpy(dst,&block,8);
+					dst += 8;
+					ix += 7;
+					continue;
+				}
+
+				if(!table->length[chr])
+					return EILSEQ;
+
+				memcpy(dst,table->text[chr],sizeof(table->text[chr]));
+				dst += table->length[chr];
+			}
+
+		}
+
+		buffer->length = dst - ((unsigned char *) buffer->text);
+
+	} else if(converter == (iconv_t)(-1)) {
+
+		reserve(buffer,length);
+		memcpy(buffer->text+buffer->length,str,length);
+		buffer->length += length;
+
+	} else {
+
+		ICONV_CONST char	* inBuffer	= (ICONV_CONST char *) str;
+		size_t				  in		= length;
+		int					  flush		= 0;
 
 		iconv(converter,NULL,NULL,NULL,NULL);   // Reset state
 
-		if(iconv(converter,&inBuffer,&in,&ptr,&out) != ((size_t) -1))
-			return (char *) outBuffer;
+		reserve(buffer,length + (length >> 1) + 16);
+
+		for(;;) {
+			char	* ptr	= buffer->text + buffer->length;
+			size_t	  out	= buffer->size - buffer->length - 1;
+			size_t	  rc	= flush ? iconv(converter,NULL,NULL,&ptr,&out) : iconv(converter,&inBuffer,&in,&ptr,&out);
+
+			buffer->length = ptr - buffer->text;
+
+			if(rc == ((size_t) -1)) {
+
+				if(errno != E2BIG) {
+					int error = errno;
+					buffer->length = start;
+					return error;
+				}
+
+				// Output buffer is full, enlarge it and go on.
+				reserve(buffer,buffer->size);
+
+			} else if(!flush) {
+
+				// Input was converted, write the shift sequence (if any).
+				flush = 1;
+
+			} else {
+
+				break;
+
+			}
+
+		}
 
 	}
 
-	char * rc = lib3270_malloc(length+1);
-	strcpy(rc,str);
-	rc[length] = 0;
+	buffer->text[buffer->length] = 0;
+	return 0;
+}
+
+static const char * convert_buffer(LIB3270_ICONV *conv, iconv_t converter, const ICONV_TABLE *table, LIB3270_ICONV_BUFFER *buffer, const char *str, int length) {
+	int rc;
+
+	if(!buffer) {
+		buffer = &conv->buffer;
+		buffer->length = 0;
+	}
+
+	if(length < 0)
+		length = (int) strlen(str);
+
+	rc = convert(converter,table,buffer,str,(size_t) length);
+	if(rc) {
+		errno = rc;
+		return NULL;
+	}
 
-	return rc;
+	if(!buffer->text) {
+		// Empty string.
+		reserve(buffer,0);
+		buffer->text[0] = 0;
+	}
+
+	return buffer->text;
+}
+
+static char * convert_string(iconv_t converter, const ICONV_TABLE *table, const char * str, int length) {
+	LIB3270_ICONV_BUFFER buffer = { NULL, 0, 0 };
+
+	if(length < 0)
+		length = (int) strlen(str);
+
+	if(!length || convert(converter,table,&buffer,str,(size_t) length)) {
+		// Can't convert, return a copy of the original string.
+		buffer.length = 0;
+		reserve(&buffer,length);
+		memcpy(buffer.text,str,length);
+		buffer.text[length] = 0;
+	}
+
+	return buffer.text;
 }
 
 char * lib3270_iconv_from_host(LIB3270_ICONV *conv, const char *str, int len) {
-	return convert(conv->local,str,len);
+	return convert_string(conv->local,conv->local_table,str,len);
 }
 
 char * lib3270_iconv_to_host(LIB3270_ICONV *conv, const char *str, int len) {
-	return convert(conv->host,str,len);
+	return convert_string(conv->host,conv->host_table,str,len);
+}
+
+const char * lib3270_iconv_from_host_buffer(LIB3270_ICONV *conv, LIB3270_ICONV_BUFFER *buffer, const char *str, int len) {
+	return convert_buffer(conv,conv->local,conv->local_table,buffer,str,len);
+}
+
+const char * lib3270_iconv_to_host_buffer(LIB3270_ICONV *conv, LIB3270_ICONV_BUFFER *buffer, const char *str, int len) {
+	return convert_buffer(conv,conv->host,conv->host_table,buffer,str,len);
 }
@@ -63,9 +63,9 @@ LIB3270_EXPORT void lib3270_remap_char(H3270 *hSession, unsigned short ebc, unsi
 	if (iso <= 0xff) {
 		if (scope == BOTH || scope == CS_ONLY) {
 			if (ebc > 0x40) {
-				hSession->charset.ebc2asc[ebc] = iso;
+				hSession->charset.ebc2asc[ebc] = hSession->charset_bytes.ebc2asc[ebc] = iso;
 				if (!one_way)
-					hSession->charset.asc2ebc[iso] = ebc;
+					hSession->charset.asc2ebc[iso] = hSession->charset_bytes.asc2ebc[iso] = ebc;
 			}
 		}
 
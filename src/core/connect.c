@@ -36,6 +36,7 @@
 #include <lib3270/toggle.h>
 #include <lib3270/ssl.h>
 #include <trace_dsc.h>
+#include <statsc.h>
 #include "utilc.h"
 
 /*---[ Implement ]-------------------------------------------------------------------------------*/
@@ -139,6 +140,8 @@ int lib3270_start_tls(H3270 *hSession) {
 
 	non_blocking(hSession,False);
 
+	unsigned long long started = stats_clock();
+
 #pragma GCC diagnostic push
 #ifdef _WIN32
 #pragma GCC diagnostic ignored "-Wcast-function-type"
@@ -150,6 +153,9 @@ int lib3270_start_tls(H3270 *hSession) {
 	         );
 #pragma GCC diagnostic pop
 
+	if(!rc)
+		stats_elapsed(hSession->stats.counters.tls_handshake,started);
+
 	if(rc == ENOTSUP) {
 
 		// No support for TLS/SSL in the active network module, the connection is insecure
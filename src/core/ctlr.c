@@ -59,6 +59,7 @@
 #include "seec.h"
 #include "sf.h"
 #include "statusc.h"
+#include "statsc.h"
 #include "telnetc.h"
 #include "trace_dsc.h"
 #include "utilc.h"
@@ -75,6 +76,8 @@ static void	ctlr_half_connect(H3270 *session, int ignored, void *dunno);
 static void	ctlr_connect(H3270 *session, int ignored, void *dunno);
 //static void ticking_stop(H3270 *session);
 static void ctlr_add_ic(H3270 *session, int baddr, unsigned char ic);
+static enum pds process_command(H3270 *hSession, unsigned char *buf, int buflen);
+static enum pds write_orders(H3270 *hSession, unsigned char buf[], int buflen, Boolean erase);
 
 /**
  * code_table is used to translate buffer addresses and attributes to the 3270
@@ -127,14 +130,14 @@ void ctlr_init(H3270 *session, unsigned GNUC_UNUSED(cmask)) {
  * @brief Reinitialize the emulated 3270 hardware on model change
  */
 void ctlr_model_changed(H3270 *session) {
-	// Allocate buffers
+	// Allocate buffers (with room for a second screen, see ctlr_scroll).
 	struct lib3270_ea *tmp;
 	size_t sz = (session->max.rows * session->max.cols);
 
-	session->buffer[0] = tmp = lib3270_calloc(sizeof(struct lib3270_ea), sz+1, session->buffer[0]);
+	session->buffer[0] = tmp = lib3270_calloc(sizeof(struct lib3270_ea), (sz*2)+1, session->buffer[0]);
 	session->ea_buf = tmp + 1;
 
-	session->buffer[1] = tmp = lib3270_calloc(sizeof(struct lib3270_ea),sz+1,session->buffer[1]);
+	session->buffer[1] = tmp = lib3270_calloc(sizeof(struct lib3270_ea),(sz*2)+1,session->buffer[1]);
 	session->aea_buf = tmp + 1;
 
 	session->text 		= lib3270_calloc(sizeof(struct lib3270_text),sz,session->text);
@@ -142,6 +145,9 @@ void ctlr_model_changed(H3270 *session) {
 
 	session->cursor_addr = 0;
 	session->buffer_addr = 0;
+
+	// The query replies have the screen size.
+	query_reply_reset(session);
 }
 
 void ctlr_set_rows_cols(H3270 *session, int mn, int ovc, int ovr) {
@@ -548,6 +554,15 @@ void ctlr_erase(H3270 *session, int alt) {
  * @brief Interpret an incoming 3270 command.
  */
 enum pds process_ds(H3270 *hSession, unsigned char *buf, int buflen) {
+	unsigned long long started = stage_begin(hSession);
+	unsigned long long clock = stats_clock();
+	enum pds rv = process_command(hSession,buf,buflen);
+	stats_elapsed(hSession->stats.counters.process_ds,clock);
+	stage_end(hSession,LIB3270_STAGE_PROCESS_DS,started);
+	return rv;
+}
+
+static enum pds process_command(H3270 *hSession, unsigned char *buf, int buflen) {
 	enum pds rv;
 
 	if (!buflen)
@@ -1024,6 +1039,14 @@ void ctlr_erase_all_unprotected(H3270 *hSession) {
  * @brief Process a 3270 Write command.
  */
 enum pds ctlr_write(H3270 *hSession, unsigned char buf[], int buflen, Boolean erase) {
+	unsigned long long started = stage_begin(hSession);
+	span_write(hSession);
+	enum pds rv = write_orders(hSession,buf,buflen,erase);
+	stage_end(hSession,LIB3270_STAGE_CTLR_WRITE,started);
+	return rv;
+}
+
+static enum pds write_orders(H3270 *hSession, unsigned char buf[], int buflen, Boolean erase) {
 	register unsigned char	*cp;
 	register int	baddr;
 	unsigned char	current_fa;
@@ -2199,7 +2222,7 @@ int ctlr_any_data(H3270 *session) {
 /**
  * @brief Clear the text (non-status) portion of the display.  Also resets the cursor and buffer addresses and extended attributes.
  */
-void ctlr_clear(H3270 *session, Boolean can_snap) {
+void ctlr_clear(H3270 *session, Boolean GNUC_UNUSED(can_snap)) {
 	/* Snap any data that is about to be lost into the trace file. */
 #if defined(X3270_TRACE)
 
@@ -2353,6 +2376,72 @@ void ctlr_add_bg(H3270 *hSession, int baddr, unsigned char color) {
 	}
 }
 
+/**
+ * @brief Add a run of characters on one row of the buffer.
+ *
+ * Same as ctlr_add(), ctlr_add_gr(), ctlr_add_fg() and ctlr_add_bg() for each
+ * character but with a single change notification.
+ *
+ * @param baddr	Address of the first character.
+ * @param text	EBCDIC characters (must not cross the end of the buffer).
+ * @param count	Number of characters.
+ *
+ */
+void ctlr_add_string(H3270 *hSession, int baddr, const unsigned char *text, int count, unsigned char cs, unsigned char gr, unsigned char fg, unsigned char bg) {
+	struct lib3270_ea	* ea	= hSession->ea_buf + baddr;
+	int					  first	= -1;
+	int					  last	= -1;
+	int					  ix;
+
+	if ((fg & 0xf0) != 0xf0)
+		fg = 0;
+
+	if ((bg & 0xf0) != 0xf0)
+		bg = 0;
+
+	for(ix = 0; ix < count; ix++, ea++) {
+
+		int changed = 0;
+
+		if(ea->fa || ea->cc != text[ix] || ea->cs != cs) {
+			if (hSession->trace_primed && !ea->fa && !IsBlank(ea->cc)) {
+#if defined(X3270_TRACE) /*[*/
+				if (lib3270_get_toggle(hSession,LIB3270_TOGGLE_SCREEN_TRACE))
+					trace_screen(hSession);
+#endif /*]*/
+				hSession->trace_primed = 0;
+			}
+			ea->cc = text[ix];
+			ea->cs = cs;
+			ea->fa = 0;
+			changed = 1;
+		}
+
+		if(ea->gr != gr) {
+			ea->gr = gr;
+			changed = 1;
+		}
+
+		if(hSession->m3279 && (ea->fg != fg || ea->bg != bg)) {
+			ea->fg = fg;
+			ea->bg = bg;
+			changed = 1;
+		}
+
+		if(changed) {
+			if(first < 0)
+				first = ix;
+			last = ix;
+		}
+
+	}
+
+	if(first >= 0) {
+		REGION_CHANGED(hSession, baddr + first, baddr + last + 1);
+	}
+
+}
+
 /*
  * Change the input control bit for a character in the 3270 buffer.
  */
@@ -2431,19 +2520,40 @@ void ctlr_aclear(H3270 *hSession, int baddr, int count, int GNUC_UNUSED(clear_ea
 /**
  * @brief Scroll the screen 1 row.
  *
- * This could be accomplished with ctlr_bcopy() and ctlr_aclear(), but this
- * operation is common enough to warrant a separate path.
+ * The screen buffers have room for two screens, scrolling just moves ea_buf one
+ * row ahead; the screen is moved back to the start of the buffer only when it
+ * reaches the end. The row going out is kept on the scrollback.
+ *
  */
 void ctlr_scroll(H3270 *hSession) {
-	int qty = (hSession->view.rows - 1) * hSession->view.cols;
+	size_t				  sz		= (hSession->max.rows * hSession->max.cols);
+	int					  qty		= (hSession->view.rows - 1) * hSession->view.cols;
+	struct lib3270_ea	* base		= hSession->buffer[0];
+	struct lib3270_ea	  sentinel	= hSession->ea_buf[-1];
+
+	if(hSession->ea_buf < base || hSession->ea_buf > (base + (sz*2)))
+		base = hSession->buffer[1];
 
 	/* Make sure nothing is selected. (later this can be fixed) */
 	// unselect(0, ROWS*COLS);
 
-	/* Synchronize pending changes prior to this. */
+	if(!hSession->is_altbuffer)
+		scrollback_add(hSession,hSession->ea_buf,hSession->view.cols);
+
+	if((hSession->ea_buf + hSession->view.cols + sz) > (base + (sz*2) + 1)) {
+
+		/* No room for one more row, move ea_buf back to the start. */
+		(void) memmove(base + 1, &hSession->ea_buf[hSession->view.cols],qty * sizeof(struct lib3270_ea));
+
+		hSession->ea_buf = base + 1;
+
+	} else {
+
+		hSession->ea_buf += hSession->view.cols;
+
+	}
 
-	/* Move ea_buf. */
-	(void) memmove(&hSession->ea_buf[0], &hSession->ea_buf[hSession->view.cols],qty * sizeof(struct lib3270_ea));
+	hSession->ea_buf[-1] = sentinel;
 
 	/* Clear the last line. */
 	(void) memset((char *) &hSession->ea_buf[qty], 0, hSession->view.cols * sizeof(struct lib3270_ea));
@@ -91,6 +91,9 @@ LIB3270_EXPORT int lib3270_move_cursor(H3270 *hSession, LIB3270_DIRECTION dir, u
 		} else {
 			struct ta *ta = new_ta(hSession, TA_TYPE_CURSOR_MOVE);
 
+			if(!ta)
+				return 0;
+
 			ta->args.move.direction = dir;
 			ta->args.move.fn = lib3270_move_cursor;
 			ta->args.move.sel = sel;
@@ -198,6 +198,10 @@ static H3270FT * ft_creation_failed(H3270 *session, int rc, const char **dest, c
 }
 
 LIB3270_EXPORT H3270FT * lib3270_ft_new(H3270 *session, LIB3270_FT_OPTION flags, const char *local, const char *remote, int lrecl, int blksize, int primspace, int secspace, int dft, const char **message) {
+	return ft_new(session,flags,local,remote,lrecl,blksize,primspace,secspace,dft,NULL,message);
+}
+
+H3270FT * ft_new(H3270 *session, LIB3270_FT_OPTION flags, const char *local, const char *remote, int lrecl, int blksize, int primspace, int secspace, int dft, FILE *file, const char **message) {
 	static const unsigned short asc2ft[256] = {
 		0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
 		0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f,
@@ -237,7 +241,7 @@ LIB3270_EXPORT H3270FT * lib3270_ft_new(H3270 *session, LIB3270_FT_OPTION flags,
 	};
 
 	H3270FT				* ftHandle		= (H3270FT *) session->ft;
-	FILE				* ft_local_file	= NULL;
+	FILE				* ft_local_file	= file;
 	int                   f;
 
 	if(!lib3270_is_connected(session))
@@ -251,17 +255,16 @@ LIB3270_EXPORT H3270FT * lib3270_ft_new(H3270 *session, LIB3270_FT_OPTION flags,
 		return ft_creation_failed(session,EINVAL,message,_( "The remote file name is invalid." ));
 
 	// Open local file
+	if(!ft_local_file) {
 #ifdef _WIN32
-	ft_local_file = fopen(local,(flags & LIB3270_FT_OPTION_RECEIVE) ? ((flags & LIB3270_FT_OPTION_APPEND) ? "ab" : "wb") : "rb");
+		ft_local_file = fopen(local,(flags & LIB3270_FT_OPTION_RECEIVE) ? ((flags & LIB3270_FT_OPTION_APPEND) ? "ab" : "wb") : "rb");
 #else
-	ft_local_file = fopen(local,(flags & LIB3270_FT_OPTION_RECEIVE) ? ((flags & LIB3270_FT_OPTION_APPEND) ? "a" : "w") : "r");
+		ft_local_file = fopen(local,(flags & LIB3270_FT_OPTION_RECEIVE) ? ((flags & LIB3270_FT_OPTION_APPEND) ? "a" : "w") : "r");
 #endif // _WIN32
 
-	if(!ft_local_file)
-		return ft_creation_failed(session,errno,message,strerror(errno));
-
-	// Set options
-	lib3270_set_dft_buffersize(session, dft);
+		if(!ft_local_file)
+			return ft_creation_failed(session,errno,message,strerror(errno));
+	}
 
 	// Create & Initialize ft control structure.
 	ftHandle = lib3270_malloc(sizeof(H3270FT)+strlen(local)+strlen(remote)+3);
@@ -503,12 +506,22 @@ static double finish(H3270FT *ft) {
 	double			  kbytes_sec = 0;
 	struct timeval	  t1;
 
+	// Wait for the pending writes, the rate includes the time to reach the disk.
+	ft_writer_free(ft->writer);
+	ft->writer = NULL;
+
 	(void) gettimeofday(&t1, (struct timezone *)NULL);
 	kbytes_sec = (double) ft->ft_length / 1024.0 /
 	             ((double)(t1.tv_sec - ft->starting_time.tv_sec) +
 	              (double)(t1.tv_usec - ft->starting_time.tv_usec) / 1.0e6);
 
 	// Close the local file.
+	ft_reader_free(ft->reader);
+	ft->reader = NULL;
+
+	lib3270_free(ft->cut_tables);
+	ft->cut_tables = NULL;
+
 	if(ft->local_file) {
 		fclose(ft->local_file);
 		ft->local_file = NULL;
@@ -523,11 +536,20 @@ static double finish(H3270FT *ft) {
 }
 
 void ft_complete(H3270FT *ft, const char *errmsg) {
-	ft->cbk.complete(ft->host,ft->ft_length,finish(ft),errmsg ? errmsg : _("Transfer complete"),ft->user_data);
+	double kbytes_sec = finish(ft);
+
+	// Before the callback, it can destroy the transfer.
+	ft_queue_done(ft,0);
+
+	ft->cbk.complete(ft->host,ft->ft_length,kbytes_sec,errmsg ? errmsg : _("Transfer complete"),ft->user_data);
 }
 
 void ft_failed(H3270FT *ft, const char *errmsg) {
-	ft->cbk.failed(ft->host,ft->ft_length,finish(ft),errmsg ? errmsg : _("Transfer failed"),ft->user_data);
+	double kbytes_sec = finish(ft);
+
+	ft_queue_done(ft,1);
+
+	ft->cbk.failed(ft->host,ft->ft_length,kbytes_sec,errmsg ? errmsg : _("Transfer failed"),ft->user_data);
 }
 
 LIB3270_EXPORT int lib3270_ft_destroy(H3270 *hSession, const char *reason) {
@@ -543,11 +565,21 @@ LIB3270_EXPORT int lib3270_ft_destroy(H3270 *hSession, const char *reason) {
 		lib3270_ft_cancel(hSession,1,reason);
 	}
 
+	ft_reader_free(session->reader);
+	session->reader = NULL;
+
+	ft_writer_free(session->writer);
+	session->writer = NULL;
+
+	lib3270_free(session->cut_tables);
+	session->cut_tables = NULL;
+
 	if(session->local_file) {
 		fclose(session->local_file);
 		session->local_file = NULL;
 	}
 
+	ft_queue_detach(session);
 	hSession->ft = NULL;
 
 	lib3270_free(session);
@@ -132,144 +132,184 @@ static void cut_ack(H3270 *hSession);
 static void cut_abort(H3270 *hSession, unsigned short code, const char *fmt, ...) LIB3270_GNUC_FORMAT(3,4);
 
 static unsigned from6(H3270 *hSession, unsigned char c);
-static int xlate_getc(H3270FT *ft);
+static int xlate_read(H3270FT *ft, unsigned char *buffer, int max);
+
+/// @brief Special values on the decode table.
+#define CUT_DECODE_SKIP		0x0100		/* Drop the byte (CR and ^Z on unix text) */
+#define CUT_DECODE_RETRY	0x0200		/* Not mapped by the quadrant, the byte selects a new one */
+#define CUT_DECODE_ERROR	0x0400		/* Out of the valid range */
 
 /**
- * Convert a buffer for uploading (host->local). Overwrites the buffer.
+ * @brief Conversion tables for the transfer.
  *
- * If there is a conversion error, calls cut_abort() and returns -1.
+ * Built from the session and transfer charsets when the host acknowledges
+ * the transfer, so each byte is converted with a single lookup instead of
+ * searching the alphabet and the quadrant tables.
  *
- * @return the length of the converted data.
  */
-static int upload_convert(H3270 *hSession, unsigned char *buf, int len) {
-	unsigned char	* ob0 = buf;
-	unsigned char	* ob = ob0;
-	H3270FT			* ft = get_ft_handle(hSession);
+struct _ft_cut_tables {
+	signed char		selector[256];		///< @brief Quadrant selected by each host code (-1 if none).
+	signed char		first[256];			///< @brief First quadrant mapping each local byte (-1 if none).
+	unsigned char	encode[NQ][256];	///< @brief Host code for each local byte on each quadrant (0 if not mapped).
+	unsigned short	decode[NQ][256];	///< @brief Local byte for each host code on each quadrant (or CUT_DECODE_*).
+};
 
-	while (len--) {
-		unsigned char c = *buf++;
-		char *ixp;
-		int ix;
-		// int oq = -1;
-
-retry:
-		if (ft->quadrant < 0) {
-			/* Find the quadrant. */
-			for (ft->quadrant = 0; ft->quadrant < NQ; ft->quadrant++) {
-				if (c == conv[ft->quadrant].selector)
-					break;
-			}
-			if (ft->quadrant >= NQ) {
-				cut_abort(hSession,SC_ABORT_XMIT, "%s", _("Data conversion error"));
-				return -1;
+/**
+ * @brief Build the conversion tables for the current transfer options.
+ */
+static void cut_build_tables(H3270 *hSession, H3270FT *ft) {
+	struct _ft_cut_tables	* tables;
+	int						  q;
+	int						  c;
+
+	if (!ft->cut_tables)
+		ft->cut_tables = lib3270_malloc(sizeof(struct _ft_cut_tables));
+
+	tables = ft->cut_tables;
+
+	memset(tables->selector, -1, sizeof(tables->selector));
+	memset(tables->first, -1, sizeof(tables->first));
+	memset(tables->encode, 0, sizeof(tables->encode));
+
+	for (q = 0; q < NQ; q++)
+		tables->selector[conv[q].selector] = q;
+
+	/* Host to local. */
+	for (q = 0; q < NQ; q++) {
+		for (c = 0; c < 256; c++) {
+			unsigned char	  a = hSession->charset.ebc2asc[c];
+			const char		* ixp = a ? strchr(alphas, a) : NULL;
+			int				  ix;
+			unsigned char	  v;
+
+			if (c < 0x40 || c > 0xf9) {
+				tables->decode[q][c] = CUT_DECODE_ERROR;
+				continue;
 			}
-			continue;
-		}
 
-		/* Make sure it's in a valid range. */
-		if (c < 0x40 || c > 0xf9) {
-			cut_abort(hSession,SC_ABORT_XMIT, "%s", _("Data conversion error"));
-			return -1;
-		}
+			/* Not on the alphabet or not mapped by the quadrant (handling NULLs specially). */
+			ix = ixp ? (ixp - alphas) : 0;
+			if (!ixp || (q != OTHER_2 && c != XLATE_NULL && !conv[q].xlate[ix])) {
+				tables->decode[q][c] = CUT_DECODE_RETRY;
+				continue;
+			}
 
-		/* Translate to a quadrant index. */
-		ixp = strchr(alphas, hSession->charset.ebc2asc[c]);
-		if (ixp == (char *)NULL) {
-			/* Try a different quadrant. */
-			// oq = quadrant;
-			ft->quadrant = -1;
-			goto retry;
-		}
-		ix = ixp - alphas;
+			v = conv[q].xlate[ix];
 
-		/*
-		 * See if it's mapped by that quadrant, handling NULLs
-		 * specially.
-		 */
-		if (ft->quadrant != OTHER_2 && c != XLATE_NULL && !conv[ft->quadrant].xlate[ix]) {
-			/* Try a different quadrant. */
-//			oq = quadrant;
-			ft->quadrant = -1;
-			goto retry;
+//			if (ft->ascii_flag && ft->cr_flag && (v == '\r' || v == 0x1a))
+			if (ft->unix_text && (v == '\r' || v == 0x1a))
+				tables->decode[q][c] = CUT_DECODE_SKIP;
+			else if (ft->ascii_flag && ft->remap_flag)
+				tables->decode[q][c] = ft->charset.ebc2asc[v];
+			else
+				tables->decode[q][c] = v;
 		}
+	}
 
-		/* Map it. */
-		c = conv[ft->quadrant].xlate[ix];
+	/* Local to host, the first match of each quadrant wins. */
+	for (c = 1; c < 256; c++) {
+		unsigned char t = (ft->ascii_flag && ft->remap_flag) ? ft->charset.asc2ebc[c] : (unsigned char) c;
 
-//		if (ft->ascii_flag && ft->cr_flag && (c == '\r' || c == 0x1a))
-		if (ft->unix_text && (c == '\r' || c == 0x1a))
-			continue;
-		else if (ft->ascii_flag && ft->remap_flag)
-			c = ft->charset.ebc2asc[c];
+		for (q = NQ-1; q >= 0; q--) {
+			const unsigned char *ixp = (const unsigned char *) memchr(conv[q].xlate, t, NE);
 
-		*ob++ = c;
+			if (ixp) {
+				tables->encode[q][c] = hSession->charset.asc2ebc[(int) alphas[ixp - conv[q].xlate]];
+				tables->first[c] = q;
+			}
+		}
 	}
 
-	return ob - ob0;
 }
 
 /**
- * Convert a buffer for downloading (local->host).
+ * Convert a buffer for uploading (host->local). Overwrites the buffer.
+ *
+ * If there is a conversion error, calls cut_abort() and returns -1.
+ *
+ * @return the length of the converted data.
  */
-static int download_convert(H3270FT *ft, unsigned const char *buf, unsigned len, unsigned char *xobuf) {
-	H3270 *hSession = ft->host;
-	unsigned char	* ob0 = xobuf;
-	unsigned char	* ob = ob0;
+static int upload_convert(H3270 *hSession, unsigned char *buf, int len) {
+	unsigned char					* ob0	= buf;
+	unsigned char					* ob	= ob0;
+	H3270FT							* ft	= get_ft_handle(hSession);
+	const struct _ft_cut_tables		* tables = ft->cut_tables;
+	int								  quadrant = ft->quadrant;
 
 	while (len--) {
-		unsigned char c = *buf++;
-		unsigned char *ixp;
-		unsigned ix;
-		int oq;
-
-		/* Handle nulls separately. */
-		if (!c) {
-			if (ft->quadrant != OTHER_2) {
-				ft->quadrant = OTHER_2;
-				*ob++ = conv[ft->quadrant].selector;
-			}
-			*ob++ = XLATE_NULL;
-			continue;
-		}
+		unsigned char	c = *buf++;
+		unsigned short	v;
 
-		/* Translate. */
-		if (ft->ascii_flag && ft->remap_flag)
-			c = ft->charset.asc2ebc[c];
+		if (quadrant >= 0) {
+			v = tables->decode[quadrant][c];
 
-		/* Quadrant already defined. */
-		if (ft->quadrant >= 0) {
-			ixp = (unsigned char *)memchr(conv[ft->quadrant].xlate, c, NE);
-			if (ixp != (unsigned char *)NULL) {
-				ix = ixp - conv[ft->quadrant].xlate;
-				*ob++ = hSession->charset.asc2ebc[(int)alphas[ix]];
+			if (v < CUT_DECODE_SKIP) {
+				*ob++ = (unsigned char) v;
 				continue;
 			}
-		}
 
-		/* Locate a quadrant. */
-		oq = ft->quadrant;
-		for (ft->quadrant = 0; ft->quadrant < NQ; ft->quadrant++) {
-			if (ft->quadrant == oq)
+			if (v == CUT_DECODE_SKIP)
 				continue;
 
-			ixp = (unsigned char *)memchr(conv[ft->quadrant].xlate, c, NE);
+			if (v == CUT_DECODE_ERROR) {
+				ft->quadrant = quadrant;
+				cut_abort(hSession,SC_ABORT_XMIT, "%s", _("Data conversion error"));
+				return -1;
+			}
 
-			if (ixp == (unsigned char *)NULL)
-				continue;
-			ix = ixp - conv[ft->quadrant].xlate;
-			*ob++ = conv[ft->quadrant].selector;
-			*ob++ = hSession->charset.asc2ebc[(int)alphas[ix]];
-			break;
+			/* Try a different quadrant. */
 		}
-		if (ft->quadrant >= NQ) {
-			ft->quadrant = -1;
-			fprintf(stderr, "Oops\n");
-			continue;
+
+		/* Find the quadrant. */
+		quadrant = tables->selector[c];
+		if (quadrant < 0) {
+			ft->quadrant = NQ;
+			cut_abort(hSession,SC_ABORT_XMIT, "%s", _("Data conversion error"));
+			return -1;
 		}
 	}
+
+	ft->quadrant = quadrant;
+
 	return ob - ob0;
 }
 
+/**
+ * Convert a byte for downloading (local->host).
+ *
+ * @return Number of bytes stored on xobuf (up to 2).
+ */
+static int download_convert(H3270FT *ft, unsigned char c, unsigned char *xobuf) {
+	const struct _ft_cut_tables	* tables = ft->cut_tables;
+
+	/* Handle nulls separately. */
+	if (!c) {
+		if (ft->quadrant != OTHER_2) {
+			ft->quadrant = OTHER_2;
+			xobuf[0] = conv[OTHER_2].selector;
+			xobuf[1] = XLATE_NULL;
+			return 2;
+		}
+		xobuf[0] = XLATE_NULL;
+		return 1;
+	}
+
+	/* Quadrant already defined. */
+	if (ft->quadrant >= 0 && tables->encode[ft->quadrant][c]) {
+		xobuf[0] = tables->encode[ft->quadrant][c];
+		return 1;
+	}
+
+	/* Locate a quadrant. */
+	ft->quadrant = tables->first[c];
+	if (ft->quadrant < 0)
+		return 0;
+
+	xobuf[0] = conv[ft->quadrant].selector;
+	xobuf[1] = tables->encode[ft->quadrant][c];
+	return 2;
+}
+
 /*
  * Main entry point from ctlr.c.
  * We have received what looks like an appropriate message from the host.
@@ -319,6 +359,7 @@ static void cut_control_code(H3270 *hSession) {
 		ft->expanded_length = 0;
 		ft->quadrant = -1;
 		ft->xlate_buffered = 0;
+		cut_build_tables(hSession,ft);
 		cut_ack(hSession);
 		ft_running(hSession->ft,True);
 		break;
@@ -378,9 +419,9 @@ static void cut_data_request(H3270 *hSession) {
 	unsigned char	  seq	= hSession->ea_buf[O_DR_FRAME_SEQ].cc;
 	int				  count;
 	unsigned char	  cs;
-	int				  c;
 	int				  i;
 	unsigned char	  attr;
+	unsigned char	  data[O_UP_MAX];
 
 	trace_ds(hSession,"< FT DATA_REQUEST %u\n", from6(hSession, seq));
 	if (lib3270_get_ft_state(hSession) == LIB3270_FT_STATE_ABORT_WAIT) {
@@ -389,28 +430,23 @@ static void cut_data_request(H3270 *hSession) {
 	}
 
 
-	/* Copy data into the screen buffer. */
-	count = 0;
-	while (count < O_UP_MAX && (c = xlate_getc(hSession->ft)) != EOF) {
-		ctlr_add(hSession,O_UP_DATA + count, c, 0);
-		count++;
-	}
-
-	/* Check for errors. */
-	if (ferror(((H3270FT *) hSession->ft)->local_file)) {
-		int j;
+	/* Translate a frame and check for errors. */
+	count = xlate_read(ft, data, O_UP_MAX);
 
-		/* Clean out any data we may have written. */
-		for (j = 0; j < count; j++)
-			ctlr_add(hSession,O_UP_DATA + j, 0, 0);
+	if (ft_reader_error(ft->reader)) {
+		int rc = ft_reader_error(ft->reader);
 
 		/* Abort the transfer. */
-		cut_abort(hSession,SC_ABORT_FILE,_( "Error \"%s\" reading from local file (rc=%d)" ), strerror(errno), errno);
+		cut_abort(hSession,SC_ABORT_FILE,_( "Error \"%s\" reading from local file (rc=%d)" ), strerror(rc), rc);
 		return;
 	}
 
+	/* Copy data into the screen buffer. */
+	for (i = 0; i < count; i++)
+		ctlr_add(hSession,O_UP_DATA + i, data[i], 0);
+
 	/* Send special data for EOF. */
-	if (!count && feof(((H3270FT *) hSession->ft)->local_file)) {
+	if (!count && ft_reader_eof(ft->reader)) {
 		ctlr_add(hSession,O_UP_DATA, EOF_DATA1, 0);
 		ctlr_add(hSession,O_UP_DATA+1, EOF_DATA2, 0);
 		count = 2;
@@ -546,53 +582,73 @@ static void cut_abort(H3270 *hSession, unsigned short reason, const char *fmt, .
 }
 
 /**
- * Get the next translated character from the local file.
+ * @brief Fill a buffer with translated data from the local file.
  *
- * @return the character (in EBCDIC), or EOF.
+ * Expansions that don't fit are kept on the xlate buffer for the next call.
+ *
+ * @return Number of bytes (in EBCDIC) stored on the buffer.
  */
-static int xlate_getc(H3270FT *ft) {
-	int r;
-	int c;
-	unsigned char cc;
-	unsigned char cbuf[4];
-	int nc;
+static int xlate_read(H3270FT *ft, unsigned char *buffer, int max) {
+	const struct _ft_cut_tables	* tables = ft->cut_tables;
+	int							  count = 0;
 
 	/* If there is a data buffered, return it. */
-	if (ft->xlate_buffered) {
-		r = ft->xlate_buf[ft->xlate_buf_ix];
-		ft->xlate_buf_ix++;
+	while (ft->xlate_buffered && count < max) {
+		buffer[count++] = ft->xlate_buf[ft->xlate_buf_ix++];
 		ft->xlate_buffered--;
-		return r;
 	}
 
-	/* Get the next byte from the file. */
-	c = fgetc(ft->local_file);
-	if (c == EOF)
-		return c;
-	ft->ft_length++;
+	if (!ft->reader)
+		ft->reader = ft_reader_new(ft->local_file);
 
-	/* Expand it. */
-	if (ft->ascii_flag && ft->cr_flag && !ft->ft_last_cr && c == '\n') {
-		nc = download_convert(ft,(unsigned const char *)"\r", 1, cbuf);
-	} else {
-		nc = 0;
-		ft->ft_last_cr = (c == '\r') ? 1 : 0;
-	}
+	while (count < max) {
+		const unsigned char	* data;
+		size_t				  available = ft_reader_peek(ft->reader, &data, (size_t) (max - count));
+		size_t				  ix;
 
-	/* Convert it. */
-	cc = (unsigned char)c;
-	nc += download_convert(ft,&cc, 1, &cbuf[nc]);
+		if (!available)
+			break;
 
-	/* Return it and buffer what's left. */
-	r = cbuf[0];
-	if (nc > 1) {
-		int i;
+		for (ix = 0; ix < available && count < max; ix++) {
+			unsigned char	c = data[ix];
+			unsigned char	cbuf[4];
+			int				nc;
+			int				i;
 
-		for (i = 1; i < nc; i++)
-			ft->xlate_buf[ft->xlate_buffered++] = cbuf[i];
-		ft->xlate_buf_ix = 0;
+			/* Fast path: mapped by the current quadrant. */
+			if (ft->quadrant >= 0 && tables->encode[ft->quadrant][c] && c != '\n' && c != '\r') {
+				buffer[count++] = tables->encode[ft->quadrant][c];
+				ft->ft_last_cr = 0;
+				continue;
+			}
+
+			/* Expand it. */
+			if (ft->ascii_flag && ft->cr_flag && !ft->ft_last_cr && c == '\n') {
+				nc = download_convert(ft, '\r', cbuf);
+			} else {
+				nc = 0;
+				ft->ft_last_cr = (c == '\r') ? 1 : 0;
+			}
+
+			/* Convert it. */
+			nc += download_convert(ft, c, &cbuf[nc]);
+
+			/* Store it and buffer what's left. */
+			for (i = 0; i < nc && count < max; i++)
+				buffer[count++] = cbuf[i];
+
+			if (i < nc) {
+				ft->xlate_buf_ix = 0;
+				while (i < nc)
+					ft->xlate_buf[ft->xlate_buffered++] = cbuf[i++];
+			}
+		}
+
+		ft->ft_length += ix;
+		ft_reader_consume(ft->reader, ix);
 	}
-	return r;
+
+	return count;
 }
 
 #endif /*]*/
@@ -87,6 +87,82 @@ static void dft_open_request(H3270 *hSession, unsigned short len, unsigned char
 static void dft_set_cur_req(H3270 *hSession);
 static int  filter_len(char *s, register int len);
 
+/// @brief Get the largest record the host accepts.
+static int dft_get_limit(H3270 *hSession) {
+	if (hSession->dft_limit)
+		return hSession->dft_limit;
+	return hSession->dft_buffersize ? hSession->dft_buffersize : DFT_BUF;
+}
+
+/**
+ * @brief Get the upload record size for the transfer.
+ *
+ * Uses the transfer buffer size (or the session default) limited to the
+ * value sent on the last query reply; in auto mode starts with DFT_BUF.
+ *
+ */
+static void dft_set_record_size(H3270 *hSession, H3270FT *ft) {
+	int limit = dft_get_limit(hSession);
+	int size  = ft->dft ? ft->dft : hSession->dft_buffersize;
+
+	ft->dft_auto = (size == LIB3270_DFT_BUFFER_AUTO || (!ft->dft && hSession->dft_auto)) ? 1 : 0;
+	ft->dft_settled = 0;
+
+	if (ft->dft_auto || !size)
+		size = DFT_BUF;
+	else if (size < DFT_MIN_BUF)
+		size = DFT_MIN_BUF;
+	else if (size > DFT_MAX_BUF)
+		size = DFT_MAX_BUF;
+
+	ft->dft_size = (size > limit) ? limit : size;
+	ft->dft_best = ft->dft_size;
+	ft->dft_rate = 0;
+	ft->dft_sent_length = 0;
+}
+
+/**
+ * @brief Measure the round trip time of the last Get reply and adapt the record size.
+ *
+ * In auto mode the record size doubles while the throughput improves, and steps
+ * back to the best size when it drops more than 10%.
+ *
+ */
+static void dft_measure(H3270 *hSession, H3270FT *ft) {
+	struct timeval	  now;
+	double			  rate;
+	int				  limit = dft_get_limit(hSession);
+
+	if (!ft->dft_sent_length)
+		return;
+
+	(void) gettimeofday(&now, (struct timezone *)NULL);
+	ft->dft_rtt = ((now.tv_sec - ft->dft_sent.tv_sec) * 1000000L) + (now.tv_usec - ft->dft_sent.tv_usec);
+	if (!ft->dft_rtt)
+		ft->dft_rtt = 1;
+
+	rate = ((double) ft->dft_sent_length) * 1.0e6 / ((double) ft->dft_rtt);
+	ft->dft_sent_length = 0;
+
+	trace_ds(hSession," (rtt=%lu us)", ft->dft_rtt);
+
+	if (!ft->dft_auto)
+		return;
+
+	if (rate >= ft->dft_rate) {
+		ft->dft_rate = rate;
+		ft->dft_best = ft->dft_size;
+		if (!ft->dft_settled && ft->dft_size < limit) {
+			ft->dft_size *= 2;
+			if (ft->dft_size > limit)
+				ft->dft_size = limit;
+		}
+	} else if (rate < (ft->dft_rate * 0.9) && ft->dft_size > ft->dft_best) {
+		ft->dft_size = ft->dft_best;
+		ft->dft_settled = 1;
+	}
+}
+
 /**
  * @brief Process a Transfer Data structured field from the host.
  *
@@ -185,6 +261,8 @@ static void dft_open_request(H3270 *hSession, unsigned short len, unsigned char
 	ft->dft_eof = 0;
 	ft->recnum = 1;
 
+	dft_set_record_size(hSession,ft);
+
 	/* Acknowledge the Open. */
 	trace_ds(hSession,"> WriteStructuredField FileTransferData OpenAck\n");
 	hSession->output.ptr = hSession->output.buf;
@@ -261,18 +339,17 @@ static void dft_data_insert(H3270 *hSession, struct data_buffer *data_bufr) {
 			lib3270_free(msgp);
 		}
 	} else if (my_length > 0) {
-		/* Write the data out to the file. */
-		int rv = 1;
+		/* Queue the data to the local file. */
+		int rc = 0;
+
+		if (!ft->writer)
+			ft->writer = ft_writer_new(ft->local_file);
 
 		if (ft->ascii_flag && ft->remap_flag) {
 			/* Filter. */
-			unsigned char *s = (unsigned char *)data_bufr->data;
-			unsigned len = my_length;
-
-			while (len--) {
-				*s = ft->charset.ebc2asc[*s];
-				s++;
-			}
+			unsigned char table[256];
+			lib3270_charset_bytes(table,ft->charset.ebc2asc);
+			lib3270_charset_translate((unsigned char *) data_bufr->data,(unsigned char *) data_bufr->data,(size_t) my_length,table);
 		}
 
 //		if (ft->ascii_flag && ft->cr_flag)
@@ -282,13 +359,11 @@ static void dft_data_insert(H3270 *hSession, struct data_buffer *data_bufr) {
 			char *s = (char *)data_bufr->data;
 			unsigned len = my_length;
 
-			while (len) {
+			while (len && !rc) {
 				unsigned l = filter_len(s, len);
 
 				if (l) {
-					rv = fwrite(s, l, (size_t)1,ft->local_file);
-					if (rv == 0)
-						break;
+					rc = ft_writer_write(ft->writer, s, l);
 					ft->ft_length += l;
 				}
 				if (l < len)
@@ -297,13 +372,13 @@ static void dft_data_insert(H3270 *hSession, struct data_buffer *data_bufr) {
 				len -= l;
 			}
 		} else {
-			rv = fwrite((char *)data_bufr->data, my_length,(size_t)1, ft->local_file);
+			rc = ft_writer_write(ft->writer, data_bufr->data, my_length);
 			ft->ft_length += my_length;
 		}
 
-		if (!rv) {
-			/* write failed */
-			dft_abort(hSession,TR_DATA_INSERT, _( "Error \"%s\" writing to local file (rc=%d)" ), strerror(errno), errno);
+		if (rc) {
+			/* write failed (now or on a previous record) */
+			dft_abort(hSession,TR_DATA_INSERT, _( "Error \"%s\" writing to local file (rc=%d)" ), strerror(rc), rc);
 		}
 
 		/* Add up amount transferred. */
@@ -330,15 +405,88 @@ static void dft_set_cur_req(H3270 *hSession) {
 	/* Currently doesn't do anything. */
 }
 
+/**
+ * @brief Fill the buffer with a text file, expanding the unix line ends to CR/LF.
+ *
+ * @return Number of bytes stored.
+ */
+static size_t read_unix_text(H3270FT *ft, unsigned char *buffer, size_t length) {
+	unsigned char * bufptr = buffer;
+	size_t			room = length;
+
+	while(room) {
+		const unsigned char	* data;
+		const unsigned char	* nl;
+		size_t				  available = ft_reader_peek(ft->reader,&data,room);
+
+		if(!available)
+			break;
+
+		nl = memchr(data,'\n',available);
+
+		if(nl != data) {
+			// Copy up to the next line end.
+			size_t bytes = nl ? (size_t) (nl - data) : available;
+
+			memcpy(bufptr,data,bytes);
+			ft->ft_last_cr = (data[bytes-1] == '\r') ? 1 : 0;
+			ft_reader_consume(ft->reader,bytes);
+			bufptr += bytes;
+			room -= bytes;
+			continue;
+		}
+
+		if(!ft->ft_last_cr) {
+			if(room < 2) {
+				// Not enough room to expand NL to CR/LF.
+				break;
+			}
+			*bufptr++ = '\r';
+			room--;
+		}
+
+		*bufptr++ = '\n';
+		room--;
+		ft->ft_last_cr = 0;
+		ft_reader_consume(ft->reader,1);
+	}
+
+	return bufptr - buffer;
+}
+
+/**
+ * @brief Fill the buffer with a binary file.
+ *
+ * @return Number of bytes stored.
+ */
+static size_t read_binary(H3270FT *ft, unsigned char *buffer, size_t length) {
+	size_t total = 0;
+
+	while(total < length) {
+		const unsigned char	* data;
+		size_t				  available = ft_reader_peek(ft->reader,&data,length - total);
+
+		if(!available)
+			break;
+
+		memcpy(buffer+total,data,available);
+		ft_reader_consume(ft->reader,available);
+		total += available;
+	}
+
+	return total;
+}
+
 /* Process a Get request. */
 static void dft_get_request(H3270 *hSession) {
 	int				  numbytes;
-	size_t			  numread;
 	size_t 			  total_read = 0;
 	unsigned char	* bufptr;
 	H3270FT 		* ft = get_ft_handle(hSession);
 
-	trace_ds(hSession," Get\n");
+	trace_ds(hSession," Get");
+	dft_measure(hSession,ft);
+	trace_ds(hSession,"\n");
 
 	if (!ft->message_flag && lib3270_get_ft_state(hSession) == LIB3270_FT_STATE_ABORT_WAIT) {
 		dft_abort(hSession,TR_GET_REQ, _( "Transfer cancelled by user" ) );
@@ -346,71 +494,37 @@ static void dft_get_request(H3270 *hSession) {
 	}
 
 	/* Read a buffer's worth. */
-	lib3270_set_dft_buffersize(hSession,hSession->dft_buffersize);
-	space3270out(hSession,hSession->dft_buffersize);
-	numbytes = hSession->dft_buffersize - 27; /* always read 5 bytes less than we're allowed */
+	if (!ft->dft_size)
+		dft_set_record_size(hSession,ft);
+	space3270out(hSession,ft->dft_size);
+	numbytes = ft->dft_size - 27; /* always read 5 bytes less than we're allowed */
 	bufptr = hSession->output.buf + 17;
 
-	while (!ft->dft_eof && numbytes) {
-		if (ft->unix_text) {
-			// ASCII text file
-
-			int c;
-
-			/* Read one byte and do CR/LF translation. */
-			c = fgetc(ft->local_file);
-			if (c == EOF) {
-				break;
-			}
-			if (!ft->ft_last_cr && c == '\n') {
-				if (numbytes < 2) {
-					/*
-					 * Not enough room to expand NL to
-					 * CR/LF.
-					 */
-					ungetc(c, ft->local_file);
-					break;
-				}
-				*bufptr++ = '\r';
-				numbytes--;
-				total_read++;
-			}
-			ft->ft_last_cr = (c == '\r') ? 1 : 0;
-			*bufptr++ = ft->remap_flag ? ft->charset.asc2ebc[c]: c;
-			numbytes--;
-			total_read++;
-		} else {
-			/* Binary read. */
-			numread = fread(bufptr, 1, numbytes, ft->local_file);
-			if (numread <= 0) {
-				lib3270_write_log(hSession,"Error %s reading source file (rc=%d)",strerror(errno),errno);
-				break;
-			}
+	if (!ft->reader)
+		ft->reader = ft_reader_new(ft->local_file);
 
-			if (ft->ascii_flag && ft->remap_flag) {
-				// Remap charset
-				unsigned char *s = bufptr;
-				int i = numread;
+	if (!ft->dft_eof) {
+		unsigned char table[256];
 
-				while (i) {
-					*s = ft->charset.asc2ebc[*s];
-					s++;
-					i--;
-				}
-			}
-			bufptr 		+= numread;
-			numbytes	-= numread;
-			total_read	+= numread;
-		}
+		if (ft->remap_flag)
+			lib3270_charset_bytes(table,ft->charset.asc2ebc);
 
-		if (feof(ft->local_file) || ferror(ft->local_file)) {
-			break;
+		if (ft->unix_text) {
+			// ASCII text file, CR/LF translation (CR and LF are the same on the transfer charset).
+			total_read = read_unix_text(ft,bufptr,numbytes);
+			if (ft->remap_flag)
+				lib3270_charset_translate(bufptr,bufptr,total_read,table);
+		} else {
+			total_read = read_binary(ft,bufptr,numbytes);
+			if (ft->ascii_flag && ft->remap_flag)
+				lib3270_charset_translate(bufptr,bufptr,total_read,table);
 		}
 	}
 
 	/* Check for read error. */
-	if (ferror(((H3270FT *) hSession->ft)->local_file)) {
-		dft_abort(hSession,TR_GET_REQ, _( "Error \"%s\" reading from local file (rc=%d)" ), strerror(errno), errno);
+	if (ft_reader_error(ft->reader)) {
+		int rc = ft_reader_error(ft->reader);
+		dft_abort(hSession,TR_GET_REQ, _( "Error \"%s\" reading from local file (rc=%d)" ), strerror(rc), rc);
 		return;
 	}
 
@@ -433,7 +547,7 @@ static void dft_get_request(H3270 *hSession) {
 
 		ft->ft_length += total_read;
 
-		if (feof(ft->local_file)) {
+		if (ft_reader_eof(ft->reader)) {
 			ft->dft_eof = 1;
 		}
 
@@ -462,6 +576,10 @@ static void dft_get_request(H3270 *hSession) {
 
 	/* Write the data. */
 	net_output(hSession);
+
+	(void) gettimeofday(&ft->dft_sent, (struct timezone *)NULL);
+	ft->dft_sent_length = total_read;
+
 	ft_update_length(get_ft_handle(hSession));
 }
 
@@ -471,7 +589,19 @@ static void dft_close_request(H3270 *hSession) {
 	 * Recieved a close request from the system.
 	 * Return a close acknowledgement.
 	 */
+	H3270FT *ft = get_ft_handle(hSession);
+
 	trace_ds(hSession," Close\n");
+
+	if (ft->writer && !ft->message_flag) {
+		/* All data must be on the local file before the host reports success. */
+		int rc = ft_writer_flush(ft->writer);
+		if (rc) {
+			dft_abort(hSession,TR_CLOSE_REQ, _( "Error \"%s\" writing to local file (rc=%d)" ), strerror(rc), rc);
+			return;
+		}
+	}
+
 	trace_ds(hSession,"> WriteStructuredField FileTransferData CloseAck\n");
 	hSession->output.ptr = hSession->output.buf;
 	space3270out(hSession,6);
@@ -557,6 +687,11 @@ void set_dft_buffersize(H3270 *hSession)
 LIB3270_EXPORT int	lib3270_set_dft_buffersize(H3270 *hSession, int dft_buffersize) {
 	CHECK_SESSION_HANDLE(hSession);
 
+	hSession->dft_auto = (dft_buffersize == LIB3270_DFT_BUFFER_AUTO) ? 1 : 0;
+
+	if (hSession->dft_auto)
+		dft_buffersize = DFT_MAX_BUF;
+
 	hSession->dft_buffersize = dft_buffersize;
 
 	if (hSession->dft_buffersize == 0)
@@ -568,6 +703,8 @@ LIB3270_EXPORT int	lib3270_set_dft_buffersize(H3270 *hSession, int dft_buffersiz
 	if (hSession->dft_buffersize < DFT_MIN_BUF)
 		hSession->dft_buffersize = DFT_MIN_BUF;
 
+	query_reply_reset(hSession);
+
 	return 0;
 }
 
@@ -0,0 +1,410 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como ft_queue.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief File transfer queue.
+ *
+ * IND$FILE handles one file at a time, the queue starts each transfer as
+ * soon as the previous one is finished and the host is ready for the next
+ * command; uploads are opened (and mapped) while the current transfer drains.
+ *
+ */
+
+#include <config.h>
+#include <internals.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <lib3270/filetransfer.h>
+#include <lib3270/log.h>
+#include <lib3270/trace.h>
+#include "ftc.h"
+#include "utilc.h"
+
+/// @brief Interval to check for the session (ms), the queue is also checked when the keyboard unlocks.
+#define FT_QUEUE_POLL	500
+
+/// @brief Delay to start the next transfer (ms), AddTimer() turns a zero interval into 100ms.
+#define FT_QUEUE_NEXT	1
+
+typedef struct _ft_queue_entry {
+	struct _ft_queue_entry	* next;
+
+	LIB3270_FT_OPTION		  flags;
+	int						  lrecl;
+	int						  blksize;
+	int						  primspace;
+	int						  secspace;
+	int						  dft;
+
+	FILE					* file;			///< @brief Local file opened ahead (uploads only).
+	FT_READER				* reader;		///< @brief Reader for the local file opened ahead.
+
+	const char				* local;
+	const char				* remote;
+
+} FT_QUEUE_ENTRY;
+
+struct _lib3270_ft_queue {
+	FT_QUEUE_ENTRY				* first;
+	FT_QUEUE_ENTRY				* last;
+	unsigned int				  length;
+
+	H3270FT						* current;		///< @brief Transfer started by the queue.
+	void						* timer;
+	unsigned int				  polling : 1;	///< @brief The timer is waiting for the session.
+
+	struct lib3270_ft_callbacks	  cbk;
+	void						* user_data;
+
+	// Totals since the queue was idle.
+	unsigned int				  files;
+	unsigned int				  failed;
+	unsigned long				  bytes;
+	struct timeval				  started;
+};
+
+static struct _lib3270_ft_queue * get_queue(H3270 *hSession) {
+
+	if(!hSession->ft_queue)
+		hSession->ft_queue = lib3270_malloc(sizeof(struct _lib3270_ft_queue));
+
+	return hSession->ft_queue;
+}
+
+static void entry_free(FT_QUEUE_ENTRY *entry) {
+
+	ft_reader_free(entry->reader);
+
+	if(entry->file)
+		fclose(entry->file);
+
+	lib3270_free(entry);
+}
+
+/// @brief Open the local file of a queued upload, the file system can load it while the current transfer runs.
+static void open_ahead(FT_QUEUE_ENTRY *entry) {
+
+	if(!entry || entry->file || (entry->flags & LIB3270_FT_OPTION_RECEIVE))
+		return;
+
+#ifdef _WIN32
+	entry->file = fopen(entry->local,"rb");
+#else
+	entry->file = fopen(entry->local,"r");
+#endif // _WIN32
+
+	if(!entry->file)
+		return;	// The error is reported when the transfer starts.
+
+	entry->reader = ft_reader_new(entry->file);
+	ft_reader_prefetch(entry->reader);
+
+}
+
+/// @brief Send the totals to the message callback.
+static void report(H3270 *hSession, struct _lib3270_ft_queue *queue) {
+	struct timeval	  t1;
+	double			  seconds;
+	char			* text;
+
+	(void) gettimeofday(&t1, (struct timezone *)NULL);
+	seconds = ((double)(t1.tv_sec - queue->started.tv_sec) + (double)(t1.tv_usec - queue->started.tv_usec) / 1.0e6);
+
+	text = lib3270_strdup_printf(
+	           _( "%u file(s) transferred, %u failed, %lu bytes at %.2f KB/s" ),
+	           queue->files,
+	           queue->failed,
+	           queue->bytes,
+	           seconds > 0 ? ((double) queue->bytes / 1024.0 / seconds) : 0.0
+	       );
+
+	lib3270_write_event_trace(hSession,"%s\n",text);
+
+	if(queue->cbk.message)
+		queue->cbk.message(hSession,text,queue->user_data);
+	else
+		lib3270_write_log(hSession,"ft","%s",text);
+
+	lib3270_free(text);
+
+	queue->files	= 0;
+	queue->failed	= 0;
+	queue->bytes	= 0;
+
+}
+
+/// @brief Report a transfer that couldn't be created.
+static void start_failed(H3270 *hSession, struct _lib3270_ft_queue *queue, const FT_QUEUE_ENTRY *entry, const char *message) {
+
+	queue->failed++;
+
+	lib3270_write_event_trace(hSession,"Can't start transfer of %s: %s\n",entry->local,message);
+
+	if(queue->cbk.failed)
+		queue->cbk.failed(hSession,0,0,message,queue->user_data);
+	else
+		lib3270_write_log(hSession,"ft","Can't start transfer of %s: %s",entry->local,message);
+
+}
+
+static void schedule(H3270 *hSession, struct _lib3270_ft_queue *queue, unsigned long interval);
+
+/// @brief Start the next queued transfer.
+static int queue_step(H3270 *hSession, void GNUC_UNUSED(*userdata)) {
+	struct _lib3270_ft_queue	* queue = hSession->ft_queue;
+	FT_QUEUE_ENTRY				* entry;
+	H3270FT						* ft;
+	const char					* message = NULL;
+
+	if(!queue)
+		return 0;
+
+	// The timer is destroyed when this call returns.
+	queue->timer = NULL;
+
+	if(lib3270_is_connected(hSession) && !lib3270_is_ready(hSession)) {
+		// The host is still closing the last transfer or not ready for the next command.
+		schedule(hSession,queue,FT_QUEUE_POLL);
+		return 0;
+	}
+
+	if(hSession->ft) {
+
+		if(hSession->ft != queue->current || hSession->ft->state != LIB3270_FT_STATE_NONE) {
+			// Wait for the active transfer.
+			schedule(hSession,queue,FT_QUEUE_POLL);
+			return 0;
+		}
+
+		lib3270_ft_destroy(hSession,NULL);
+	}
+
+	if(!queue->first) {
+		if(queue->files || queue->failed)
+			report(hSession,queue);
+		return 0;
+	}
+
+	entry = queue->first;
+	queue->first = entry->next;
+	if(!queue->first)
+		queue->last = NULL;
+	queue->length--;
+
+	if(!(queue->files || queue->failed))
+		(void) gettimeofday(&queue->started, (struct timezone *)NULL);
+
+	ft = ft_new(hSession,entry->flags,entry->local,entry->remote,entry->lrecl,entry->blksize,entry->primspace,entry->secspace,entry->dft,entry->file,&message);
+
+	if(!ft) {
+		start_failed(hSession,queue,entry,message);
+		entry_free(entry);
+		schedule(hSession,queue,FT_QUEUE_NEXT);
+		return 0;
+	}
+
+	// The file and the reader now belong to the transfer.
+	ft->reader = entry->reader;
+	entry->file = NULL;
+	entry->reader = NULL;
+	entry_free(entry);
+
+	if(queue->cbk.complete)
+		ft->cbk.complete = queue->cbk.complete;
+	if(queue->cbk.failed)
+		ft->cbk.failed = queue->cbk.failed;
+	if(queue->cbk.message)
+		ft->cbk.message = queue->cbk.message;
+	if(queue->cbk.update)
+		ft->cbk.update = queue->cbk.update;
+	if(queue->cbk.running)
+		ft->cbk.running = queue->cbk.running;
+	if(queue->cbk.aborting)
+		ft->cbk.aborting = queue->cbk.aborting;
+	if(queue->cbk.state_changed)
+		ft->cbk.state_changed = queue->cbk.state_changed;
+
+	ft->user_data = queue->user_data;
+	queue->current = ft;
+
+	open_ahead(queue->first);
+
+	// On failure the transfer is finished through ft_failed(), the queue goes on from there.
+	lib3270_ft_start(hSession);
+
+	return 0;
+}
+
+static void schedule(H3270 *hSession, struct _lib3270_ft_queue *queue, unsigned long interval) {
+	if(!queue->timer) {
+		queue->polling = (interval == FT_QUEUE_POLL) ? 1 : 0;
+		queue->timer = AddTimer(interval, hSession, queue_step, NULL);
+	}
+}
+
+void lib3270_ft_queue_wakeup(H3270 *hSession) {
+	struct _lib3270_ft_queue * queue = hSession->ft_queue;
+
+	if(queue && queue->timer && queue->polling) {
+		RemoveTimer(hSession,queue->timer);
+		queue->timer = NULL;
+		schedule(hSession,queue,FT_QUEUE_NEXT);
+	}
+
+}
+
+LIB3270_EXPORT int lib3270_ft_enqueue(H3270 *hSession, LIB3270_FT_OPTION flags, const char *local, const char *remote, int lrecl, int blksize, int primspace, int secspace, int dft) {
+	struct _lib3270_ft_queue	* queue;
+	FT_QUEUE_ENTRY				* entry;
+
+	CHECK_SESSION_HANDLE(hSession);
+
+	if(!(local && *local && remote && *remote))
+		return errno = EINVAL;
+
+	queue = get_queue(hSession);
+
+	entry = lib3270_malloc(sizeof(FT_QUEUE_ENTRY)+strlen(local)+strlen(remote)+2);
+
+	entry->flags		= flags;
+	entry->lrecl		= lrecl;
+	entry->blksize		= blksize;
+	entry->primspace	= primspace;
+	entry->secspace		= secspace;
+	entry->dft			= dft;
+
+	entry->local		= (char *) (entry+1);
+	strcpy((char *) entry->local,local);
+
+	entry->remote		= entry->local + strlen(local) + 1;
+	strcpy((char *) entry->remote,remote);
+
+	if(queue->last)
+		queue->last->next = entry;
+	else
+		queue->first = entry;
+
+	queue->last = entry;
+	queue->length++;
+
+	lib3270_write_event_trace(hSession,"Transfer of %s queued (%u pending)\n",local,queue->length);
+
+	// Open it now if the queue is already busy, the transfer can start at any moment.
+	if(queue->current && queue->first == entry)
+		open_ahead(entry);
+
+	schedule(hSession,queue,FT_QUEUE_NEXT);
+
+	return 0;
+}
+
+LIB3270_EXPORT struct lib3270_ft_callbacks * lib3270_ft_queue_get_callbacks(H3270 *hSession, unsigned short sz) {
+
+	CHECK_SESSION_HANDLE(hSession);
+
+	if(sz != sizeof(struct lib3270_ft_callbacks))
+		return NULL;
+
+	return &(get_queue(hSession)->cbk);
+}
+
+LIB3270_EXPORT void lib3270_ft_queue_set_user_data(H3270 *hSession, void *ptr) {
+	CHECK_SESSION_HANDLE(hSession);
+	get_queue(hSession)->user_data = ptr;
+}
+
+LIB3270_EXPORT unsigned int lib3270_ft_queue_get_length(const H3270 *hSession) {
+
+	if(!hSession->ft_queue)
+		return 0;
+
+	return hSession->ft_queue->length;
+}
+
+LIB3270_EXPORT void lib3270_ft_queue_clear(H3270 *hSession) {
+	struct _lib3270_ft_queue * queue;
+
+	CHECK_SESSION_HANDLE(hSession);
+
+	queue = hSession->ft_queue;
+	if(!queue)
+		return;
+
+	while(queue->first) {
+		FT_QUEUE_ENTRY *entry = queue->first;
+		queue->first = entry->next;
+		entry_free(entry);
+	}
+
+	queue->last = NULL;
+	queue->length = 0;
+
+}
+
+void ft_queue_done(H3270FT *ft, int failed) {
+	struct _lib3270_ft_queue * queue = ft->host->ft_queue;
+
+	if(!queue || queue->current != ft)
+		return;
+
+	if(failed)
+		queue->failed++;
+	else
+		queue->files++;
+
+	queue->bytes += ft->ft_length;
+
+	schedule(ft->host,queue,FT_QUEUE_NEXT);
+
+}
+
+void ft_queue_detach(H3270FT *ft) {
+	struct _lib3270_ft_queue * queue = ft->host->ft_queue;
+
+	if(queue && queue->current == ft)
+		queue->current = NULL;
+
+}
+
+void ft_queue_free(H3270 *hSession) {
+	struct _lib3270_ft_queue * queue = hSession->ft_queue;
+
+	if(!queue)
+		return;
+
+	lib3270_ft_queue_clear(hSession);
+
+	if(queue->timer)
+		RemoveTimer(hSession,queue->timer);
+
+	hSession->ft_queue = NULL;
+	lib3270_free(queue);
+
+}
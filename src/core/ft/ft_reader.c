@@ -0,0 +1,206 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como ft_reader.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Block reader for file uploads.
+ *
+ * Hands out the local file in large contiguous blocks so the DFT Get request
+ * can fill each reply with a single bulk copy/translation instead of going
+ * through stdio one byte at a time.
+ *
+ */
+
+#include <config.h>
+#include <internals.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#endif // HAVE_MMAP
+
+#include <lib3270/filetransfer.h>
+#include "ftc.h"
+
+/// @brief Block size for files that can't be mapped.
+#define FT_READER_BLOCK		262144
+
+/// @brief Bytes to load ahead on ft_reader_prefetch().
+#define FT_READER_PREFETCH	4194304
+
+struct _ft_reader {
+	FILE				* file;
+	int					  error;
+
+	const unsigned char	* data;			///< @brief Mapped file or current block.
+	size_t				  length;		///< @brief Bytes on data.
+	size_t				  offset;		///< @brief Bytes consumed from data.
+
+#ifdef HAVE_MMAP
+	void				* map;			///< @brief Mapped region (NULL if using blocks).
+	size_t				  maplength;
+#endif // HAVE_MMAP
+
+	unsigned int		  eof : 1;		///< @brief No more blocks on the file.
+	unsigned char		* block;		///< @brief Block buffer.
+};
+
+#ifdef HAVE_MMAP
+static int map_file(FT_READER *reader) {
+	struct stat	  st;
+	off_t		  position;
+	void		* map;
+
+	if(fstat(fileno(reader->file),&st) || !S_ISREG(st.st_mode) || st.st_size <= 0)
+		return -1;
+
+	// The mapping is used only from the current position.
+	position = ftello(reader->file);
+	if(position < 0 || position > st.st_size || ((unsigned long long) st.st_size) > ((size_t) -1))
+		return -1;
+
+	map = mmap(NULL,(size_t) st.st_size,PROT_READ,MAP_PRIVATE,fileno(reader->file),0);
+	if(map == MAP_FAILED)
+		return -1;
+
+#ifdef MADV_SEQUENTIAL
+	madvise(map,(size_t) st.st_size,MADV_SEQUENTIAL);
+#endif // MADV_SEQUENTIAL
+
+	reader->map			= map;
+	reader->maplength	= (size_t) st.st_size;
+	reader->data		= ((const unsigned char *) map) + position;
+	reader->length		= (size_t) (st.st_size - position);
+	reader->eof			= 1;
+
+	return 0;
+}
+#endif // HAVE_MMAP
+
+FT_READER * ft_reader_new(FILE *file) {
+	FT_READER * reader = lib3270_malloc(sizeof(FT_READER));
+
+	reader->file = file;
+
+#ifdef HAVE_MMAP
+	if(!map_file(reader))
+		return reader;
+#endif // HAVE_MMAP
+
+	reader->block = lib3270_malloc(FT_READER_BLOCK);
+	reader->data = reader->block;
+
+	return reader;
+}
+
+void ft_reader_free(FT_READER *reader) {
+
+	if(!reader)
+		return;
+
+#ifdef HAVE_MMAP
+	if(reader->map)
+		munmap(reader->map,reader->maplength);
+#endif // HAVE_MMAP
+
+	lib3270_free(reader->block);
+	lib3270_free(reader);
+}
+
+/// @brief Load the next block, keeping the bytes not consumed.
+static void load_block(FT_READER *reader) {
+	size_t pending = reader->length - reader->offset;
+	size_t bytes;
+
+	if(pending)
+		memmove(reader->block,reader->block + reader->offset,pending);
+
+	reader->offset = 0;
+	reader->length = pending;
+
+	bytes = fread(reader->block + pending, 1, FT_READER_BLOCK - pending, reader->file);
+	reader->length += bytes;
+
+	if(ferror(reader->file)) {
+		reader->error = errno ? errno : EIO;
+		reader->eof = 1;
+	} else if(feof(reader->file)) {
+		reader->eof = 1;
+	}
+
+}
+
+size_t ft_reader_peek(FT_READER *reader, const unsigned char **data, size_t max) {
+	size_t available = reader->length - reader->offset;
+
+	if(!available && !reader->eof && reader->block) {
+		load_block(reader);
+		available = reader->length - reader->offset;
+	}
+
+	*data = reader->data + reader->offset;
+
+	return available < max ? available : max;
+}
+
+void ft_reader_consume(FT_READER *reader, size_t length) {
+	reader->offset += length;
+}
+
+int ft_reader_eof(FT_READER *reader) {
+
+	if(reader->offset < reader->length)
+		return 0;
+
+	if(!reader->eof && reader->block)
+		load_block(reader);
+
+	return reader->offset >= reader->length;
+}
+
+int ft_reader_error(const FT_READER *reader) {
+	return reader->error;
+}
+
+void ft_reader_prefetch(FT_READER *reader) {
+
+	// Blocks are not loaded ahead, the file position must stay untouched until the transfer starts.
+#if defined(HAVE_MMAP) && defined(MADV_WILLNEED)
+	if(reader->map) {
+		madvise(reader->map,reader->maplength < FT_READER_PREFETCH ? reader->maplength : FT_READER_PREFETCH,MADV_WILLNEED);
+	}
+#else
+	(void) reader;
+#endif // HAVE_MMAP && MADV_WILLNEED
+
+}
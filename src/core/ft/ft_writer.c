@@ -0,0 +1,277 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como ft_writer.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Write-behind for file downloads.
+ *
+ * The session thread only copies the received records into a small ring of
+ * large buffers and acknowledges them; a background thread writes each full
+ * buffer to the local file with a single write() call. When all buffers are
+ * waiting for the disk the session thread blocks, so memory use is bounded.
+ *
+ * Write errors are kept and returned to the session thread on the next
+ * ft_writer_write() or ft_writer_flush() call.
+ *
+ */
+
+#include <config.h>
+#include <internals.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif // HAVE_UNISTD_H
+
+#include <lib3270/filetransfer.h>
+#include "ftc.h"
+
+/// @brief Size of each buffer.
+#define FT_WRITER_BUFFER	262144
+
+/// @brief Number of buffers on the ring.
+#define FT_WRITER_BUFFERS	4
+
+struct _ft_writer {
+
+	pthread_mutex_t	  mutex;
+	pthread_cond_t	  wakeup;					///< @brief Signals the writer thread.
+	pthread_cond_t	  drained;					///< @brief Signals the session thread (buffer written).
+	pthread_t		  thread;
+
+	unsigned int	  started	: 1;			///< @brief Is the writer thread running?
+	unsigned int	  stopping	: 1;			///< @brief Writer thread should exit.
+
+	int				  fd;
+	int				  error;					///< @brief First write error (0 if none).
+
+	unsigned int	  head;						///< @brief Total of buffers queued.
+	unsigned int	  tail;						///< @brief Total of buffers written.
+	size_t			  length;					///< @brief Bytes on the buffer being filled.
+
+	size_t			  queued[FT_WRITER_BUFFERS];	///< @brief Length of the queued buffers.
+	unsigned char	  buffer[FT_WRITER_BUFFERS][FT_WRITER_BUFFER];
+
+};
+
+/// @brief Write a buffer to the file (called without the lock), returns 0 or errno.
+static int ft_writer_output(int fd, const unsigned char *data, size_t length) {
+
+	while(length) {
+
+		ssize_t rc = write(fd,data,length);
+
+		if(rc < 0) {
+			if(errno == EINTR)
+				continue;
+			return errno;
+		}
+
+		if(rc == 0)
+			return EIO;
+
+		data += rc;
+		length -= rc;
+
+	}
+
+	return 0;
+}
+
+static void * ft_writer_thread(void *arg) {
+
+	FT_WRITER * writer = (FT_WRITER *) arg;
+
+	pthread_mutex_lock(&writer->mutex);
+
+	for(;;) {
+
+		if(writer->head == writer->tail) {
+
+			if(writer->stopping)
+				break;
+
+			pthread_cond_wait(&writer->wakeup,&writer->mutex);
+			continue;
+
+		}
+
+		{
+			unsigned int	slot	= writer->tail % FT_WRITER_BUFFERS;
+			size_t			length	= writer->queued[slot];
+			int				rc		= 0;
+
+			// After an error the remaining data is discarded, the transfer is being aborted.
+			if(!writer->error) {
+				// The session thread never touches a queued buffer, it's safe to write it unlocked.
+				pthread_mutex_unlock(&writer->mutex);
+				rc = ft_writer_output(writer->fd,writer->buffer[slot],length);
+				pthread_mutex_lock(&writer->mutex);
+			}
+
+			if(rc && !writer->error)
+				writer->error = rc;
+
+			writer->tail++;
+			pthread_cond_broadcast(&writer->drained);
+		}
+
+	}
+
+	pthread_mutex_unlock(&writer->mutex);
+
+	return NULL;
+}
+
+FT_WRITER * ft_writer_new(FILE *file) {
+
+	FT_WRITER * writer = lib3270_malloc(sizeof(FT_WRITER));
+
+	// Anything already on the stdio buffer goes first.
+	fflush(file);
+
+	pthread_mutex_init(&writer->mutex,NULL);
+	pthread_cond_init(&writer->wakeup,NULL);
+	pthread_cond_init(&writer->drained,NULL);
+
+	writer->fd = fileno(file);
+
+	if(!pthread_create(&writer->thread,NULL,ft_writer_thread,writer))
+		writer->started = 1;
+
+	return writer;
+}
+
+/// @brief Queue the buffer being filled (called with the lock).
+static void ft_writer_queue(FT_WRITER *writer) {
+
+	unsigned int slot = writer->head % FT_WRITER_BUFFERS;
+
+	if(!writer->length)
+		return;
+
+	if(!writer->started) {
+		// No writer thread, write synchronously.
+		int rc = writer->error ? 0 : ft_writer_output(writer->fd,writer->buffer[slot],writer->length);
+		if(rc && !writer->error)
+			writer->error = rc;
+		writer->length = 0;
+		return;
+	}
+
+	writer->queued[slot] = writer->length;
+	writer->length = 0;
+	writer->head++;
+	pthread_cond_signal(&writer->wakeup);
+
+	// Wait for the next buffer.
+	while((writer->head - writer->tail) >= FT_WRITER_BUFFERS)
+		pthread_cond_wait(&writer->drained,&writer->mutex);
+
+}
+
+int ft_writer_write(FT_WRITER *writer, const void *data, size_t length) {
+
+	const unsigned char	* ptr = (const unsigned char *) data;
+	int					  rc;
+
+	pthread_mutex_lock(&writer->mutex);
+
+	while(length && !writer->error) {
+
+		size_t block = FT_WRITER_BUFFER - writer->length;
+
+		if(block > length)
+			block = length;
+
+		memcpy(writer->buffer[writer->head % FT_WRITER_BUFFERS] + writer->length,ptr,block);
+		writer->length += block;
+		ptr += block;
+		length -= block;
+
+		if(writer->length == FT_WRITER_BUFFER)
+			ft_writer_queue(writer);
+
+	}
+
+	rc = writer->error;
+
+	pthread_mutex_unlock(&writer->mutex);
+
+	return rc;
+}
+
+int ft_writer_flush(FT_WRITER *writer) {
+
+	int rc;
+
+	pthread_mutex_lock(&writer->mutex);
+
+	ft_writer_queue(writer);
+
+	while(writer->head != writer->tail)
+		pthread_cond_wait(&writer->drained,&writer->mutex);
+
+	rc = writer->error;
+
+	pthread_mutex_unlock(&writer->mutex);
+
+	return rc;
+}
+
+int ft_writer_free(FT_WRITER *writer) {
+
+	int rc;
+
+	if(!writer)
+		return 0;
+
+	rc = ft_writer_flush(writer);
+
+	if(writer->started) {
+
+		pthread_mutex_lock(&writer->mutex);
+		writer->stopping = 1;
+		pthread_cond_signal(&writer->wakeup);
+		pthread_mutex_unlock(&writer->mutex);
+
+		pthread_join(writer->thread,NULL);
+
+	}
+
+	pthread_cond_destroy(&writer->drained);
+	pthread_cond_destroy(&writer->wakeup);
+	pthread_mutex_destroy(&writer->mutex);
+
+	lib3270_free(writer);
+
+	return rc;
+}
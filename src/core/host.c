@@ -45,8 +45,10 @@
 #include <stdlib.h>
 //#include "resources.h"
 
+#include "3270ds.h"
 #include "hostc.h"
 #include "statusc.h"
+#include "statsc.h"
 #include "popupsc.h"
 #include "telnetc.h"
 #include "trace_dsc.h"
@@ -214,6 +216,11 @@ void lib3270_set_connected_initial(H3270 *hSession) {
 	lib3270_set_cstate(hSession,LIB3270_CONNECTED_INITIAL);
 
 	hSession->starting	= 1;	// Enable autostart
+	query_reply_drop(hSession,QR_RPQNAMES);	// The RPQ names have the socket address.
+	stats_add(hSession->stats.counters.connects,1);
+
+	if(hSession->trace.binary.writer)
+		trace_binary_connect(hSession);
 
 	lib3270_st_changed(hSession, LIB3270_STATE_CONNECT, True);
 	if(hSession->cbk.update_connect)
@@ -226,6 +233,8 @@ void lib3270_set_disconnected(H3270 *hSession) {
 	lib3270_set_cstate(hSession,LIB3270_NOT_CONNECTED);
 	mcursor_set(hSession,LIB3270_POINTER_LOCKED);
 
+	trace_binary(hSession,LIB3270_BINARY_TRACE_DISCONNECT,'>',NULL,0);
+
 	hSession->kybdlock = LIB3270_KL_NOT_CONNECTED;
 	hSession->starting	= 0;
 	hSession->ssl.state	= LIB3270_SSL_UNDEFINED;
@@ -69,6 +69,7 @@ struct ta;
 #include "screenc.h"
 #include "screen.h"
 #include "statusc.h"
+#include "statsc.h"
 #include "telnetc.h"
 #include "togglesc.h"
 #include "trace_dsc.h"
@@ -80,13 +81,11 @@ struct ta;
 
 #include <lib3270/actions.h>
 
-#ifdef X3270_TRACE
 static const char *ia_name[] = {
 	"String", "Paste", "Screen redraw", "Keypad", "Default", "Key",
 	"Macro", "Script", "Peek", "Typeahead", "File transfer", "Command",
 	"Keymap", "Idle"
 };
-#endif // X3270_TRACE
 
 static const unsigned char pf_xlate[] = {
 	AID_PF1,  AID_PF2,  AID_PF3,  AID_PF4,  AID_PF5,  AID_PF6,
@@ -122,12 +121,68 @@ struct akeysym
 static const char dxl[] = "0123456789abcdef";
 #define FROM_HEX(c)	(strchr(dxl, tolower(c)) - dxl)
 
+/// @brief Initial size of the typeahead ring.
+#define TA_RING_INITIAL	16
+
+/// @brief Release the allocated parameters of a typeahead entry.
+static void ta_release(struct ta *ta) {
+	if(ta->type == TA_TYPE_DEFAULT) {
+		lib3270_free(ta->args.def.parm[0]);
+		lib3270_free(ta->args.def.parm[1]);
+	}
+}
+
+/// @brief Store a typeahead parameter, the short ones are kept inside the entry.
+static void ta_set_parm(struct ta *ta, int ix, const char *value) {
+
+	size_t length;
+
+	if(!value)
+		return;
+
+	length = strlen(value);
+
+	if(length < TA_PARM_INLINE) {
+		memcpy(ta->args.def.buffer[ix],value,length+1);
+		ta->args.def.inline_parm |= (1 << ix);
+	} else {
+		ta->args.def.parm[ix] = NewString(value);
+	}
+
+}
+
+static const char * ta_get_parm(const struct ta *ta, int ix) {
+	if(ta->args.def.inline_parm & (1 << ix))
+		return ta->args.def.buffer[ix];
+	return ta->args.def.parm[ix];
+}
+
+/// @brief Double the typeahead ring.
+static void ta_grow(H3270 *hSession) {
+
+	unsigned int size = hSession->ta.size ? (hSession->ta.size * 2) : TA_RING_INITIAL;
+
+	hSession->ta.ring = lib3270_realloc(hSession->ta.ring, size * sizeof(struct ta));
+
+	// Move the entries wrapped to the beginning of the old ring after its end.
+	if(hSession->ta.head + hSession->ta.count > hSession->ta.size) {
+		memcpy(
+			hSession->ta.ring + hSession->ta.size,
+			hSession->ta.ring,
+			(hSession->ta.head + hSession->ta.count - hSession->ta.size) * sizeof(struct ta)
+		);
+	}
+
+	hSession->ta.size = size;
+
+}
+
 /**
  * @brief Create a new typeahead action.
  *
- * Check for typeahead availability and create a new TA structure.
+ * Check for typeahead availability and get a new entry on the typeahead ring.
  *
- * @return new typeahead struct or NULL if it's not available.
+ * @return new typeahead entry or NULL if it's not available; the entry is valid until the next queue change.
  */
 struct ta * new_ta(H3270 *hSession, enum _ta_type type) {
 	struct ta *ta;
@@ -160,18 +215,38 @@ struct ta * new_ta(H3270 *hSession, enum _ta_type type) {
 		return NULL;
 	}
 
-	ta = (struct ta *) lib3270_malloc(sizeof(*ta));
-	ta->next = (struct ta *) NULL;
+	// If the queue is full, apply the overflow policy.
+	if (hSession->ta.limit && hSession->ta.count >= hSession->ta.limit) {
+
+		stats_add(hSession->stats.counters.typeahead_dropped,1);
+
+		if(hSession->ta.overflow != LIB3270_TYPEAHEAD_DROP_OLDEST) {
+			lib3270_ring_bell(hSession);
+			lib3270_write_event_trace(hSession,"typeahead action dropped (queue full)\n");
+			return NULL;
+		}
+
+		lib3270_write_event_trace(hSession,"oldest typeahead action dropped (queue full)\n");
+		ta_release(hSession->ta.ring + hSession->ta.head);
+		hSession->ta.head = (hSession->ta.head + 1) & (hSession->ta.size - 1);
+		hSession->ta.count--;
+		stats_add(hSession->stats.counters.typeahead,-1);
+
+	}
+
+	if(hSession->ta.count == hSession->ta.size)
+		ta_grow(hSession);
+
+	ta = hSession->ta.ring + ((hSession->ta.head + hSession->ta.count) & (hSession->ta.size - 1));
+	memset(ta,0,sizeof(*ta));
 	ta->type = type;
 
-	if(hSession->ta_head) {
-		hSession->ta_tail->next = ta;
-	} else {
-		hSession->ta_head = ta;
+	if(!hSession->ta.count++)
 		status_typeahead(hSession,True);
-	}
 
-	hSession->ta_tail = ta;
+	stats_add(hSession->stats.counters.typeahead,1);
+	if(hSession->stats.counters.typeahead > hSession->stats.counters.typeahead_max)
+		stats_set(hSession->stats.counters.typeahead_max,hSession->stats.counters.typeahead);
 
 	return ta;
 }
@@ -206,12 +281,8 @@ void enq_ta(H3270 *hSession, void (*fn)(H3270 *, const char *, const char *), co
 
 	ta->args.def.fn	= fn;
 
-	if (parm1)
-		ta->args.def.parm[0] = NewString(parm1);
-
-	if (parm2)
-		ta->args.def.parm[1] = NewString(parm2);
-
+	ta_set_parm(ta,0,parm1);
+	ta_set_parm(ta,1,parm2);
 
 	lib3270_write_event_trace(hSession,"typeahead action queued (kybdlock 0x%x)\n", hSession->kybdlock);
 }
@@ -231,42 +302,43 @@ void enq_action(H3270 *hSession, int (*fn)(H3270 *)) {
  * @brief Execute an action from the typeahead queue.
  */
 int run_ta(H3270 *hSession) {
-	struct ta *ta;
+	struct ta ta;
 
-	if (hSession->kybdlock || (ta = hSession->ta_head) == (struct ta *)NULL)
+	if (hSession->kybdlock || !hSession->ta.count)
 		return 0;
 
-	if ((hSession->ta_head = ta->next) == (struct ta *)NULL) {
-		hSession->ta_tail = (struct ta *)NULL;
+	// Work on a copy, the action can queue new entries and move the ring.
+	ta = hSession->ta.ring[hSession->ta.head];
+	hSession->ta.head = (hSession->ta.head + 1) & (hSession->ta.size - 1);
+
+	if (!--hSession->ta.count)
 		status_typeahead(hSession,False);
-	}
 
-	switch(ta->type) {
+	stats_add(hSession->stats.counters.typeahead,-1);
+
+	switch(ta.type) {
 	case TA_TYPE_DEFAULT:
-		ta->args.def.fn(hSession,ta->args.def.parm[0],ta->args.def.parm[1]);
-		lib3270_free(ta->args.def.parm[0]);
-		lib3270_free(ta->args.def.parm[1]);
+		ta.args.def.fn(hSession,ta_get_parm(&ta,0),ta_get_parm(&ta,1));
+		ta_release(&ta);
 		break;
 
 	case TA_TYPE_CURSOR_MOVE:
-		ta->args.move.fn(hSession,ta->args.move.direction,ta->args.move.sel);
+		ta.args.move.fn(hSession,ta.args.move.direction,ta.args.move.sel);
 		break;
 
 	case TA_TYPE_ACTION:
-		ta->args.action(hSession);
+		ta.args.action(hSession);
 		break;
 
 	case TA_TYPE_KEY_AID:
-		key_AID(hSession,ta->args.aid_code);
+		key_AID(hSession,ta.args.aid_code);
 		break;
 
 	default:
-		popup_an_error(hSession, _( "Unexpected type %d in typeahead queue" ), ta->type);
+		popup_an_error(hSession, _( "Unexpected type %d in typeahead queue" ), ta.type);
 
 	}
 
-	lib3270_free(ta);
-
 	return 1;
 }
 
@@ -275,20 +347,15 @@ int run_ta(H3270 *hSession) {
  * @return whether or not anything was flushed.
  */
 static int flush_ta(H3270 *hSession) {
-	struct ta *ta, *next;
-	int any = 0;
+	unsigned int ix;
+	int any = (int) hSession->ta.count;
 
-	for (ta = hSession->ta_head; ta != (struct ta *) NULL; ta = next) {
-		if(ta->type == TA_TYPE_DEFAULT) {
-			lib3270_free(ta->args.def.parm[0]);
-			lib3270_free(ta->args.def.parm[1]);
-		}
-		next = ta->next;
-		lib3270_free(ta);
-		any++;
-	}
-	hSession->ta_head = hSession->ta_tail = (struct ta *) NULL;
+	for (ix = 0; ix < hSession->ta.count; ix++)
+		ta_release(hSession->ta.ring + ((hSession->ta.head + ix) & (hSession->ta.size - 1)));
+
+	hSession->ta.head = hSession->ta.count = 0;
 	status_typeahead(hSession,False);
+	stats_set(hSession->stats.counters.typeahead,0);
 	return any;
 }
 
@@ -331,6 +398,14 @@ void lib3270_kybdlock_clear(H3270 *hSession, LIB3270_KEYBOARD_LOCK_STATE bits) {
 		}
 		hSession->kybdlock = n;
 		status_changed(hSession,LIB3270_MESSAGE_KYBDLOCK);
+
+		if(!n && span_active(hSession)) {
+			// Keyboard unlocked, the host has answered the last AID.
+			span_end(hSession);
+		}
+
+		if(!n)
+			lib3270_macro_wakeup(hSession);
 	}
 }
 
@@ -368,6 +443,7 @@ void kybd_connect(H3270 *session, int connected, void GNUC_UNUSED(*dunno)) {
 	} else {
 		kybdlock_set(session,KL_NOT_CONNECTED);
 		(void) flush_ta(session);
+		span_abort(session);
 	}
 }
 
@@ -459,6 +535,7 @@ static void key_AID(H3270 *hSession, unsigned char aid_code) {
 		mcursor_set(hSession,LIB3270_POINTER_WAITING);
 		lib3270_set_toggle(hSession,LIB3270_TOGGLE_INSERT,0);
 		kybdlock_set(hSession,KL_OIA_TWAIT | KL_OIA_LOCKED);
+		span_begin(hSession,aid_code);
 	}
 
 	hSession->aid = aid_code;
@@ -626,6 +703,47 @@ static void key_Character_wrapper(H3270 *hSession, const char *param1, const cha
 	(void) key_Character(hSession, code, with_ge, pasting, NULL);
 }
 
+/**
+ * @brief Replace the nulls before a typed character with blanks.
+ *
+ * @param faddr	Field attribute address.
+ * @param baddr	Address after the typed character.
+ *
+ */
+void kybd_blank_fill(H3270 *hSession, int faddr, int baddr) {
+	register int	baddr_fill = baddr;
+
+	DEC_BA(baddr_fill);
+	while (baddr_fill != faddr) {
+
+		/* Check for backward line wrap. */
+		if ((baddr_fill % hSession->view.cols) == hSession->view.cols - 1) {
+			Boolean aborted = True;
+			register int baddr_scan = baddr_fill;
+
+			/*
+			 * Check the field within the preceeding line
+			 * for NULLs.
+			 */
+			while (baddr_scan != faddr) {
+				if (hSession->ea_buf[baddr_scan].cc != EBC_null) {
+					aborted = False;
+					break;
+				}
+				if (!(baddr_scan % hSession->view.cols))
+					break;
+				DEC_BA(baddr_scan);
+			}
+			if (aborted)
+				break;
+		}
+
+		if (hSession->ea_buf[baddr_fill].cc == EBC_null)
+			ctlr_add(hSession,baddr_fill, EBC_space, 0);
+		DEC_BA(baddr_fill);
+	}
+}
+
 /**
  * @brief Handle an ordinary displayable character key.
  *
@@ -801,39 +919,8 @@ static Boolean key_Character(H3270 *hSession, int code, Boolean with_ge, Boolean
 	INC_BA(baddr);
 
 	/* Replace leading nulls with blanks, if desired. */
-	if (hSession->formatted && lib3270_get_toggle(hSession,LIB3270_TOGGLE_BLANK_FILL)) {
-		register int	baddr_fill = baddr;
-
-		DEC_BA(baddr_fill);
-		while (baddr_fill != faddr) {
-
-			/* Check for backward line wrap. */
-			if ((baddr_fill % hSession->view.cols) == hSession->view.cols - 1) {
-				Boolean aborted = True;
-				register int baddr_scan = baddr_fill;
-
-				/*
-				 * Check the field within the preceeding line
-				 * for NULLs.
-				 */
-				while (baddr_scan != faddr) {
-					if (hSession->ea_buf[baddr_scan].cc != EBC_null) {
-						aborted = False;
-						break;
-					}
-					if (!(baddr_scan % hSession->view.cols))
-						break;
-					DEC_BA(baddr_scan);
-				}
-				if (aborted)
-					break;
-			}
-
-			if (hSession->ea_buf[baddr_fill].cc == EBC_null)
-				ctlr_add(hSession,baddr_fill, EBC_space, 0);
-			DEC_BA(baddr_fill);
-		}
-	}
+	if (hSession->formatted && lib3270_get_toggle(hSession,LIB3270_TOGGLE_BLANK_FILL))
+		kybd_blank_fill(hSession, faddr, baddr);
 
 	mdt_set(hSession,hSession->cursor_addr);
 
@@ -974,8 +1061,10 @@ void do_reset(H3270 *hSession, Boolean explicit) {
 	if (explicit || lib3270_get_ft_state(hSession) != LIB3270_FT_STATE_NONE || (!hSession->unlock_delay) || (hSession->unlock_delay_time != 0 && (time(NULL) - hSession->unlock_delay_time) > 1)) {
 		lib3270_kybdlock_clear(hSession,-1);
 	} else if (hSession->kybdlock & (KL_DEFERRED_UNLOCK | KL_OIA_TWAIT | KL_OIA_LOCKED | KL_AWAITING_FIRST)) {
-		lib3270_kybdlock_clear(hSession,~KL_DEFERRED_UNLOCK);
+		// Set the deferred unlock first, the keyboard is never seen unlocked before the delay.
+		span_host_unlock(hSession);
 		kybdlock_set(hSession,KL_DEFERRED_UNLOCK);
+		lib3270_kybdlock_clear(hSession,~KL_DEFERRED_UNLOCK);
 
 		if(hSession->unlock_delay_ms) {
 			hSession->unlock_id = AddTimer(hSession->unlock_delay_ms, hSession, defer_unlock, NULL);
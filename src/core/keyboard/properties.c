@@ -30,6 +30,7 @@
 #include <internals.h>
 #include <lib3270/keyboard.h>
 #include <lib3270/properties.h>
+#include <errno.h>
 
 LIB3270_EXPORT LIB3270_KEYBOARD_LOCK_STATE lib3270_get_keyboard_lock_state(const H3270 *hSession) {
 	if(check_online_session(hSession))
@@ -66,3 +67,25 @@ LIB3270_EXPORT unsigned int lib3270_get_unlock_delay(const H3270 *hSession) {
 	return (unsigned int) hSession->unlock_delay_ms;
 }
 
+
+LIB3270_EXPORT int lib3270_set_typeahead_limit(H3270 *hSession, unsigned int entries) {
+	hSession->ta.limit = entries;
+	return 0;
+}
+
+LIB3270_EXPORT unsigned int lib3270_get_typeahead_limit(const H3270 *hSession) {
+	return hSession->ta.limit;
+}
+
+LIB3270_EXPORT int lib3270_set_typeahead_overflow(H3270 *hSession, LIB3270_TYPEAHEAD_OVERFLOW policy) {
+
+	if(policy != LIB3270_TYPEAHEAD_DROP_NEW && policy != LIB3270_TYPEAHEAD_DROP_OLDEST)
+		return EINVAL;
+
+	hSession->ta.overflow = (unsigned char) policy;
+	return 0;
+}
+
+LIB3270_EXPORT LIB3270_TYPEAHEAD_OVERFLOW lib3270_get_typeahead_overflow(const H3270 *hSession) {
+	return (LIB3270_TYPEAHEAD_OVERFLOW) hSession->ta.overflow;
+}
@@ -44,57 +44,229 @@
 #include <lib3270.h>
 #include <lib3270/log.h>
 #include <errno.h>
+#include <pthread.h>
+#include <trace_dsc.h>
+#include "utilc.h"
 
 /*---[ Constants ]------------------------------------------------------------------------------------------*/
 
+/// @brief Size of the stack buffer used to format log messages.
+#define LOG_BUFFER_SIZE	1024
+
 static LIB3270_LOG_HANDLER loghandler = default_loghandler;
 static void *loguserdata = NULL;
 
+/// @brief Protects the rate limiter tables and the timestamp cache.
+static pthread_mutex_t logmutex = PTHREAD_MUTEX_INITIALIZER;
+
+/// @brief Suppressed messages to report.
+struct summary {
+	char module[32];
+	unsigned int suppressed;
+};
+
 /*---[ Implementacao ]--------------------------------------------------------------------------------------*/
 
-static void write_log(const H3270 *session, const char *module, int rc, const char *fmt, va_list args) {
+/// @brief Get the log timestamp, strftime() runs only once per second (called with the lock).
+static const char * get_timestamp(time_t ltime) {
+
+	static time_t	  last		= 0;
+	static char		  timestamp[80];
+
+	if(ltime != last) {
+#ifdef HAVE_LOCALTIME_R
+		struct tm tm;
+		strftime(timestamp, 79, "%x %X", localtime_r(&ltime,&tm));
+#else
+		strftime(timestamp, 79, "%x %X", localtime(&ltime));
+#endif // HAVE_LOCALTIME_R
+		last = ltime;
+	}
+
+	return timestamp;
+}
+
+static TRACE_WRITER * get_writer(const H3270 *session) {
+
+	if(!session->log.writer) {
+
+		H3270 *hSession = (H3270 *) session;
+
+		hSession->log.writer = trace_writer_new(session->log.file,session->log.max_size,NULL,0);
+		trace_writer_set_interval(hSession->log.writer,session->log.interval);
+
+	}
+
+	return session->log.writer;
+}
+
+int log_write_text(const H3270 *session, const char *text, size_t length) {
+
+	if(!session->log.file)
+		return -1;
+
+	trace_writer_write(get_writer(session),text,length);
+	return 0;
+
+}
+
+static void log_message(const H3270 *session, const char *module, int rc, const char *message, time_t ltime) {
+
+	if(session->log.file) {
+
+		// Has log file, send the line to the buffered writer.
+		char	  timestamp[80];
+		char	  buffer[LOG_BUFFER_SIZE];
+		int		  length;
+
+		pthread_mutex_lock(&logmutex);
+		strcpy(timestamp,get_timestamp(ltime));
+		pthread_mutex_unlock(&logmutex);
+
+		length = snprintf(buffer,LOG_BUFFER_SIZE,"%s %s\t%s\n",timestamp,module,message);
+
+		if(length >= 0 && length < LOG_BUFFER_SIZE) {
+			log_write_text(session,buffer,length);
+		} else if(length > 0) {
+			char *line = lib3270_strdup_printf("%s %s\t%s\n",timestamp,module,message);
+			log_write_text(session,line,strlen(line));
+			lib3270_free(line);
+		}
+
+	}
+
+	session->log.handler(session,session->log.userdata,module,rc,message);
+
+}
+
+/**
+ * @brief Check the per module rate limit (called with the lock).
+ *
+ * Every module can log up to log.rate_limit messages per second, the remaining ones are dropped
+ * and counted; the count is reported on the first check after the second ends.
+ *
+ * @param summaries	Receives the suppression counts to report (LOG_RATE_MODULES entries).
+ * @param pending	Receives the number of summaries.
+ *
+ * @return Non zero if the message should be logged.
+ */
+static int rate_limit_check(H3270 *session, const char *module, time_t ltime, struct summary *summaries, size_t *pending) {
+
+	size_t	  ix;
+	size_t	  slot = LOG_RATE_MODULES;
+	size_t	  oldest = 0;
+
+	*pending = 0;
+
+	for(ix = 0; ix < LOG_RATE_MODULES; ix++) {
+
+		if(session->log.limits[ix].module[0] && !strncmp(session->log.limits[ix].module,module,sizeof(session->log.limits[ix].module)-1)) {
+			slot = ix;
+		} else if(session->log.limits[ix].suppressed && session->log.limits[ix].window != ltime) {
+			// Other module ended a flood, report it.
+			strcpy(summaries[*pending].module,session->log.limits[ix].module);
+			summaries[(*pending)++].suppressed = session->log.limits[ix].suppressed;
+			session->log.limits[ix].suppressed = 0;
+		}
+
+		if(session->log.limits[ix].window < session->log.limits[oldest].window)
+			oldest = ix;
+
+	}
+
+	if(slot == LOG_RATE_MODULES) {
+
+		// New module, reuse the least recently used slot.
+		slot = oldest;
+
+		if(session->log.limits[slot].suppressed) {
+			strcpy(summaries[*pending].module,session->log.limits[slot].module);
+			summaries[(*pending)++].suppressed = session->log.limits[slot].suppressed;
+		}
+
+		memset(&session->log.limits[slot],0,sizeof(session->log.limits[slot]));
+		strncpy(session->log.limits[slot].module,module,sizeof(session->log.limits[slot].module)-1);
+
+	}
+
+	if(session->log.limits[slot].window != ltime) {
 
-	// 'mount' message.
-	char *message = lib3270_vsprintf(fmt,args);
+		if(session->log.limits[slot].suppressed) {
+			strcpy(summaries[*pending].module,session->log.limits[slot].module);
+			summaries[(*pending)++].suppressed = session->log.limits[slot].suppressed;
+			session->log.limits[slot].suppressed = 0;
+		}
+
+		session->log.limits[slot].window = ltime;
+		session->log.limits[slot].count = 0;
+
+	}
+
+	if(++session->log.limits[slot].count > session->log.rate_limit) {
+		session->log.limits[slot].suppressed++;
+		return 0;
+	}
+
+	return 1;
+
+}
+
+static void report_suppressed(const H3270 *session, const struct summary *summaries, size_t pending, time_t ltime) {
+
+	size_t ix;
+
+	for(ix = 0; ix < pending; ix++) {
+		char message[80];
+		snprintf(message,sizeof(message),_( "%u messages suppressed by the log rate limit" ),summaries[ix].suppressed);
+		log_message(session,summaries[ix].module,0,message,ltime);
+	}
+
+}
+
+static void write_log(const H3270 *session, const char *module, int rc, const char *fmt, va_list args) {
 
 	// Write log
 	if(session) {
 
-		if(session->log.file) {
+		char	  buffer[LOG_BUFFER_SIZE];
+		char	* message;
+		time_t	  ltime = time(0);
 
-			// Has log file. Use it if possible.
-			FILE *f = fopen(session->log.file, "a");
+		if(session->log.rate_limit) {
 
-			if(f) {
+			struct summary	summaries[LOG_RATE_MODULES];
+			size_t			pending;
+			int				allowed;
 
-				time_t ltime = time(0);
+			pthread_mutex_lock(&logmutex);
+			allowed = rate_limit_check((H3270 *) session,module,ltime,summaries,&pending);
+			pthread_mutex_unlock(&logmutex);
 
-			   char timestamp[80];
-		#ifdef HAVE_LOCALTIME_R
-				struct tm tm;
-				strftime(timestamp, 79, "%x %X", localtime_r(&ltime,&tm));
-		#else
-				strftime(timestamp, 79, "%x %X", localtime(&ltime));
-		#endif // HAVE_LOCALTIME_R
+			report_suppressed(session,summaries,pending,ltime);
 
-				fprintf(f,"%s %s\t%s\n",timestamp,module,message);
+			if(!allowed)
+				return;
 
-				fclose(f);
+		}
 
-			}
+		// 'mount' message.
+		message = lib3270_format_buffer(buffer,LOG_BUFFER_SIZE,fmt,args);
+		if(!message)
+			return;
 
-		}
+		log_message(session,module,rc,message,ltime);
 
-		session->log.handler(session,session->log.userdata,module ? module : LIB3270_STRINGIZE_VALUE_OF(PRODUCT_NAME),rc,message);
+		if(message != buffer)
+			lib3270_free(message);
 
 	} else {
 
-		loghandler(session, loguserdata, (module ? module : LIB3270_STRINGIZE_VALUE_OF(PRODUCT_NAME)),rc,message);
+		char *message = lib3270_vsprintf(fmt,args);
+		loghandler(session, loguserdata, module, rc, message);
+		lib3270_free(message);
 
 	}
 
-	lib3270_free(message);
-
 }
 
 LIB3270_EXPORT const char * lib3270_get_log_filename(const H3270 * hSession) {
@@ -107,6 +279,11 @@ LIB3270_EXPORT int lib3270_set_log_filename(H3270 * hSession, const char *filena
 		return EINVAL;
 	}
 
+	if(hSession->log.writer) {
+		trace_writer_free(hSession->log.writer);
+		hSession->log.writer = NULL;
+	}
+
 	if(hSession->log.file) {
 		lib3270_free(hSession->log.file);
 	}
@@ -121,6 +298,72 @@ LIB3270_EXPORT int lib3270_set_log_filename(H3270 * hSession, const char *filena
 
 }
 
+LIB3270_EXPORT void lib3270_flush_log(H3270 *hSession) {
+
+	if(hSession->log.rate_limit) {
+
+		// Report pending suppression counts.
+		struct summary	summaries[LOG_RATE_MODULES];
+		size_t			pending = 0;
+		size_t			ix;
+		time_t			ltime = time(0);
+
+		pthread_mutex_lock(&logmutex);
+		for(ix = 0; ix < LOG_RATE_MODULES; ix++) {
+			if(hSession->log.limits[ix].suppressed) {
+				strcpy(summaries[pending].module,hSession->log.limits[ix].module);
+				summaries[pending++].suppressed = hSession->log.limits[ix].suppressed;
+				hSession->log.limits[ix].suppressed = 0;
+			}
+		}
+		pthread_mutex_unlock(&logmutex);
+
+		report_suppressed(hSession,summaries,pending,ltime);
+
+	}
+
+	if(hSession->log.writer)
+		trace_writer_flush(hSession->log.writer);
+
+}
+
+LIB3270_EXPORT unsigned int lib3270_get_log_max_size(const H3270 *hSession) {
+	return (unsigned int) (hSession->log.max_size / 1024);
+}
+
+LIB3270_EXPORT int lib3270_set_log_max_size(H3270 *hSession, unsigned int kbytes) {
+
+	hSession->log.max_size = ((size_t) kbytes) * 1024;
+
+	if(hSession->log.writer)
+		trace_writer_set_max_size(hSession->log.writer,hSession->log.max_size);
+
+	return 0;
+}
+
+LIB3270_EXPORT unsigned int lib3270_get_log_rotate_interval(const H3270 *hSession) {
+	return hSession->log.interval;
+}
+
+LIB3270_EXPORT int lib3270_set_log_rotate_interval(H3270 *hSession, unsigned int seconds) {
+
+	hSession->log.interval = seconds;
+
+	if(hSession->log.writer)
+		trace_writer_set_interval(hSession->log.writer,seconds);
+
+	return 0;
+}
+
+LIB3270_EXPORT unsigned int lib3270_get_log_rate_limit(const H3270 *hSession) {
+	return hSession->log.rate_limit;
+}
+
+LIB3270_EXPORT int lib3270_set_log_rate_limit(H3270 *hSession, unsigned int messages) {
+	hSession->log.rate_limit = messages;
+	return 0;
+}
+
 LIB3270_EXPORT void lib3270_set_log_handler(H3270 *session, const LIB3270_LOG_HANDLER handler, void *userdata) {
 
 	if(session) {
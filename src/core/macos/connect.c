@@ -346,6 +346,8 @@ int net_reconnect(H3270 *hSession, int seconds) {
 		trace_dsn(hSession,"Network keep-alive is %s\n",optval ? "enabled" : "disabled" );
 	}
 
+	lib3270_network_apply_profile(hSession);
+
 
 	/*
 	#if defined(OMTU)
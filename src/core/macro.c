@@ -0,0 +1,707 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como macro.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Compiled macros.
+ *
+ * The script is compiled into an array of steps with the actions and labels already
+ * resolved; the run state is kept on the session, so a macro waiting for the host
+ * costs nothing until the data stream or the keyboard lock changes.
+ *
+ */
+
+#include <config.h>
+#include <internals.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <lib3270.h>
+#include <lib3270/actions.h>
+#include <lib3270/properties.h>
+#include <lib3270/macro.h>
+#include <lib3270/trace.h>
+#include "kybdc.h"
+#include "utilc.h"
+
+/// @brief Maximum number of steps executed without waiting for the host.
+#define MACRO_MAX_STEPS		65536
+
+/// @brief Delay to resume a macro (ms), AddTimer() turns a zero interval into 100ms.
+#define MACRO_WAKEUP		1
+
+typedef enum _macro_op {
+	MACRO_ACTION,			///< @brief Activate action.
+	MACRO_FIELD,			///< @brief Set field contents.
+	MACRO_WAIT,				///< @brief Wait for ready.
+	MACRO_WAIT_STRING,		///< @brief Wait for string at row/col.
+	MACRO_IF_STRING,		///< @brief Jump if string at row/col.
+	MACRO_GOTO,				///< @brief Jump.
+	MACRO_EXIT				///< @brief End macro.
+} MACRO_OP;
+
+typedef struct _macro_step {
+	MACRO_OP				  op;
+	unsigned short			  row;
+	unsigned short			  col;
+	int						  seconds;		///< @brief Wait timeout (-1 to use the default one).
+	int						  value;		///< @brief Jump target or exit code.
+	const LIB3270_ACTION	* action;
+	char					* text;
+} MACRO_STEP;
+
+struct _lib3270_macro {
+	size_t					  length;
+	MACRO_STEP				* steps;
+};
+
+/// @brief Macro running on a session.
+struct _lib3270_macro_state {
+	const LIB3270_MACRO		* macro;
+	size_t					  pc;			///< @brief Current step.
+	int						  seconds;		///< @brief Default timeout.
+	int						  exit_code;	///< @brief Code of the exit step (0 if the macro ended without one).
+	void					* timer;		///< @brief Timeout of the current wait step.
+	void					* wakeup;		///< @brief Pending resume.
+	unsigned int			  waiting	: 1;	///< @brief Current step is waiting.
+	unsigned int			  timedout	: 1;
+	unsigned int			  async		: 1;
+	LIB3270_MACRO_HANDLER	  handler;
+	void					* userdata;
+};
+
+/*---[ Compiler ]-------------------------------------------------------------------------------------------*/
+
+typedef struct _macro_label {
+	char	* name;
+	size_t	  step;		///< @brief Step defined by the label or jump using it.
+	unsigned int line;
+} MACRO_LABEL;
+
+typedef struct _macro_compiler {
+	LIB3270_MACRO	* macro;
+	size_t			  allocated;
+	MACRO_LABEL		* labels;
+	size_t			  nlabels;
+	MACRO_LABEL		* jumps;
+	size_t			  njumps;
+	unsigned int	  line;
+} MACRO_COMPILER;
+
+static const char * skip_spaces(const char *ptr) {
+	while(*ptr == ' ' || *ptr == '\t')
+		ptr++;
+	return ptr;
+}
+
+static int is_eol(const char *ptr) {
+	ptr = skip_spaces(ptr);
+	return *ptr == 0 || *ptr == '\n' || *ptr == '\r' || *ptr == '#';
+}
+
+/// @brief Get the next word, returns its length.
+static size_t get_word(const char **ptr, char *buffer, size_t length) {
+	const char *src = skip_spaces(*ptr);
+	size_t sz = 0;
+
+	while(*src && !isspace(*src) && *src != '#') {
+		if(sz < length-1)
+			buffer[sz] = *src;
+		sz++;
+		src++;
+	}
+
+	buffer[sz < length ? sz : length-1] = 0;
+	*ptr = src;
+
+	return sz < length ? sz : 0;
+}
+
+static int get_number(const char **ptr, int *value) {
+	const char *src = skip_spaces(*ptr);
+	char *end;
+	long v;
+
+	if(!(isdigit(*src) || (*src == '-' && isdigit(src[1]))))
+		return EINVAL;
+
+	v = strtol(src,&end,10);
+	if(v < -32768 || v > 32767)
+		return EINVAL;
+
+	*value = (int) v;
+	*ptr = end;
+	return 0;
+}
+
+/// @brief Get a quoted string (with \" and \\ escapes).
+static char * get_string(const char **ptr) {
+	const char *src = skip_spaces(*ptr);
+	char *text, *dst;
+
+	if(*src != '"')
+		return NULL;
+
+	dst = text = lib3270_malloc(strlen(src)+1);
+
+	for(src++; *src != '"'; src++) {
+		if(!*src || *src == '\n') {
+			lib3270_free(text);
+			return NULL;
+		}
+
+		if(*src == '\\' && (src[1] == '"' || src[1] == '\\'))
+			src++;
+
+		*(dst++) = *src;
+	}
+	*dst = 0;
+
+	*ptr = src+1;
+	return text;
+}
+
+static int get_position(const char **ptr, MACRO_STEP *step) {
+	int row, col;
+
+	if(get_number(ptr,&row) || get_number(ptr,&col) || row < 1 || col < 1)
+		return EINVAL;
+
+	step->row = (unsigned short) row;
+	step->col = (unsigned short) col;
+	return 0;
+}
+
+static MACRO_STEP * new_step(MACRO_COMPILER *compiler, MACRO_OP op) {
+	MACRO_STEP *step;
+
+	if(compiler->macro->length >= compiler->allocated) {
+		compiler->allocated = compiler->allocated ? compiler->allocated * 2 : 16;
+		compiler->macro->steps = lib3270_realloc(compiler->macro->steps, compiler->allocated * sizeof(MACRO_STEP));
+	}
+
+	step = compiler->macro->steps + compiler->macro->length++;
+	memset(step,0,sizeof(MACRO_STEP));
+	step->op = op;
+	step->seconds = -1;
+	return step;
+}
+
+static MACRO_LABEL * add_label(MACRO_LABEL **labels, size_t *count, const char *name, size_t step, unsigned int line) {
+	MACRO_LABEL *label;
+
+	*labels = lib3270_realloc(*labels,(*count + 1) * sizeof(MACRO_LABEL));
+	label = (*labels) + (*count)++;
+	label->name = lib3270_strdup(name);
+	label->step = step;
+	label->line = line;
+
+	return label;
+}
+
+/// @brief Compile a jump, the target is resolved after the last line.
+static int compile_jump(MACRO_COMPILER *compiler, const char **ptr) {
+	char name[64];
+
+	if(!get_word(ptr,name,sizeof(name)) || !*name)
+		return EINVAL;
+
+	add_label(&compiler->jumps,&compiler->njumps,name,compiler->macro->length-1,compiler->line);
+	return 0;
+}
+
+static int compile_line(MACRO_COMPILER *compiler, const char *ptr) {
+	char keyword[64];
+	size_t sz;
+	MACRO_STEP *step;
+
+	if(is_eol(ptr))
+		return 0;
+
+	sz = get_word(&ptr,keyword,sizeof(keyword));
+	if(!sz)
+		return EINVAL;
+
+	if(keyword[sz-1] == ':') {
+		size_t f;
+
+		keyword[sz-1] = 0;
+		if(!*keyword)
+			return EINVAL;
+
+		for(f = 0; f < compiler->nlabels; f++) {
+			if(!strcasecmp(compiler->labels[f].name,keyword))
+				return EINVAL;
+		}
+
+		add_label(&compiler->labels,&compiler->nlabels,keyword,compiler->macro->length,compiler->line);
+		return is_eol(ptr) ? 0 : EINVAL;
+	}
+
+	if(!strcasecmp(keyword,"action")) {
+		char name[64];
+		const LIB3270_RESOLVED_NAME *resolved;
+
+		if(!get_word(&ptr,name,sizeof(name)))
+			return EINVAL;
+
+		resolved = lib3270_find_name(name,LIB3270_NAME_ACTION);
+		if(!resolved)
+			return ENOENT;
+
+		new_step(compiler,MACRO_ACTION)->action = resolved->value.action;
+
+	} else if(!strcasecmp(keyword,"field")) {
+
+		step = new_step(compiler,MACRO_FIELD);
+		if(get_position(&ptr,step))
+			return EINVAL;
+
+		if(!(step->text = get_string(&ptr)))
+			return EINVAL;
+
+	} else if(!strcasecmp(keyword,"wait")) {
+
+		step = new_step(compiler,MACRO_WAIT);
+		if(!is_eol(ptr) && get_number(&ptr,&step->seconds))
+			return EINVAL;
+
+	} else if(!strcasecmp(keyword,"waitfor")) {
+
+		step = new_step(compiler,MACRO_WAIT_STRING);
+		if(get_position(&ptr,step))
+			return EINVAL;
+
+		if(!(step->text = get_string(&ptr)))
+			return EINVAL;
+
+		if(!is_eol(ptr) && get_number(&ptr,&step->seconds))
+			return EINVAL;
+
+	} else if(!strcasecmp(keyword,"if")) {
+
+		step = new_step(compiler,MACRO_IF_STRING);
+		if(get_position(&ptr,step))
+			return EINVAL;
+
+		if(!(step->text = get_string(&ptr)))
+			return EINVAL;
+
+		if(!get_word(&ptr,keyword,sizeof(keyword)) || strcasecmp(keyword,"goto"))
+			return EINVAL;
+
+		if(compile_jump(compiler,&ptr))
+			return EINVAL;
+
+	} else if(!strcasecmp(keyword,"goto")) {
+
+		step = new_step(compiler,MACRO_GOTO);
+		if(compile_jump(compiler,&ptr))
+			return EINVAL;
+
+	} else if(!strcasecmp(keyword,"exit")) {
+
+		step = new_step(compiler,MACRO_EXIT);
+		if(!is_eol(ptr) && get_number(&ptr,&step->value))
+			return EINVAL;
+
+	} else {
+		return EINVAL;
+	}
+
+	return is_eol(ptr) ? 0 : EINVAL;
+
+}
+
+static int resolve_jumps(MACRO_COMPILER *compiler) {
+	size_t j, l;
+
+	for(j = 0; j < compiler->njumps; j++) {
+
+		for(l = 0; l < compiler->nlabels && strcasecmp(compiler->labels[l].name,compiler->jumps[j].name); l++);
+
+		if(l == compiler->nlabels) {
+			compiler->line = compiler->jumps[j].line;
+			return EINVAL;
+		}
+
+		compiler->macro->steps[compiler->jumps[j].step].value = (int) compiler->labels[l].step;
+	}
+
+	return 0;
+}
+
+static void free_labels(MACRO_LABEL *labels, size_t count) {
+	size_t f;
+
+	for(f = 0; f < count; f++)
+		lib3270_free(labels[f].name);
+
+	lib3270_free(labels);
+}
+
+LIB3270_EXPORT LIB3270_MACRO * lib3270_macro_compile(const char *script, unsigned int *line) {
+	MACRO_COMPILER compiler;
+	int rc = 0;
+
+	memset(&compiler,0,sizeof(compiler));
+	compiler.macro = lib3270_malloc(sizeof(LIB3270_MACRO));
+
+	if(!script)
+		rc = EINVAL;
+
+	while(!rc && script && *script) {
+		compiler.line++;
+		rc = compile_line(&compiler,script);
+
+		script = strchr(script,'\n');
+		if(script)
+			script++;
+	}
+
+	if(!rc)
+		rc = resolve_jumps(&compiler);
+
+	free_labels(compiler.labels,compiler.nlabels);
+	free_labels(compiler.jumps,compiler.njumps);
+
+	if(line)
+		*line = rc ? compiler.line : 0;
+
+	if(rc) {
+		lib3270_macro_free(compiler.macro);
+		errno = rc;
+		return NULL;
+	}
+
+	return compiler.macro;
+
+}
+
+LIB3270_EXPORT void lib3270_macro_free(LIB3270_MACRO *macro) {
+	size_t f;
+
+	if(!macro)
+		return;
+
+	for(f = 0; f < macro->length; f++)
+		lib3270_free(macro->steps[f].text);
+
+	lib3270_free(macro->steps);
+	lib3270_free(macro);
+}
+
+LIB3270_EXPORT unsigned int lib3270_macro_get_length(const LIB3270_MACRO *macro) {
+	return macro ? (unsigned int) macro->length : 0;
+}
+
+/*---[ Runner ]---------------------------------------------------------------------------------------------*/
+
+static int timeout_expired(H3270 *hSession, void GNUC_UNUSED(*userdata)) {
+	struct _lib3270_macro_state *state = hSession->macro;
+
+	if(state) {
+		// The timer is destroyed when this call returns.
+		state->timer = NULL;
+		state->timedout = 1;
+		lib3270_macro_wakeup(hSession);
+	}
+
+	return 0;
+}
+
+/// @brief Begin or end the timeout of a wait step.
+static void set_waiting(H3270 *hSession, struct _lib3270_macro_state *state, const MACRO_STEP *step, int waiting) {
+
+	if(waiting && !state->waiting) {
+		int seconds = step->seconds >= 0 ? step->seconds : state->seconds;
+
+		state->waiting = 1;
+		state->timedout = 0;
+		if(seconds > 0)
+			state->timer = AddTimer(seconds * 1000, hSession, timeout_expired, NULL);
+
+	} else if(!waiting && state->waiting) {
+
+		state->waiting = 0;
+		state->timedout = 0;
+		if(state->timer) {
+			RemoveTimer(hSession,state->timer);
+			state->timer = NULL;
+		}
+
+	}
+
+}
+
+/// @brief Check if the session can still satisfy a wait step.
+static int check_session(H3270 *hSession) {
+
+	if(lib3270_is_disconnected(hSession))
+		return ENOTCONN;
+
+	if(hSession->kybdlock && KYBDLOCK_IS_OERR(hSession))
+		return EPERM;
+
+	return 0;
+}
+
+static int cmp_string_at(H3270 *hSession, const MACRO_STEP *step) {
+	int baddr = lib3270_translate_to_address(hSession,step->row,step->col);
+
+	if(baddr < 0)
+		return -errno;
+
+	return lib3270_cmp_string_at_address(hSession,baddr,step->text,0) == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Execute steps until the macro waits or ends.
+ *
+ * The code of an exit step is stored on state->exit_code, it isn't returned, so
+ * it can't be taken as EAGAIN or as an error.
+ *
+ * @return EAGAIN if waiting for the host, 0 if finished, error code if failed.
+ *
+ */
+static int macro_execute(H3270 *hSession, struct _lib3270_macro_state *state) {
+	const LIB3270_MACRO *macro = state->macro;
+	unsigned int steps = 0;
+	int rc;
+
+	while(state->pc < macro->length) {
+		const MACRO_STEP *step = macro->steps + state->pc;
+
+		if(++steps > MACRO_MAX_STEPS)
+			return ELOOP;
+
+		switch(step->op) {
+		case MACRO_ACTION:
+			rc = lib3270_action_activate(step->action,hSession);
+			if(rc)
+				return rc;
+			state->pc++;
+			break;
+
+		case MACRO_FIELD: {
+			LIB3270_FIELD_VALUE value = { lib3270_translate_to_address(hSession,step->row,step->col), 0, step->text, -1 };
+
+			if(value.baddr < 0)
+				return errno;
+
+			rc = lib3270_set_fields(hSession,&value,1);
+			if(rc)
+				return -rc;
+
+			state->pc++;
+		}
+		break;
+
+		case MACRO_WAIT:
+			if(lib3270_get_lock_status(hSession) != LIB3270_MESSAGE_NONE) {
+
+				if((rc = check_session(hSession)) != 0)
+					return rc;
+
+				if(state->timedout)
+					return ETIMEDOUT;
+
+				set_waiting(hSession,state,step,1);
+				return EAGAIN;
+			}
+
+			set_waiting(hSession,state,step,0);
+			state->pc++;
+			break;
+
+		case MACRO_WAIT_STRING:
+			if((rc = check_session(hSession)) != 0)
+				return rc;
+
+			rc = cmp_string_at(hSession,step);
+			if(rc < 0)
+				return -rc;
+
+			if(rc) {
+				if(state->timedout)
+					return ETIMEDOUT;
+
+				set_waiting(hSession,state,step,1);
+				return EAGAIN;
+			}
+
+			set_waiting(hSession,state,step,0);
+			state->pc++;
+			break;
+
+		case MACRO_IF_STRING:
+			rc = cmp_string_at(hSession,step);
+			if(rc < 0)
+				return -rc;
+
+			state->pc = rc ? state->pc+1 : (size_t) step->value;
+			break;
+
+		case MACRO_GOTO:
+			state->pc = (size_t) step->value;
+			break;
+
+		case MACRO_EXIT:
+			state->exit_code = step->value;
+			state->pc = macro->length;
+			return 0;
+
+		}
+
+	}
+
+	return 0;
+
+}
+
+static struct _lib3270_macro_state * macro_begin(H3270 *hSession, const LIB3270_MACRO *macro, int seconds) {
+	struct _lib3270_macro_state *state = lib3270_malloc(sizeof(struct _lib3270_macro_state));
+
+	state->macro = macro;
+	state->seconds = seconds;
+	hSession->macro = state;
+
+	return state;
+}
+
+/// @brief Release the run state and call the completion handler.
+static void macro_end(H3270 *hSession, int rc) {
+	struct _lib3270_macro_state *state = hSession->macro;
+	LIB3270_MACRO_HANDLER handler = state->handler;
+	void *userdata = state->userdata;
+	int exit_code = state->exit_code;
+
+	if(state->timer)
+		RemoveTimer(hSession,state->timer);
+
+	if(state->wakeup)
+		RemoveTimer(hSession,state->wakeup);
+
+	lib3270_write_event_trace(hSession,"Macro finished on step %u with rc=%d and exit code %d\n",(unsigned int) state->pc,rc,exit_code);
+
+	hSession->macro = NULL;
+	lib3270_free(state);
+
+	if(handler)
+		handler(hSession,rc,exit_code,userdata);
+
+}
+
+static int macro_resume(H3270 *hSession, void GNUC_UNUSED(*userdata)) {
+	struct _lib3270_macro_state *state = hSession->macro;
+	int rc;
+
+	if(!state)
+		return 0;
+
+	// The timer is destroyed when this call returns.
+	state->wakeup = NULL;
+
+	rc = macro_execute(hSession,state);
+	if(rc != EAGAIN)
+		macro_end(hSession,rc);
+
+	return 0;
+}
+
+void lib3270_macro_wakeup(H3270 *hSession) {
+	struct _lib3270_macro_state *state = hSession->macro;
+
+	// Synchronous macros are checked on every iteration of lib3270_macro_run.
+	if(state && state->async && !state->wakeup)
+		state->wakeup = AddTimer(MACRO_WAKEUP, hSession, macro_resume, NULL);
+
+}
+
+LIB3270_EXPORT int lib3270_macro_run(H3270 *hSession, const LIB3270_MACRO *macro, int seconds, int *exit_code) {
+	struct _lib3270_macro_state *state;
+	int rc;
+
+	if(exit_code)
+		*exit_code = 0;
+
+	if(!macro)
+		return errno = EINVAL;
+
+	if(hSession->macro)
+		return errno = EBUSY;
+
+	state = macro_begin(hSession,macro,seconds);
+
+	while((rc = macro_execute(hSession,state)) == EAGAIN)
+		lib3270_main_iterate(hSession,1);
+
+	if(exit_code)
+		*exit_code = state->exit_code;
+
+	macro_end(hSession,rc);
+
+	return rc;
+}
+
+LIB3270_EXPORT int lib3270_macro_start(H3270 *hSession, const LIB3270_MACRO *macro, int seconds, LIB3270_MACRO_HANDLER handler, void *userdata) {
+	struct _lib3270_macro_state *state;
+
+	if(!macro)
+		return errno = EINVAL;
+
+	if(hSession->macro)
+		return errno = EBUSY;
+
+	state = macro_begin(hSession,macro,seconds);
+	state->async = 1;
+	state->handler = handler;
+	state->userdata = userdata;
+
+	// Run the first steps from the event loop, the caller can still be holding the session.
+	lib3270_macro_wakeup(hSession);
+
+	return 0;
+}
+
+LIB3270_EXPORT int lib3270_macro_cancel(H3270 *hSession) {
+
+	if(!hSession->macro)
+		return errno = ENOENT;
+
+	if(!hSession->macro->async)
+		return errno = EBUSY;
+
+	macro_end(hSession,ECANCELED);
+	return 0;
+
+}
+
+LIB3270_EXPORT int lib3270_macro_is_running(const H3270 *hSession) {
+	return hSession->macro != NULL;
+}
@@ -113,6 +113,8 @@ LIB3270_EXPORT int lib3270_set_color_type(H3270 *hSession, unsigned int colortyp
 		return errno = EINVAL;
 	}
 
+	query_reply_reset(hSession);
+
 	return 0;
 }
 
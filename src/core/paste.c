@@ -57,6 +57,7 @@
 #include "popupsc.h"
 // #include "printc.h"
 #include "screenc.h"
+#include "screen.h"
 
 /*
 #if defined(X3270_DISPLAY)
@@ -152,6 +153,163 @@ static int paste_char(H3270 *hSession, PASTE_DATA *data, unsigned char c) {
 	return c;
 }
 
+/**
+ * @brief Get the field attribute address of every screen position in a single pass.
+ *
+ * @return Array with the attribute address of each position (lib3270_free() it).
+ *
+ */
+static int * get_field_map(H3270 *hSession) {
+	int		  length	= (int) (hSession->view.rows * hSession->view.cols);
+	int		* map		= lib3270_malloc(sizeof(int) * length);
+	int		  faddr		= length - 1;
+	int		  baddr;
+
+	// The first positions belong to the last field on the screen.
+	while(faddr > 0 && !hSession->ea_buf[faddr].fa)
+		faddr--;
+
+	for(baddr = 0; baddr < length; baddr++) {
+		if(hSession->ea_buf[baddr].fa)
+			faddr = baddr;
+		map[baddr] = faddr;
+	}
+
+	return map;
+}
+
+/**
+ * @brief Paste text on the unprotected fields without the keyboard path.
+ *
+ * Maps the text onto the field layout and writes it straight to the buffer, with the
+ * same results as typing it; blank fill and MDT are set once for each run, the
+ * cursor moves once at the end.
+ *
+ * Stops before the first character the keyboard path has to handle (errors, DBCS,
+ * insert mode, margins), set_string() goes on from there.
+ *
+ * @return Number of bytes handled.
+ *
+ */
+static int paste_fields(H3270 *hSession, PASTE_DATA *data, const unsigned char *str, int length, unsigned char *last) {
+	int		  screen	= (int) (hSession->view.rows * hSession->view.cols);
+	int		  smart		= lib3270_get_toggle(hSession,LIB3270_TOGGLE_SMART_PASTE);
+	int		  fill		= lib3270_get_toggle(hSession,LIB3270_TOGGLE_BLANK_FILL);
+	int		  baddr		= hSession->cursor_addr;
+	int		  next		= -1;		// Address after the last character written.
+	int		  modified	= -1;		// Last field with the MDT set.
+	int		* map;
+	int		  ix;
+
+	if(!(IN_3270 && hSession->formatted) || hSession->dbcs || hSession->kybdlock)
+		return 0;
+
+	if(lib3270_get_toggle(hSession,LIB3270_TOGGLE_INSERT) || lib3270_get_toggle(hSession,LIB3270_TOGGLE_MARGINED_PASTE))
+		return 0;
+
+	map = get_field_map(hSession);
+
+	for(ix = 0; ix < length && str[ix] && *last && baddr >= data->orig_addr; ix++) {
+
+		unsigned char chr = str[ix];
+
+		if(chr == '\n') {
+
+			if(*last != '\n') {
+				int faddr;
+
+				baddr = ((baddr + hSession->view.cols) % screen);		// down
+				baddr = (baddr / hSession->view.cols) * hSession->view.cols;	// 1st col
+				faddr = map[baddr];
+
+				if(!(faddr != baddr && !FA_IS_PROTECTED(hSession->ea_buf[faddr].fa)))
+					baddr = lib3270_get_next_unprotected(hSession,baddr);
+
+				data->row = BA_TO_ROW(baddr);
+			}
+
+			*last = ' ';
+
+		} else {
+
+			if(chr == '\t')
+				chr = ' ';
+
+			if(smart && FA_IS_PROTECTED(hSession->ea_buf[map[baddr]].fa)) {
+
+				if(baddr + 1 >= screen)
+					break;
+				baddr++;
+
+			} else if(chr >= ' ') {
+
+				unsigned char	code	= hSession->charset.asc2ebc[chr];
+				int				faddr	= map[baddr];
+				unsigned char	fa		= hSession->ea_buf[faddr].fa;
+
+				if(hSession->ea_buf[baddr].fa || FA_IS_PROTECTED(fa) || hSession->ea_buf[faddr].cs == CS_DBCS)
+					break;
+
+				if(hSession->numeric_lock && FA_IS_NUMERIC(fa) && !((code >= EBC_0 && code <= EBC_9) || code == EBC_minus || code == EBC_period))
+					break;
+
+				if(code == EBC_dup || hSession->ea_buf[baddr].cc == EBC_so || hSession->ea_buf[baddr].cc == EBC_si)
+					break;
+
+				ctlr_add(hSession,baddr,code,0);
+				ctlr_add_fg(hSession,baddr,0);
+				ctlr_add_gr(hSession,baddr,0);
+
+				// The nulls before the run are filled by its first character, the others find only text.
+				if(fill && baddr != next)
+					kybd_blank_fill(hSession,faddr,(baddr + 1) % screen);
+
+				if(faddr != modified) {
+					mdt_set(hSession,baddr);
+					modified = faddr;
+				}
+
+				// Auto-skip, don't land on attribute bytes.
+				INC_BA(baddr);
+				next = baddr;
+				while(hSession->ea_buf[baddr].fa) {
+					if(FA_IS_SKIP(hSession->ea_buf[baddr].fa))
+						baddr = lib3270_get_next_unprotected(hSession,baddr);
+					else
+						INC_BA(baddr);
+				}
+
+			}
+
+			if(BA_TO_ROW(baddr) != ((unsigned int) data->row)) {
+				data->row = BA_TO_ROW(baddr);
+				*last = '\n';
+			} else {
+				*last = chr;
+			}
+
+		}
+
+		data->qtd++;
+
+		if(baddr == data->orig_addr) {
+			ix++;
+			*last = 0;
+			break;
+		}
+
+	}
+
+	lib3270_free(map);
+
+	cursor_move(hSession,baddr);
+
+	if(ix)
+		lib3270_write_event_trace(hSession,"%d byte(s) pasted on the field layout\n",ix);
+
+	return ix;
+}
+
 static int set_string(H3270 *hSession, const unsigned char *str, int length) {
 	PASTE_DATA data;
 	unsigned char last = 1;
@@ -165,8 +323,12 @@ static int set_string(H3270 *hSession, const unsigned char *str, int length) {
 	if(length < 0)
 		length = (int) strlen((const char *) str);
 
+	// Most of the text goes straight to the fields, the keyboard path handles the rest.
+	ix = paste_fields(hSession,&data,str,length,&last);
+	str += ix;
+
 //	while(*str && last && !hSession->kybdlock && hSession->cursor_addr >= data.orig_addr)
-	for(ix = 0; ix < length && *str && last && !hSession->kybdlock && hSession->cursor_addr >= data.orig_addr; ix++) {
+	for(; ix < length && *str && last && !hSession->kybdlock && hSession->cursor_addr >= data.orig_addr; ix++) {
 		switch(*str) {
 		case '\t':
 			last = paste_char(hSession,&data, ' ');
@@ -328,6 +490,169 @@ LIB3270_EXPORT int lib3270_set_field(H3270 *hSession, const char *text, int leng
 }
 
 
+/**
+ * @brief Find and check a field for lib3270_set_fields().
+ *
+ * @param starts	Attribute addresses of the unprotected fields (built on first use).
+ * @param count		Number of unprotected fields.
+ *
+ * @return Field attribute address, negative if the field can't be set.
+ */
+static int check_field_value(H3270 *hSession, const LIB3270_FIELD_VALUE *field, int **starts, unsigned int *count) {
+
+	int				  faddr;
+	int				  baddr;
+	int				  length;
+	int				  ix;
+	unsigned char	  fa;
+
+	if(!field->text)
+		return -(errno = EINVAL);
+
+	if(field->baddr >= 0) {
+
+		if(field->baddr >= (int) (hSession->view.rows * hSession->view.cols))
+			return -(errno = EOVERFLOW);
+
+		faddr = lib3270_field_addr(hSession,field->baddr);
+		if(faddr < 0)
+			return faddr;
+
+	} else {
+
+		if(!*starts) {
+
+			// First field selected by index, get all the unprotected ones in a single pass.
+			*starts = lib3270_malloc(sizeof(int) * hSession->view.rows * hSession->view.cols);
+
+			for(baddr = 0; baddr < (int) (hSession->view.rows * hSession->view.cols); baddr++) {
+				if(hSession->ea_buf[baddr].fa && !FA_IS_PROTECTED(hSession->ea_buf[baddr].fa))
+					(*starts)[(*count)++] = baddr;
+			}
+
+		}
+
+		if(field->index >= *count)
+			return -(errno = ENODATA);
+
+		faddr = (*starts)[field->index];
+
+	}
+
+	fa = hSession->ea_buf[faddr].fa;
+
+	if(FA_IS_PROTECTED(fa))
+		return -(errno = EPERM);
+
+	if(hSession->ea_buf[faddr].cs == CS_DBCS)
+		return -(errno = ENOTSUP);
+
+	length = (field->length < 0 ? (int) strlen(field->text) : field->length);
+
+	if(length > lib3270_field_length(hSession,faddr))
+		return -(errno = EOVERFLOW);
+
+	for(ix = 0; ix < length; ix++) {
+
+		unsigned char chr = (unsigned char) field->text[ix];
+
+		if(chr < ' ')
+			return -(errno = EINVAL);
+
+		if(hSession->numeric_lock && FA_IS_NUMERIC(fa)) {
+			chr = hSession->charset.asc2ebc[chr];
+			if(!((chr >= EBC_0 && chr <= EBC_9) || chr == EBC_minus || chr == EBC_period))
+				return -(errno = EINVAL);
+		}
+
+	}
+
+	return faddr;
+
+}
+
+LIB3270_EXPORT int lib3270_set_fields(H3270 *hSession, const LIB3270_FIELD_VALUE *fields, unsigned int count) {
+
+	int				* starts	= NULL;
+	unsigned int	  unprotected	= 0;
+	int				* faddrs;
+	int				  first		= -1;
+	int				  last		= -1;
+	int				  rc		= 0;
+	unsigned int	  ix;
+
+	if(!(fields && count))
+		return 0;
+
+	if(check_online_session(hSession))
+		return - errno;
+
+	if(hSession->kybdlock)
+		return - (errno = EPERM);
+
+	if (!hSession->formatted)
+		return - (errno = ENOTSUP);
+
+	// Check all the fields before changing the screen.
+	faddrs = lib3270_malloc(sizeof(int) * count);
+
+	for(ix = 0; ix < count; ix++) {
+		faddrs[ix] = check_field_value(hSession,fields+ix,&starts,&unprotected);
+		if(faddrs[ix] < 0) {
+			rc = faddrs[ix];
+			break;
+		}
+	}
+
+	lib3270_free(starts);
+
+	if(rc) {
+		lib3270_free(faddrs);
+		return rc;
+	}
+
+	if(hSession->selected && !lib3270_get_toggle(hSession,LIB3270_TOGGLE_KEEP_SELECTED))
+		lib3270_unselect(hSession);
+
+	for(ix = 0; ix < count; ix++) {
+
+		const unsigned char	* text		= (const unsigned char *) fields[ix].text;
+		int					  length	= (fields[ix].length < 0 ? (int) strlen(fields[ix].text) : fields[ix].length);
+		int					  baddr		= faddrs[ix];
+
+		INC_BA(baddr);
+
+		while(!hSession->ea_buf[baddr].fa) {
+
+			ctlr_add(hSession,baddr,(length-- > 0 ? hSession->charset.asc2ebc[*(text++)] : EBC_null),0);
+			ctlr_add_fg(hSession,baddr,0);
+			ctlr_add_gr(hSession,baddr,0);
+
+			if(first < 0 || baddr < first)
+				first = baddr;
+			if(baddr > last)
+				last = baddr;
+
+			INC_BA(baddr);
+		}
+
+		mdt_set(hSession,faddrs[ix]);
+
+	}
+
+	lib3270_free(faddrs);
+
+	(void) ctlr_dbcs_postprocess(hSession);
+
+	lib3270_write_event_trace(hSession,"%u field(s) set\n",count);
+
+	if(first >= 0)
+		screen_update(hSession,first,last+1);
+
+	return 0;
+
+}
+
 LIB3270_EXPORT int lib3270_set_string(H3270 *hSession, const unsigned char *str, int length) {
 	int rc;
 
@@ -350,7 +675,35 @@ LIB3270_EXPORT int lib3270_set_string(H3270 *hSession, const unsigned char *str,
 	return rc;
 }
 
+/**
+ * @brief Paste one segment of text, warn the user if it can't.
+ *
+ * @return Number of bytes pasted or -errno.
+ *
+ */
+static int paste_segment(H3270 *hSession, const unsigned char *str, int length) {
+
+	int sz = lib3270_set_string(hSession,str,length);
+
+	if(sz < 0) {
+		// Can´t paste
+		lib3270_popup_dialog(
+		    hSession,
+		    LIB3270_NOTIFY_WARNING,
+		    _( "Action failed" ),
+		    _( "Unable to paste text" ),
+		    "%s", sz == -EPERM ? _( "Keyboard is locked" ) : _( "Unexpected error" )
+		);
+	}
+
+	return sz;
+
+}
+
 LIB3270_EXPORT int lib3270_paste_text(H3270 *hSession, const unsigned char *str) {
+	int length;
+	int sz;
+
 	if(check_online_session(hSession))
 		return -errno;
 
@@ -364,24 +717,22 @@ LIB3270_EXPORT int lib3270_paste_text(H3270 *hSession, const unsigned char *str)
 		hSession->paste_buffer = NULL;
 	}
 
-	int sz = lib3270_set_string(hSession,str,-1);
-	if(sz < 0) {
-		// Can´t paste
-		lib3270_popup_dialog(
-		    hSession,
-		    LIB3270_NOTIFY_WARNING,
-		    _( "Action failed" ),
-		    _( "Unable to paste text" ),
-		    "%s", sz == -EPERM ? _( "Keyboard is locked" ) : _( "Unexpected error" )
-		);
+	length = (int) strlen((char *) str);
 
+	sz = paste_segment(hSession,str,length);
+	if(sz < 0)
 		return sz;
-	}
 
-	if((int) strlen((char *) str) > sz) {
-		hSession->paste_buffer = strdup((char *) (str+sz));
+	if(length > sz) {
+
+		// Keep the overflow, the next screens will get it from there without copies.
+		hSession->paste_length	= length - sz;
+		hSession->paste_offset	= 0;
+		hSession->paste_buffer	= lib3270_malloc(hSession->paste_length+1);
+		memcpy(hSession->paste_buffer,str+sz,hSession->paste_length+1);
+
 		lib3270_action_group_notify(hSession, LIB3270_ACTION_GROUP_COPY);
-		return strlen(hSession->paste_buffer);
+		return hSession->paste_length;
 	}
 
 	return 0;
@@ -391,12 +742,11 @@ LIB3270_EXPORT int lib3270_can_paste_next(const H3270 *hSession) {
 	if(!(lib3270_is_connected(hSession) && hSession->paste_buffer))
 		return 0;
 
-	return strlen(hSession->paste_buffer);
+	return hSession->paste_length - hSession->paste_offset;
 }
 
 LIB3270_EXPORT int lib3270_paste_next(H3270 *hSession) {
-	char	* ptr;
-	int		  rc;
+	int sz;
 
 	FAIL_IF_NOT_ONLINE(hSession);
 
@@ -405,15 +755,23 @@ LIB3270_EXPORT int lib3270_paste_next(H3270 *hSession) {
 		return 0;
 	}
 
-	ptr = hSession->paste_buffer;
-	hSession->paste_buffer = NULL;
+	sz = paste_segment(
+			hSession,
+			(unsigned char *) hSession->paste_buffer + hSession->paste_offset,
+			hSession->paste_length - hSession->paste_offset
+		);
 
-	rc = lib3270_paste_text(hSession,(unsigned char *) ptr);
+	if(sz < 0)
+		return sz;
 
-	lib3270_free(ptr);
+	hSession->paste_offset += sz;
 
-	if(!hSession->paste_buffer)
-		lib3270_action_group_notify(hSession, LIB3270_ACTION_GROUP_COPY);
+	if(hSession->paste_offset < hSession->paste_length)
+		return hSession->paste_length - hSession->paste_offset;
 
-	return rc;
+	lib3270_free(hSession->paste_buffer);
+	hSession->paste_buffer = NULL;
+	lib3270_action_group_notify(hSession, LIB3270_ACTION_GROUP_COPY);
+
+	return 0;
 }
@@ -0,0 +1,179 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como batch.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Property batches.
+ *
+ */
+
+#include <config.h>
+#include <internals.h>
+#include <stdlib.h>
+#include <string.h>
+#include <lib3270.h>
+#include <lib3270/properties.h>
+
+/// @brief Search order for each value type, same as the lib3270_set_*_property() calls.
+static const int set_order[][5] = {
+	[LIB3270_NAME_BOOLEAN]	= { LIB3270_NAME_BOOLEAN, -1 },
+	[LIB3270_NAME_INT]		= { LIB3270_NAME_INT, LIB3270_NAME_BOOLEAN, -1 },
+	[LIB3270_NAME_UINT]		= { LIB3270_NAME_UINT, -1 },
+	[LIB3270_NAME_STRING]	= { LIB3270_NAME_STRING, LIB3270_NAME_INT, LIB3270_NAME_UINT, LIB3270_NAME_BOOLEAN, -1 },
+};
+
+/// @brief Search order for get.
+static const int get_order[] = { LIB3270_NAME_BOOLEAN, LIB3270_NAME_INT, LIB3270_NAME_UINT, LIB3270_NAME_STRING, -1 };
+
+static int resolve_item(LIB3270_PROPERTY_ITEM *item) {
+	const int *order;
+
+	if(item->resolved)
+		return 0;
+
+	if(!item->name)
+		return EINVAL;
+
+	if(item->operation == LIB3270_PROPERTY_GET) {
+		order = get_order;
+	} else if(item->operation == LIB3270_PROPERTY_SET && item->type >= LIB3270_NAME_BOOLEAN && item->type <= LIB3270_NAME_STRING) {
+		order = set_order[item->type];
+	} else {
+		return EINVAL;
+	}
+
+	for(; *order >= 0 && !item->resolved; order++)
+		item->resolved = lib3270_find_name(item->name,*order);
+
+	return item->resolved ? 0 : ENOENT;
+
+}
+
+static int get_item(H3270 *hSession, LIB3270_PROPERTY_ITEM *item) {
+	const LIB3270_RESOLVED_NAME *resolved = item->resolved;
+
+	item->type = resolved->type;
+
+	switch(resolved->type) {
+	case LIB3270_NAME_BOOLEAN:
+	case LIB3270_NAME_INT:
+		if(!resolved->value.int_property->get)
+			return EPERM;
+		errno = 0;
+		item->value.int_value = resolved->value.int_property->get(hSession);
+		return (item->value.int_value == -1 && errno) ? errno : 0;
+
+	case LIB3270_NAME_UINT:
+		if(!resolved->value.uint_property->get)
+			return EPERM;
+		item->value.uint_value = resolved->value.uint_property->get(hSession);
+		return 0;
+
+	case LIB3270_NAME_STRING:
+		if(!resolved->value.string_property->get)
+			return EPERM;
+		errno = 0;
+		item->value.string_value = resolved->value.string_property->get(hSession);
+		return (!item->value.string_value && errno) ? errno : 0;
+
+	default:
+		return EINVAL;
+	}
+
+}
+
+static int set_item(H3270 *hSession, LIB3270_PROPERTY_ITEM *item) {
+	const LIB3270_RESOLVED_NAME *resolved = item->resolved;
+
+	switch(resolved->type) {
+	case LIB3270_NAME_BOOLEAN:
+	case LIB3270_NAME_INT:
+		if(!resolved->value.int_property->set)
+			return EPERM;
+
+		if(item->type == LIB3270_NAME_STRING)
+			return resolved->value.int_property->set(hSession, item->value.string_value ? atoi(item->value.string_value) : 0);
+
+		return resolved->value.int_property->set(hSession, item->value.int_value);
+
+	case LIB3270_NAME_UINT:
+		if(!resolved->value.uint_property->set)
+			return EPERM;
+
+		if(item->type == LIB3270_NAME_STRING)
+			return resolved->value.uint_property->set(hSession, item->value.string_value ? strtoul(item->value.string_value,NULL,0) : 0);
+
+		return resolved->value.uint_property->set(hSession, item->value.uint_value);
+
+	case LIB3270_NAME_STRING:
+		if(!resolved->value.string_property->set)
+			return EPERM;
+
+		return resolved->value.string_property->set(hSession, item->value.string_value);
+
+	default:
+		return EINVAL;
+	}
+
+}
+
+int lib3270_property_batch(H3270 *hSession, LIB3270_PROPERTY_ITEM *items, unsigned int count, int seconds) {
+	unsigned int ix;
+	int rc = 0;
+
+	// Resolve all names before the first change.
+	for(ix = 0; ix < count; ix++) {
+		items[ix].rc = resolve_item(items+ix);
+		if(items[ix].rc && !rc)
+			rc = items[ix].rc;
+	}
+
+	if(rc)
+		return errno = rc;
+
+	if(seconds)
+		lib3270_wait_for_ready(hSession, seconds);
+
+	for(ix = 0; ix < count; ix++) {
+
+		if(items[ix].operation == LIB3270_PROPERTY_GET)
+			items[ix].rc = get_item(hSession,items+ix);
+		else
+			items[ix].rc = set_item(hSession,items+ix);
+
+		if(items[ix].rc && !rc)
+			rc = items[ix].rc;
+
+	}
+
+	if(rc)
+		errno = rc;
+
+	return rc;
+
+}
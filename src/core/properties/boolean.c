@@ -40,6 +40,7 @@
 #include <lib3270/keyboard.h>
 #include <lib3270/selection.h>
 #include <lib3270/ssl.h>
+#include <lib3270/stats.h>
 
 int lib3270_is_starting(const H3270 *hSession) {
 	return hSession->starting != 0;
@@ -205,6 +206,13 @@ const LIB3270_INT_PROPERTY * lib3270_get_boolean_properties_list(void) {
 #endif
 		},
 
+		{
+			.name = "exclude_unlock_delay",									//  Property name.
+			.description = N_( "Exclude the unlock delay from the response time" ),	//  Property description.
+			.get = lib3270_get_exclude_unlock_delay,						//  Get value.
+			.set = lib3270_set_exclude_unlock_delay							//  Set value.
+		},
+
 		{
 			.name = NULL,
 			.description = NULL,
@@ -219,25 +227,21 @@ const LIB3270_INT_PROPERTY * lib3270_get_boolean_properties_list(void) {
 }
 
 int lib3270_set_boolean_property(H3270 *hSession, const char *name, int value, int seconds) {
-	size_t ix;
-	const LIB3270_INT_PROPERTY * properties;
+	const LIB3270_RESOLVED_NAME * resolved;
 
 	if(seconds) {
 		lib3270_wait_for_ready(hSession, seconds);
 	}
 
-	properties = lib3270_get_boolean_properties_list();
-	for(ix = 0; properties[ix].name; ix++) {
-		if(!strcasecmp(name,properties[ix].name)) {
-			if(properties[ix].set)
-				return properties[ix].set(hSession, value);
-			else
-				return errno = EPERM;
-		}
+	resolved = lib3270_find_name(name,LIB3270_NAME_BOOLEAN);
 
-	}
+	if(!resolved)
+		return errno = ENOENT;
+
+	if(resolved->value.int_property->set)
+		return resolved->value.int_property->set(hSession, value);
 
-	return errno = ENOENT;
+	return errno = EPERM;
 
 }
 
@@ -87,7 +87,15 @@ LIB3270_EXPORT const char * lib3270_property_get_summary(const LIB3270_PROPERTY
 
 LIB3270_EXPORT const LIB3270_PROPERTY * lib3270_property_get_by_name(const char *name) {
 
-	// Search string properties
+	const LIB3270_RESOLVED_NAME * resolved = lib3270_find_name(name,LIB3270_NAME_STRING);
+
+	if(!resolved)
+		resolved = lib3270_find_name(name,LIB3270_NAME_UINT);
+
+	if(resolved)
+		return resolved->value.property;
+
+	// Search string properties for partial names (for compatibility)
 	{
 		const LIB3270_STRING_PROPERTY * property = lib3270_get_string_properties_list();
 
@@ -0,0 +1,189 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como resolve.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Name index for actions, toggles and properties.
+ *
+ * The tables are static, so the index is built once, on the first lookup: every name is
+ * normalized (uppercase, alphanumeric characters only) and the entries are sorted by
+ * normalized name and type for binary search.
+ *
+ */
+
+#include <config.h>
+#include <internals.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <lib3270.h>
+#include <lib3270/properties.h>
+
+/// @brief Maximum length of a normalized name.
+#define NAME_MAX_LENGTH	64
+
+typedef struct _name_entry {
+	LIB3270_RESOLVED_NAME	  name;
+	char			  key[NAME_MAX_LENGTH];
+} NAME_ENTRY;
+
+static struct {
+	pthread_once_t	  once;
+	size_t			  length;
+	NAME_ENTRY		* entries;
+} names_index = {
+	PTHREAD_ONCE_INIT,
+	0,
+	NULL
+};
+
+/// @brief Normalize name, returns non zero if it's too long.
+static int normalize(char *key, const char *name) {
+
+	size_t length = 0;
+
+	for(; *name; name++) {
+
+		if(!isalnum((unsigned char) *name))
+			continue;
+
+		if(length >= (NAME_MAX_LENGTH-1))
+			return -1;
+
+		key[length++] = toupper((unsigned char) *name);
+
+	}
+
+	key[length] = 0;
+	return 0;
+}
+
+static int compare_entries(const void *a, const void *b) {
+
+	const NAME_ENTRY * e1 = (const NAME_ENTRY *) a;
+	const NAME_ENTRY * e2 = (const NAME_ENTRY *) b;
+	int rc = strcmp(e1->key,e2->key);
+
+	if(rc)
+		return rc;
+
+	return ((int) e1->name.type) - ((int) e2->name.type);
+}
+
+static void add_entry(LIB3270_NAME_TYPE type, const void *value) {
+
+	NAME_ENTRY * entry = names_index.entries + names_index.length;
+
+	entry->name.type			= type;
+	entry->name.value.property	= (const LIB3270_PROPERTY *) value;
+
+	if(!normalize(entry->key,entry->name.value.property->name))
+		names_index.length++;
+
+}
+
+static void build_index(void) {
+
+	const LIB3270_ACTION			* actions			= lib3270_get_actions();
+	const LIB3270_TOGGLE			* toggles			= lib3270_get_toggles();
+	const LIB3270_INT_PROPERTY		* booleans			= lib3270_get_boolean_properties_list();
+	const LIB3270_INT_PROPERTY		* ints				= lib3270_get_int_properties_list();
+	const LIB3270_UINT_PROPERTY		* uints				= lib3270_get_unsigned_properties_list();
+	const LIB3270_STRING_PROPERTY	* strings			= lib3270_get_string_properties_list();
+	size_t							  count				= LIB3270_TOGGLE_COUNT;
+	size_t							  ix;
+
+	for(ix = 0; actions[ix].name; ix++)
+		count++;
+	for(ix = 0; booleans[ix].name; ix++)
+		count++;
+	for(ix = 0; ints[ix].name; ix++)
+		count++;
+	for(ix = 0; uints[ix].name; ix++)
+		count++;
+	for(ix = 0; strings[ix].name; ix++)
+		count++;
+
+	names_index.entries = lib3270_malloc(sizeof(NAME_ENTRY) * count);
+
+	for(ix = 0; actions[ix].name; ix++)
+		add_entry(LIB3270_NAME_ACTION,actions+ix);
+	for(ix = 0; ix < LIB3270_TOGGLE_COUNT; ix++)
+		add_entry(LIB3270_NAME_TOGGLE,toggles+ix);
+	for(ix = 0; booleans[ix].name; ix++)
+		add_entry(LIB3270_NAME_BOOLEAN,booleans+ix);
+	for(ix = 0; ints[ix].name; ix++)
+		add_entry(LIB3270_NAME_INT,ints+ix);
+	for(ix = 0; uints[ix].name; ix++)
+		add_entry(LIB3270_NAME_UINT,uints+ix);
+	for(ix = 0; strings[ix].name; ix++)
+		add_entry(LIB3270_NAME_STRING,strings+ix);
+
+	qsort(names_index.entries,names_index.length,sizeof(NAME_ENTRY),compare_entries);
+
+}
+
+const LIB3270_RESOLVED_NAME * lib3270_find_name(const char *name, int type) {
+
+	char	key[NAME_MAX_LENGTH];
+	size_t	first, last;
+
+	pthread_once(&names_index.once,build_index);
+
+	if(!name || normalize(key,name)) {
+		errno = ENOENT;
+		return NULL;
+	}
+
+	// Find the first entry with this name.
+	first	= 0;
+	last	= names_index.length;
+
+	while(first < last) {
+		size_t middle = (first + last) / 2;
+		if(strcmp(names_index.entries[middle].key,key) < 0)
+			first = middle + 1;
+		else
+			last = middle;
+	}
+
+	// The entries with the same name are sorted by type.
+	for(; first < names_index.length && !strcmp(names_index.entries[first].key,key); first++) {
+		if(type < 0 || names_index.entries[first].name.type == (LIB3270_NAME_TYPE) type)
+			return &names_index.entries[first].name;
+	}
+
+	errno = ENOENT;
+	return NULL;
+
+}
+
+LIB3270_EXPORT const LIB3270_RESOLVED_NAME * lib3270_resolve_name(const char *name) {
+	return lib3270_find_name(name,-1);
+}
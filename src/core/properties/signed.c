@@ -92,79 +92,47 @@ const LIB3270_INT_PROPERTY * lib3270_get_int_properties_list(void) {
 
 
 int lib3270_get_int_property(H3270 *hSession, const char *name, int seconds) {
-	size_t ix;
-	const LIB3270_INT_PROPERTY * properties;
+	const LIB3270_RESOLVED_NAME * resolved;
 
 	if(seconds) {
 		lib3270_wait_for_ready(hSession, seconds);
 	}
 
-	// Check for boolean properties
-	properties = lib3270_get_boolean_properties_list();
-	for(ix = 0; properties[ix].name; ix++) {
-		if(!strcasecmp(name,properties[ix].name)) {
-			if(properties[ix].get) {
-				return properties[ix].get(hSession);
-			} else {
-				errno = EPERM;
-				return -1;
-			}
-		}
-
+	// Check for boolean properties, then for int properties.
+	resolved = lib3270_find_name(name,LIB3270_NAME_BOOLEAN);
+	if(!resolved)
+		resolved = lib3270_find_name(name,LIB3270_NAME_INT);
 
+	if(!resolved) {
+		errno = ENOENT;
+		return -1;
 	}
 
-	// Check for int properties
-	properties = lib3270_get_int_properties_list();
-	for(ix = 0; properties[ix].name; ix++) {
-		if(!strcasecmp(name,properties[ix].name)) {
-			if(properties[ix].get) {
-				return properties[ix].get(hSession);
-			} else {
-				errno = EPERM;
-				return -1;
-			}
-		}
-
-
-	}
+	if(resolved->value.int_property->get)
+		return resolved->value.int_property->get(hSession);
 
-	errno = ENOENT;
+	errno = EPERM;
 	return -1;
 }
 
 int lib3270_set_int_property(H3270 *hSession, const char *name, int value, int seconds) {
-	size_t ix;
-	const LIB3270_INT_PROPERTY * properties;
+	const LIB3270_RESOLVED_NAME * resolved;
 
 	if(seconds)
 		lib3270_wait_for_ready(hSession, seconds);
 
-	// Check for INT Properties
-	properties = lib3270_get_int_properties_list();
-	for(ix = 0; properties[ix].name; ix++) {
-		if(!strcasecmp(name,properties[ix].name)) {
-			if(properties[ix].set)
-				return properties[ix].set(hSession, value);
-			else
-				return errno = EPERM;
-		}
+	// Check for int properties, then for boolean properties.
+	resolved = lib3270_find_name(name,LIB3270_NAME_INT);
+	if(!resolved)
+		resolved = lib3270_find_name(name,LIB3270_NAME_BOOLEAN);
 
-	}
+	if(!resolved)
+		return errno = ENOENT;
 
-	// Check for boolean properties
-	properties = lib3270_get_boolean_properties_list();
-	for(ix = 0; properties[ix].name; ix++) {
-		if(!strcasecmp(name,properties[ix].name)) {
-			if(properties[ix].set)
-				return properties[ix].set(hSession, value);
-			else
-				return errno = EPERM;
-		}
-
-	}
+	if(resolved->value.int_property->set)
+		return resolved->value.int_property->set(hSession, value);
 
-	return errno = ENOENT;
+	return errno = EPERM;
 
 }
 
@@ -183,6 +183,15 @@ LIB3270_EXPORT const LIB3270_STRING_PROPERTY * lib3270_get_string_properties_lis
 			.set = lib3270_set_oversize												//  Set value.
 		},
 
+		{
+			.name = "network_profile",												// Property name.
+			.default_value = "default",												// Default value.
+			.group = LIB3270_ACTION_GROUP_OFFLINE,										// Property group.
+			.description = N_( "Socket tuning profile (default, latency or throughput)"),	// Property description.
+			.get = lib3270_get_network_profile_name,								// Get value.
+			.set = lib3270_set_network_profile_by_name								// Set value.
+		},
+
 		{
 			.name = "logfile",														//  Property name.
 			.group = LIB3270_ACTION_GROUP_NONE,										// Property group.
@@ -199,6 +208,14 @@ LIB3270_EXPORT const LIB3270_STRING_PROPERTY * lib3270_get_string_properties_lis
 			.set = lib3270_set_trace_filename										//  Set value.
 		},
 
+		{
+			.name = "binary_tracefile",												//  Property name.
+			.group = LIB3270_ACTION_GROUP_NONE,										// Property group.
+			.description = N_( "The binary trace file name"),						//  Property description.
+			.get = lib3270_get_binary_trace_filename,								//  Get value.
+			.set = lib3270_set_binary_trace_filename								//  Set value.
+		},
+
 		{
 			.name = NULL,
 			.description = NULL,
@@ -213,78 +230,42 @@ LIB3270_EXPORT const LIB3270_STRING_PROPERTY * lib3270_get_string_properties_lis
 }
 
 int lib3270_set_string_property(H3270 *hSession, const char *name, const char * value, int seconds) {
-	size_t ix;
+	const LIB3270_RESOLVED_NAME * resolved;
 
 	if(seconds) {
 		lib3270_wait_for_ready(hSession, seconds);
 	}
 
-	//
 	// Check for string property
-	//
-	{
-		const LIB3270_STRING_PROPERTY * properties = lib3270_get_string_properties_list();
-		for(ix = 0; properties[ix].name; ix++) {
-			if(!strcasecmp(name,properties[ix].name)) {
-				if(properties[ix].set) {
-					return properties[ix].set(hSession, value);
-				} else {
-					return errno = EPERM;
-				}
-			}
-
-		}
+	resolved = lib3270_find_name(name,LIB3270_NAME_STRING);
+	if(resolved) {
+		if(resolved->value.string_property->set)
+			return resolved->value.string_property->set(hSession, value);
+		return errno = EPERM;
 	}
 
-	//
 	// Check for signed int property
-	//
-	{
-		const LIB3270_INT_PROPERTY * properties = lib3270_get_int_properties_list();
-		for(ix = 0; properties[ix].name; ix++) {
-			if(!strcasecmp(name,properties[ix].name)) {
-				if(properties[ix].set) {
-					return properties[ix].set(hSession, atoi(value));
-				} else {
-					return errno = EPERM;
-				}
-			}
-
-		}
+	resolved = lib3270_find_name(name,LIB3270_NAME_INT);
+	if(resolved) {
+		if(resolved->value.int_property->set)
+			return resolved->value.int_property->set(hSession, atoi(value));
+		return errno = EPERM;
 	}
 
-	//
 	// Check for unsigned int property
-	//
-	{
-		const LIB3270_UINT_PROPERTY * properties = lib3270_get_unsigned_properties_list();
-		for(ix = 0; properties[ix].name; ix++) {
-			if(!strcasecmp(name,properties[ix].name)) {
-				if(properties[ix].set) {
-					return properties[ix].set(hSession, strtoul(value,NULL,0));
-				} else {
-					return errno = EPERM;
-				}
-			}
-
-		}
+	resolved = lib3270_find_name(name,LIB3270_NAME_UINT);
+	if(resolved) {
+		if(resolved->value.uint_property->set)
+			return resolved->value.uint_property->set(hSession, strtoul(value,NULL,0));
+		return errno = EPERM;
 	}
 
-	//
 	// Check for boolean property
-	//
-	{
-		const LIB3270_INT_PROPERTY * properties = lib3270_get_int_properties_list();
-		for(ix = 0; properties[ix].name; ix++) {
-			if(!strcasecmp(name,properties[ix].name)) {
-				if(properties[ix].set) {
-					return properties[ix].set(hSession, atoi(value));
-				} else {
-					return errno = EPERM;
-				}
-			}
-
-		}
+	resolved = lib3270_find_name(name,LIB3270_NAME_BOOLEAN);
+	if(resolved) {
+		if(resolved->value.int_property->set)
+			return resolved->value.int_property->set(hSession, atoi(value));
+		return errno = EPERM;
 	}
 
 	return errno = ENOENT;
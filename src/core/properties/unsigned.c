@@ -33,19 +33,17 @@
 #include <lib3270.h>
 #include <lib3270/properties.h>
 #include <lib3270/keyboard.h>
+#include <lib3270/log.h>
 
 unsigned int lib3270_get_kybdlock_as_int(const H3270 *hSession) {
 	return (unsigned int) lib3270_get_keyboard_lock_state(hSession);
 }
 
 const LIB3270_UINT_PROPERTY * lib3270_unsigned_property_get_by_name(const char *name) {
-	size_t ix;
-	const LIB3270_UINT_PROPERTY * list = lib3270_get_unsigned_properties_list();
+	const LIB3270_RESOLVED_NAME * resolved = lib3270_find_name(name,LIB3270_NAME_UINT);
 
-	for(ix = 0; list[ix].name; ix++) {
-		if(!strcasecmp(list[ix].name,name))
-			return &list[ix];
-	}
+	if(resolved)
+		return resolved->value.uint_property;
 
 	errno = ENOENT;
 	return NULL;
@@ -61,6 +59,14 @@ static unsigned int lib3270_get_host_type_number(const H3270 *hSession) {
 	return (unsigned int) hSession->host_type;
 }
 
+static int lib3270_set_typeahead_overflow_number(H3270 *hSession, unsigned int policy) {
+	return lib3270_set_typeahead_overflow(hSession,(LIB3270_TYPEAHEAD_OVERFLOW) policy);
+}
+
+static unsigned int lib3270_get_typeahead_overflow_number(const H3270 *hSession) {
+	return (unsigned int) lib3270_get_typeahead_overflow(hSession);
+}
+
 LIB3270_EXPORT unsigned int lib3270_get_auto_reconnect(const H3270 *hSession) {
 	return hSession->connection.retry;
 }
@@ -164,6 +170,60 @@ const LIB3270_UINT_PROPERTY * lib3270_get_unsigned_properties_list(void) {
 			.set = lib3270_set_unlock_delay																		//  Set value.
 		},
 
+		{
+			.name = "trace_max_size",																			//  Property name.
+			.min = 0,
+			.max = 4194304,
+			.description = N_( "Maximum trace file size in kbytes (0 for no limit)" ),							//  Property description.
+			.get = lib3270_get_trace_max_size,																	//  Get value.
+			.set = lib3270_set_trace_max_size																	//  Set value.
+		},
+
+		{
+			.name = "log_max_size",																				//  Property name.
+			.min = 0,
+			.max = 4194304,
+			.description = N_( "Maximum log file size in kbytes (0 for no limit)" ),							//  Property description.
+			.get = lib3270_get_log_max_size,																	//  Get value.
+			.set = lib3270_set_log_max_size																		//  Set value.
+		},
+
+		{
+			.name = "log_rotate_interval",																		//  Property name.
+			.min = 0,
+			.max = 31536000,
+			.description = N_( "Log file rotation interval in seconds (0 to disable)" ),						//  Property description.
+			.get = lib3270_get_log_rotate_interval,																//  Get value.
+			.set = lib3270_set_log_rotate_interval																//  Set value.
+		},
+
+		{
+			.name = "log_rate_limit",																			//  Property name.
+			.min = 0,
+			.max = 100000,
+			.description = N_( "Maximum log messages per module per second (0 for no limit)" ),					//  Property description.
+			.get = lib3270_get_log_rate_limit,																	//  Get value.
+			.set = lib3270_set_log_rate_limit																	//  Set value.
+		},
+
+		{
+			.name = "typeahead_limit",																			//  Property name.
+			.min = 0,
+			.max = 1000000,
+			.description = N_( "Maximum number of actions on the typeahead queue (0 for no limit)" ),			//  Property description.
+			.get = lib3270_get_typeahead_limit,																	//  Get value.
+			.set = lib3270_set_typeahead_limit																	//  Set value.
+		},
+
+		{
+			.name = "typeahead_overflow",																		//  Property name.
+			.min = 0,
+			.max = 1,
+			.description = N_( "When the typeahead queue is full drop the new action (0) or the oldest one (1)" ),	//  Property description.
+			.get = lib3270_get_typeahead_overflow_number,														//  Get value.
+			.set = lib3270_set_typeahead_overflow_number														//  Set value.
+		},
+
 		{
 			.name = "kybdlock",																					//  Property name.
 			.description = N_( "Keyboard lock status" ),														//  Property description.
@@ -183,26 +243,20 @@ const LIB3270_UINT_PROPERTY * lib3270_get_unsigned_properties_list(void) {
 }
 
 int lib3270_set_uint_property(H3270 *hSession, const char *name, unsigned int value, int seconds) {
-	size_t ix;
-	const LIB3270_UINT_PROPERTY * properties;
+	const LIB3270_RESOLVED_NAME * resolved;
 
 	if(seconds)
 		lib3270_wait_for_ready(hSession, seconds);
 
-	// Check for INT Properties
-	properties = lib3270_get_unsigned_properties_list();
+	resolved = lib3270_find_name(name,LIB3270_NAME_UINT);
 
-	for(ix = 0; properties[ix].name; ix++) {
-		if(!strcasecmp(name,properties[ix].name)) {
-			if(properties[ix].set)
-				return properties[ix].set(hSession, value);
-			else
-				return errno = EPERM;
-		}
+	if(!resolved)
+		return errno = ENOENT;
 
-	}
+	if(resolved->value.uint_property->set)
+		return resolved->value.uint_property->set(hSession, value);
 
-	return errno = ENOENT;
+	return errno = EPERM;
 
 }
 
@@ -49,6 +49,7 @@
 #include "screen.h"
 #include "errno.h"
 #include "statusc.h"
+#include "statsc.h"
 #include "togglesc.h"
 #include <lib3270/actions.h>
 #include <lib3270/log.h>
@@ -253,14 +254,13 @@ LIB3270_EXPORT unsigned int lib3270_get_max_height(const H3270 *h) {
 }
 
 void update_model_info(H3270 *hSession, unsigned int model, unsigned int cols, unsigned int rows) {
-	if(model == hSession->model_num && hSession->max.rows == rows && hSession->max.cols == cols)
-		return;
+	int changed = !(model == hSession->model_num && hSession->max.rows == rows && hSession->max.cols == cols);
 
 	hSession->max.cols  	= cols;
 	hSession->max.rows  	= rows;
 	hSession->model_num	= model;
 
-	/* Update the model name. */
+	/* Update the model name, lib3270_set_model_number() resets it even when the model is the same. */
 	(void) sprintf(hSession->model_name, "327%c-%d%s",hSession->m3279 ? '9' : '8',hSession->model_num,hSession->extended ? "-E" : "");
 
 	if (hSession->termname != CN)
@@ -270,6 +270,9 @@ void update_model_info(H3270 *hSession, unsigned int model, unsigned int cols, u
 	else
 		hSession->termtype = hSession->full_model_name;
 
+	if(!changed)
+		return;
+
 	trace("Termtype: %s",hSession->termtype);
 
 	hSession->cbk.update_model(hSession, hSession->model_name,hSession->model_num,rows,cols);
@@ -303,10 +306,14 @@ void screen_update(H3270 *session, int bstart, int bend) {
 	int				fa_addr;
 	int				first	= -1;
 	int				last	= -1;
+	unsigned long long started	= stage_begin(session);
+	unsigned long long clock	= stats_clock();
 
 	fa		= get_field_attribute(session,bstart);
 	a  		= color_from_fa(session,fa);
-	fa_addr = lib3270_field_addr(session,bstart); // may be -1, that's okay
+	fa_addr = lib3270_field_addr(session,bstart);
+	if(fa_addr < 0)
+		fa_addr = -1;	// Unformatted, ea_buf[-1] has the default attribute.
 
 	for(baddr = bstart; baddr < bend; baddr++) {
 		if(session->ea_buf[baddr].fa) {
@@ -367,6 +374,9 @@ void screen_update(H3270 *session, int bstart, int bend) {
 #endif
 	}
 
+	stats_elapsed(session->stats.counters.screen_update,clock);
+	stage_end(session,LIB3270_STAGE_SCREEN_UPDATE,started);
+
 //	trace("%s ends",__FUNCTION__);
 
 }
@@ -606,6 +616,10 @@ void status_changed(H3270 *hSession, LIB3270_MESSAGE id) {
 
 	hSession->oia.status = id;
 	hSession->cbk.update_status(hSession,id);
+	lib3270_macro_wakeup(hSession);
+
+	if(id == LIB3270_MESSAGE_NONE)
+		lib3270_ft_queue_wakeup(hSession);
 }
 
 void status_twait(H3270 *session) {
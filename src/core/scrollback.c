@@ -0,0 +1,379 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como scrollback.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief NVT scrollback.
+ *
+ * Keeps the rows scrolled out of the NVT screen as UTF-8 text, without the
+ * trailing blanks and with the runs of a repeated character packed, on a ring
+ * of bytes; the oldest rows are dropped when the line or the byte limit is
+ * reached.
+ *
+ */
+
+#include <config.h>
+#include <internals.h>
+#include <string.h>
+#include <errno.h>
+#include <lib3270/charset.h>
+#include "ctlrc.h"
+
+/// @brief Default number of lines.
+#define SCROLLBACK_LINES	1024
+
+/// @brief Marks a packed run on the text ring (never found on UTF-8): SCROLLBACK_RUN, count, character.
+#define SCROLLBACK_RUN		0xff
+
+/// @brief Shortest run worth packing.
+#define SCROLLBACK_MIN_RUN	4
+
+typedef struct _scrollback_line {
+	size_t			  offset;		///< @brief Start of the line on the text ring.
+	unsigned short	  length;		///< @brief Packed length.
+} SCROLLBACK_LINE;
+
+struct _lib3270_scrollback {
+	unsigned int	  max;			///< @brief Maximum number of lines (0 disables the scrollback).
+	unsigned int	  length;		///< @brief Number of lines stored.
+	unsigned long	  total;		///< @brief Number of lines scrolled out.
+	SCROLLBACK_LINE	* lines;		///< @brief Line ring, line 'n' is on lines[n % max].
+
+	size_t			  size;			///< @brief Size of the text ring.
+	size_t			  used;			///< @brief Bytes in use on the text ring.
+	size_t			  head;			///< @brief Next free byte on the text ring.
+	unsigned char	* text;
+
+	/// @brief Work buffers for the row being added.
+	struct {
+		size_t			  size;
+		size_t			  length;
+		unsigned char	* text;		///< @brief Row as UTF-8.
+		unsigned char	* ebc;		///< @brief Run of CS_BASE cells.
+		int				  cols;		///< @brief Size of the ebc buffer.
+	} work;
+};
+
+/// @brief DEC special graphics as UTF-8, CS_LINEDRAW cells hold the NVT character - 0x5f.
+static const char * linedraw[32] = {
+	" ",				"\xe2\x97\x86",		"\xe2\x96\x92",		"\xe2\x90\x89",		// blank ◆ ▒ ␉
+	"\xe2\x90\x8c",		"\xe2\x90\x8d",		"\xe2\x90\x8a",		"\xc2\xb0",			// ␌ ␍ ␊ °
+	"\xc2\xb1",			"\xe2\x90\xa4",		"\xe2\x90\x8b",		"\xe2\x94\x98",		// ± ␤ ␋ ┘
+	"\xe2\x94\x90",		"\xe2\x94\x8c",		"\xe2\x94\x94",		"\xe2\x94\xbc",		// ┐ ┌ └ ┼
+	"\xe2\x8e\xba",		"\xe2\x8e\xbb",		"\xe2\x94\x80",		"\xe2\x8e\xbc",		// ⎺ ⎻ ─ ⎼
+	"\xe2\x8e\xbd",		"\xe2\x94\x9c",		"\xe2\x94\xa4",		"\xe2\x94\xb4",		// ⎽ ├ ┤ ┴
+	"\xe2\x94\xac",		"\xe2\x94\x82",		"\xe2\x89\xa4",		"\xe2\x89\xa5",		// ┬ │ ≤ ≥
+	"\xcf\x80",			"\xe2\x89\xa0",		"\xc2\xa3",			"\xc2\xb7"			// π ≠ £ ·
+};
+
+/// @brief Unicode replacement character, for the character sets without a mapping here.
+#define SCROLLBACK_UNKNOWN	"\xef\xbf\xbd"
+
+static struct _lib3270_scrollback * scrollback_new(H3270 *hSession, unsigned int lines) {
+
+	struct _lib3270_scrollback * scrollback = lib3270_malloc(sizeof(struct _lib3270_scrollback));
+
+	memset(scrollback,0,sizeof(struct _lib3270_scrollback));
+
+	scrollback->max = lines;
+
+	if(lines) {
+		scrollback->lines	= lib3270_malloc(sizeof(SCROLLBACK_LINE) * lines);
+		scrollback->size	= ((size_t) lines) * (hSession->max.cols ? hSession->max.cols : 80);
+		scrollback->text	= lib3270_malloc(scrollback->size);
+	}
+
+	return scrollback;
+}
+
+void scrollback_free(H3270 *hSession) {
+
+	struct _lib3270_scrollback * scrollback = hSession->scrollback;
+
+	if(scrollback) {
+		hSession->scrollback = NULL;
+		lib3270_free(scrollback->lines);
+		lib3270_free(scrollback->text);
+		lib3270_free(scrollback->work.text);
+		lib3270_free(scrollback->work.ebc);
+		lib3270_free(scrollback);
+	}
+
+}
+
+/// @brief Drop the oldest line.
+static void scrollback_drop(struct _lib3270_scrollback *scrollback) {
+	scrollback->used -= scrollback->lines[(scrollback->total - scrollback->length) % scrollback->max].length;
+	scrollback->length--;
+}
+
+/// @brief Append UTF-8 text to the row being added.
+static void scrollback_append(struct _lib3270_scrollback *scrollback, const char *text, size_t length) {
+
+	if(scrollback->work.length + length > scrollback->work.size) {
+		scrollback->work.size = (scrollback->work.length + length) * 2;
+		scrollback->work.text = lib3270_realloc(scrollback->work.text,scrollback->work.size);
+	}
+
+	memcpy(scrollback->work.text + scrollback->work.length,text,length);
+	scrollback->work.length += length;
+
+}
+
+/// @brief Append a run of CS_BASE cells, converted to UTF-8 through the session charset.
+static void scrollback_append_base(H3270 *hSession, struct _lib3270_scrollback *scrollback, size_t length) {
+
+	char * text;
+
+	if(!length)
+		return;
+
+	text = lib3270_ebc2utf8(hSession,scrollback->work.ebc,(int) length);
+
+	if(text) {
+		scrollback_append(scrollback,text,strlen(text));
+		lib3270_free(text);
+	} else {
+		while(length--)
+			scrollback_append(scrollback,SCROLLBACK_UNKNOWN,sizeof(SCROLLBACK_UNKNOWN)-1);
+	}
+
+}
+
+/**
+ * @brief Pack the row into the text ring.
+ *
+ * @param ring		Text ring (NULL to get the packed length only).
+ * @param offset	Where to start on the ring.
+ *
+ * @return Packed length.
+ */
+static size_t scrollback_pack(const struct _lib3270_scrollback *scrollback, unsigned char *ring, size_t offset) {
+
+	const unsigned char	* text		= scrollback->work.text;
+	size_t				  length	= scrollback->work.length;
+	size_t				  packed	= 0;
+
+	while(length) {
+
+		unsigned char	  chr = *text;
+		size_t			  run = 1;
+
+		// Only single byte characters are packed, the count can't split an UTF-8 sequence.
+		if(chr < 0x80) {
+			while(run < length && run < 0xff && text[run] == chr)
+				run++;
+		}
+
+		if(run >= SCROLLBACK_MIN_RUN) {
+			if(ring) {
+				ring[offset] = SCROLLBACK_RUN;
+				ring[(offset + 1) % scrollback->size] = (unsigned char) run;
+				ring[(offset + 2) % scrollback->size] = chr;
+				offset = (offset + 3) % scrollback->size;
+			}
+			packed += 3;
+		} else {
+			run = 1;
+			if(ring) {
+				ring[offset] = chr;
+				offset = (offset + 1) % scrollback->size;
+			}
+			packed++;
+		}
+
+		text += run;
+		length -= run;
+
+	}
+
+	return packed;
+}
+
+void scrollback_add(H3270 *hSession, const struct lib3270_ea *row, int cols) {
+
+	struct _lib3270_scrollback	* scrollback;
+	SCROLLBACK_LINE				* line;
+	int							  length	= cols;
+	int							  col;
+	size_t						  run		= 0;
+	size_t						  packed;
+
+	if(!hSession->scrollback)
+		hSession->scrollback = scrollback_new(hSession,SCROLLBACK_LINES);
+
+	scrollback = hSession->scrollback;
+	if(!scrollback->max)
+		return;
+
+	// Blanks at the end of the line aren't stored.
+	while(length > 0 && (
+			row[length-1].fa ||
+			(row[length-1].cs == CS_BASE && hSession->charset.ebc2asc[row[length-1].cc] <= ' ') ||
+			(row[length-1].cs == CS_LINEDRAW && !row[length-1].cc)
+		))
+		length--;
+
+	if(scrollback->work.cols < cols) {
+		scrollback->work.cols = cols;
+		scrollback->work.ebc = lib3270_realloc(scrollback->work.ebc,cols);
+	}
+
+	scrollback->work.length = 0;
+
+	for(col = 0; col < length; col++) {
+
+		if(!row[col].fa && row[col].cs == CS_BASE) {
+			// Control characters are shown as blanks.
+			scrollback->work.ebc[run++] = (hSession->charset.ebc2asc[row[col].cc] > ' ') ? row[col].cc : 0x40;
+			continue;
+		}
+
+		scrollback_append_base(hSession,scrollback,run);
+		run = 0;
+
+		if(row[col].fa)
+			scrollback_append(scrollback," ",1);
+		else if(row[col].cs == CS_LINEDRAW && row[col].cc < (sizeof(linedraw)/sizeof(linedraw[0])))
+			scrollback_append(scrollback,linedraw[row[col].cc],strlen(linedraw[row[col].cc]));
+		else
+			scrollback_append(scrollback,SCROLLBACK_UNKNOWN,sizeof(SCROLLBACK_UNKNOWN)-1);
+
+	}
+
+	scrollback_append_base(hSession,scrollback,run);
+
+	packed = scrollback_pack(scrollback,NULL,0);
+
+	if(packed > scrollback->size || packed > 0xffff) {
+		// Doesn't fit on the ring, keep the line number.
+		packed = 0;
+		scrollback->work.length = 0;
+	}
+
+	while(scrollback->length && (scrollback->length >= scrollback->max || (scrollback->used + packed) > scrollback->size))
+		scrollback_drop(scrollback);
+
+	line			= scrollback->lines + (scrollback->total % scrollback->max);
+	line->offset	= scrollback->head;
+	line->length	= (unsigned short) packed;
+
+	scrollback_pack(scrollback,scrollback->text,scrollback->head);
+
+	scrollback->head = (scrollback->head + packed) % scrollback->size;
+	scrollback->used += packed;
+	scrollback->length++;
+	scrollback->total++;
+
+}
+
+LIB3270_EXPORT int lib3270_set_scrollback(H3270 *hSession, unsigned int lines) {
+
+	scrollback_free(hSession);
+	hSession->scrollback = scrollback_new(hSession,lines);
+
+	return 0;
+}
+
+LIB3270_EXPORT unsigned int lib3270_get_scrollback(const H3270 *hSession) {
+	return hSession->scrollback ? hSession->scrollback->max : SCROLLBACK_LINES;
+}
+
+LIB3270_EXPORT unsigned int lib3270_get_scrollback_length(const H3270 *hSession) {
+	return hSession->scrollback ? hSession->scrollback->length : 0;
+}
+
+LIB3270_EXPORT unsigned long lib3270_get_scrollback_total(const H3270 *hSession) {
+	return hSession->scrollback ? hSession->scrollback->total : 0;
+}
+
+/**
+ * @brief Unpack a line from the text ring.
+ *
+ * @param text		Output buffer (NULL to get the unpacked length only).
+ *
+ * @return Unpacked length.
+ */
+static size_t scrollback_unpack(const struct _lib3270_scrollback *scrollback, const SCROLLBACK_LINE *entry, char *text) {
+
+	size_t offset	= entry->offset;
+	size_t length	= entry->length;
+	size_t unpacked	= 0;
+
+	while(length) {
+
+		unsigned char chr = scrollback->text[offset];
+
+		if(chr == SCROLLBACK_RUN) {
+
+			size_t run = scrollback->text[(offset + 1) % scrollback->size];
+
+			if(text)
+				memset(text + unpacked,scrollback->text[(offset + 2) % scrollback->size],run);
+
+			unpacked += run;
+			offset = (offset + 3) % scrollback->size;
+			length -= 3;
+
+		} else {
+
+			if(text)
+				text[unpacked] = (char) chr;
+
+			unpacked++;
+			offset = (offset + 1) % scrollback->size;
+			length--;
+
+		}
+
+	}
+
+	return unpacked;
+}
+
+LIB3270_EXPORT char * lib3270_get_scrollback_line(const H3270 *hSession, unsigned long line) {
+
+	const struct _lib3270_scrollback	* scrollback = hSession->scrollback;
+	const SCROLLBACK_LINE				* entry;
+	char								* text;
+	size_t								  length;
+
+	if(!scrollback || line >= scrollback->total || line < (scrollback->total - scrollback->length)) {
+		errno = ENOENT;
+		return NULL;
+	}
+
+	entry	= scrollback->lines + (line % scrollback->max);
+	length	= scrollback_unpack(scrollback,entry,NULL);
+	text	= lib3270_malloc(length + 1);
+
+	scrollback_unpack(scrollback,entry,text);
+	text[length] = 0;
+
+	return text;
+}
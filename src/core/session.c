@@ -32,9 +32,12 @@
 #include "kybdc.h"
 #include "3270ds.h"
 #include "popupsc.h"
+#include "trace_dsc.h"
 #include <lib3270/trace.h>
 #include <lib3270/log.h>
 #include <lib3270/properties.h>
+#include <lib3270/macro.h>
+#include <lib3270/charset.h>
 
 /*---[ Globals ]--------------------------------------------------------------------------------------------------------------*/
 
@@ -71,6 +74,15 @@ void lib3270_session_free(H3270 *h) {
 		lib3270_write_log(h,LIB3270_STRINGIZE_VALUE_OF(PRODUCT_NAME),"Destroying session with %u active task(s)",h->tasks);
 	}
 
+	if(h->macro)
+		lib3270_macro_cancel(h);
+
+	if(h->ft_queue)
+		ft_queue_free(h);
+
+	scrollback_free(h);
+	query_reply_reset(h);
+
 	shutdown_toggles(h);
 
 	// Release network module
@@ -123,13 +135,21 @@ void lib3270_session_free(H3270 *h) {
 	release_pointer(h->charset.host);
 	release_pointer(h->charset.display);
 
+	if(h->utf8.conv) {
+		lib3270_iconv_free(h->utf8.conv);
+		h->utf8.conv = NULL;
+	}
+	release_pointer(h->utf8.charset);
+
 	release_pointer(h->text);
 	release_pointer(h->zero_buf);
 
 	release_pointer(h->output.base);
+	release_pointer(h->network.cork.buffer);
 
 	release_pointer(h->sbbuf);
 	release_pointer(h->tabs);
+	release_pointer(h->ta.ring);
 
 	// Release timeouts
 	lib3270_linked_list_free(&h->timeouts);
@@ -138,8 +158,13 @@ void lib3270_session_free(H3270 *h) {
 	lib3270_linked_list_free(&h->input.list);
 
 	// Release logfile
+	lib3270_flush_log(h);
+	trace_writer_free(h->log.writer);
 	release_pointer(h->log.file);
+	trace_writer_free(h->trace.writer);
 	release_pointer(h->trace.file);
+	trace_writer_free(h->trace.binary.writer);
+	release_pointer(h->trace.binary.file);
 	lib3270_free(h);
 
 }
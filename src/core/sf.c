@@ -150,6 +150,19 @@ static struct reply {
 #define NSR_ALL	(sizeof(replies)/sizeof(struct reply))
 #define NSR	(NSR_ALL - 1)
 
+/**
+ * @brief Serialized query replies, built on the first query.
+ *
+ * Dropped by query_reply_reset() when the session configuration changes,
+ * query_reply_drop() rebuilds a single reply.
+ */
+struct _lib3270_query_replies {
+	struct {
+		unsigned char	* data;
+		size_t			  length;
+	} reply[NSR_ALL];
+};
+
 /**
  * Process a 3270 Write Structured Field command
  */
@@ -260,7 +273,9 @@ static enum pds sf_read_part(H3270 *hSession, unsigned char buf[], unsigned bufl
 	unsigned char partition;
 	unsigned i;
 	int any = 0;
+#if defined(X3270_TRACE)
 	const char *comma = "";
+#endif
 
 	if (buflen < 5) {
 		trace_ds(hSession," error: field length %d too small\n", buflen);
@@ -307,7 +322,9 @@ static enum pds sf_read_part(H3270 *hSession, unsigned char buf[], unsigned bufl
 			} else {
 				for (i = 6; i < buflen; i++) {
 					trace_ds(hSession,"%s%s", comma,see_qcode(buf[i]));
+#if defined(X3270_TRACE)
 					comma = ",";
+#endif
 				}
 				trace_ds(hSession,")\n");
 				for (i = 0; i < NSR; i++) {
@@ -332,7 +349,9 @@ static enum pds sf_read_part(H3270 *hSession, unsigned char buf[], unsigned bufl
 			trace_ds(hSession,"Equivlent+List(");
 			for (i = 6; i < buflen; i++) {
 				trace_ds(hSession,"%s%s", comma, see_qcode(buf[i]));
+#if defined(X3270_TRACE)
 				comma = ",";
+#endif
 			}
 			trace_ds(hSession,")\n");
 			for (i = 0; i < NSR; i++)
@@ -416,7 +435,9 @@ static enum pds sf_erase_reset(H3270 *hSession, unsigned char buf[], int buflen)
 static enum pds sf_set_reply_mode(H3270 *hSession, unsigned char buf[], int buflen) {
 	unsigned char partition;
 	int i;
+#if defined(X3270_TRACE)
 	const char *comma = "(";
+#endif
 
 	if (buflen < 5) {
 		trace_ds(hSession," error: wrong field length %d\n", buflen);
@@ -455,7 +476,9 @@ static enum pds sf_set_reply_mode(H3270 *hSession, unsigned char buf[], int bufl
 		for (i = 5; i < buflen; i++) {
 			hSession->crm_attr[i - 5] = buf[i];
 			trace_ds(hSession,"%s%s", comma, see_efa_only(buf[i]));
+#if defined(X3270_TRACE)
 			comma = ",";
+#endif
 		}
 		trace_ds(hSession,"%s\n", hSession->crm_nattr ? ")" : "");
 	}
@@ -466,7 +489,9 @@ static enum pds sf_create_partition(H3270 *hSession, unsigned char buf[], int bu
 	unsigned char pid;
 	unsigned char uom;		/* unit of measure */
 	unsigned char am;		/* addressing mode */
+#if defined(X3270_TRACE)
 	unsigned char flags;	/* flags */
+#endif
 	unsigned short h;		/* height of presentation space */
 	unsigned short w;		/* width of presentation space */
 	unsigned short rv;		/* viewport origin row */
@@ -520,11 +545,13 @@ static enum pds sf_create_partition(H3270 *hSession, unsigned char buf[], int bu
 		am = 0;
 	}
 
+#if defined(X3270_TRACE)
 	if (buflen > 5) {
 		flags = buf[5];
 		trace_ds(hSession,",flags=0x%02x", flags);
 	} else
 		flags = 0;
+#endif
 
 	if (buflen > 7) {
 		GET16(h, &buf[6]);
@@ -663,10 +690,60 @@ static void query_reply_start(H3270 *hSession) {
 	qr_in_progress = True;
 }
 
+void query_reply_reset(H3270 *hSession) {
+
+	struct _lib3270_query_replies * cache = hSession->query_replies;
+
+	if(cache) {
+		size_t i;
+
+		hSession->query_replies = NULL;
+		for (i = 0; i < NSR_ALL; i++)
+			lib3270_free(cache->reply[i].data);
+		lib3270_free(cache);
+	}
+
+}
+
+void query_reply_drop(H3270 *hSession, unsigned char code) {
+
+	size_t i;
+
+	if(!hSession->query_replies)
+		return;
+
+	for (i = 0; i < NSR_ALL; i++) {
+		if (replies[i].code == code) {
+			lib3270_free(hSession->query_replies->reply[i].data);
+			hSession->query_replies->reply[i].data = NULL;
+			hSession->query_replies->reply[i].length = 0;
+			break;
+		}
+	}
+
+}
+
+/// @brief Store a query reply built by do_query_reply().
+static void query_reply_store(H3270 *hSession, size_t i, const unsigned char *data, size_t length) {
+
+	if(!hSession->query_replies) {
+		hSession->query_replies = lib3270_malloc(sizeof(struct _lib3270_query_replies));
+		memset(hSession->query_replies,0,sizeof(struct _lib3270_query_replies));
+	}
+
+	lib3270_free(hSession->query_replies->reply[i].data);
+
+	hSession->query_replies->reply[i].data = lib3270_malloc(length);
+	hSession->query_replies->reply[i].length = length;
+	memcpy(hSession->query_replies->reply[i].data,data,length);
+
+}
+
 static void do_query_reply(H3270 *hSession, unsigned char code) {
 	size_t i;
 	unsigned subindex = 0;
 	Boolean more = False;
+	int obptr_start;
 
 	/* Find the right entry in the reply table. */
 	for (i = 0; i < NSR_ALL; i++) {
@@ -682,6 +759,25 @@ static void do_query_reply(H3270 *hSession, unsigned char code) {
 		qr_in_progress = False;
 	}
 
+	if (hSession->query_replies && hSession->query_replies->reply[i].data && !lib3270_get_toggle(hSession,LIB3270_TOGGLE_DS_TRACE)) {
+
+		// Same configuration, send the reply built before.
+		size_t length = hSession->query_replies->reply[i].length;
+
+		space3270out(hSession,length);
+		memcpy(hSession->output.ptr,hSession->query_replies->reply[i].data,length);
+		hSession->output.ptr += length;
+
+#if defined(X3270_FT) /*[*/
+		if (code == QR_DDM)
+			hSession->dft_limit = hSession->dft_buffersize;
+#endif /*]*/
+
+		return;
+	}
+
+	obptr_start = hSession->output.ptr - hSession->output.buf;
+
 	do {
 		int obptr0 = hSession->output.ptr - hSession->output.buf;
 		Boolean full = True;
@@ -706,7 +802,7 @@ static void do_query_reply(H3270 *hSession, unsigned char code) {
 			len = (hSession->output.ptr - hSession->output.buf) - obptr0;
 			SET16(obptr_len, len);
 
-#ifdef DEBUG
+#if defined(DEBUG) && defined(X3270_TRACE)
 			if(lib3270_get_toggle(hSession,LIB3270_TOGGLE_DS_TRACE)) {
 				lib3270_trace_data(
 				    hSession,
@@ -715,13 +811,16 @@ static void do_query_reply(H3270 *hSession, unsigned char code) {
 				    len
 				);
 			}
-#endif // DEBUG
+#endif // DEBUG && X3270_TRACE
 
 		} else {
 			/* Back over the header. */
 			hSession->output.ptr -= 4;
 		}
 	} while (more);
+
+	if (replies[i].single_fn)
+		query_reply_store(hSession, i, hSession->output.buf + obptr_start, (hSession->output.ptr - hSession->output.buf) - obptr_start);
 }
 
 static void do_qr_null(H3270 *hSession) {
@@ -730,7 +829,9 @@ static void do_qr_null(H3270 *hSession) {
 
 static void do_qr_summary(H3270 *hSession) {
 	size_t i;
+#if defined(X3270_TRACE)
 	const char *comma = "";
+#endif
 
 	trace_ds(hSession,"> QueryReply(Summary(");
 	space3270out(hSession,NSR);
@@ -739,7 +840,9 @@ static void do_qr_summary(H3270 *hSession) {
 		if (dbcs || replies[i].code != QR_DBCS_ASIA) {
 #endif /*]*/
 			trace_ds(hSession,"%s%s", comma, see_qcode(replies[i].code));
+#if defined(X3270_TRACE)
 			comma = ",";
+#endif
 			*hSession->output.ptr++ = replies[i].code;
 #if defined(X3270_DBCS) /*[*/
 		}
@@ -935,7 +1038,8 @@ static void do_qr_charsets(H3270 *hSession) {
 
 #if defined(X3270_FT) /*[*/
 static void do_qr_ddm(H3270 *hSession) {
-	lib3270_set_dft_buffersize(hSession,hSession->dft_buffersize);
+	if (!hSession->dft_buffersize)
+		hSession->dft_buffersize = DFT_BUF;
 
 	trace_ds(hSession,"> QueryReply(DistributedDataManagement)\n");
 	space3270out(hSession,8);
@@ -943,6 +1047,9 @@ static void do_qr_ddm(H3270 *hSession) {
 	SET16(hSession->output.ptr, hSession->dft_buffersize);	/* set inbound length limit INLIM */
 	SET16(hSession->output.ptr, hSession->dft_buffersize);	/* set outbound length limit OUTLIM */
 	SET16(hSession->output.ptr, 0x0101);					/* NSS=01, DDMSS=01 */
+
+	/* The host will not accept larger records on this connection. */
+	hSession->dft_limit = hSession->dft_buffersize;
 }
 #endif /*]*/
 
@@ -0,0 +1,360 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como stats.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Data stream processing counters.
+ *
+ */
+
+#include <config.h>
+#include <internals.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <statsc.h>
+
+LIB3270_EXPORT unsigned long long lib3270_get_ticks(void) {
+	return stats_ticks();
+}
+
+LIB3270_EXPORT int lib3270_set_stage_timing(H3270 *hSession, int enable) {
+	hSession->stages.enabled = (enable ? 1 : 0);
+	return 0;
+}
+
+LIB3270_EXPORT int lib3270_get_stage_timing(const H3270 *hSession) {
+	return hSession->stages.enabled;
+}
+
+LIB3270_EXPORT int lib3270_get_stage_counters(const H3270 *hSession, LIB3270_STAGE_COUNTER *counters, size_t count) {
+
+	if(count > LIB3270_STAGE_COUNT)
+		return EINVAL;
+
+	memcpy(counters,hSession->stages.counters,count * sizeof(LIB3270_STAGE_COUNTER));
+	return 0;
+
+}
+
+LIB3270_EXPORT void lib3270_reset_stage_counters(H3270 *hSession) {
+	memset(hSession->stages.counters,0,sizeof(hSession->stages.counters));
+}
+
+LIB3270_EXPORT const char * lib3270_get_stage_name(LIB3270_STAGE stage) {
+
+	static const char * names[LIB3270_STAGE_COUNT] = {
+		"telnet",
+		"process_ds",
+		"ctlr_write",
+		"screen_update"
+	};
+
+	if(stage < LIB3270_STAGE_COUNT)
+		return names[stage];
+
+	errno = EINVAL;
+	return "";
+
+}
+
+/*---[ Counters ]-------------------------------------------------------------------------------------------*/
+
+/// @brief Upper bound of the first histogram bucket (in microseconds), doubles on each bucket.
+#define HISTOGRAM_FIRST_BOUND	10ULL
+
+LIB3270_EXPORT unsigned long long lib3270_get_histogram_bound(size_t bucket) {
+
+	if(bucket >= (LIB3270_HISTOGRAM_BUCKETS-1))
+		return 0;
+
+	return HISTOGRAM_FIRST_BOUND << bucket;
+}
+
+void stats_histogram(LIB3270_HISTOGRAM *histogram, unsigned long long value) {
+
+	size_t				bucket	= 0;
+	unsigned long long	bound	= HISTOGRAM_FIRST_BOUND;
+
+	while(bucket < (LIB3270_HISTOGRAM_BUCKETS-1) && value > bound) {
+		bound <<= 1;
+		bucket++;
+	}
+
+	stats_add(histogram->buckets[bucket],1);
+	stats_add(histogram->sum,value);
+	stats_add(histogram->count,1);
+
+}
+
+static void load_histogram(LIB3270_HISTOGRAM *dst, const LIB3270_HISTOGRAM *src) {
+
+	size_t bucket;
+
+	// Buckets first, so the count never exceeds their total.
+	for(bucket = 0; bucket < LIB3270_HISTOGRAM_BUCKETS; bucket++)
+		dst->buckets[bucket] = __atomic_load_n(&src->buckets[bucket],__ATOMIC_RELAXED);
+
+	dst->sum = __atomic_load_n(&src->sum,__ATOMIC_RELAXED);
+	dst->count = __atomic_load_n(&src->count,__ATOMIC_RELAXED);
+
+}
+
+LIB3270_EXPORT int lib3270_get_stats(const H3270 *hSession, LIB3270_STATS *stats) {
+
+	const LIB3270_STATS *counters = &hSession->stats.counters;
+
+	stats->bytes_received	= __atomic_load_n(&counters->bytes_received,__ATOMIC_RELAXED);
+	stats->bytes_sent		= __atomic_load_n(&counters->bytes_sent,__ATOMIC_RELAXED);
+	stats->records_received	= __atomic_load_n(&counters->records_received,__ATOMIC_RELAXED);
+	stats->records_sent		= __atomic_load_n(&counters->records_sent,__ATOMIC_RELAXED);
+	stats->connects			= __atomic_load_n(&counters->connects,__ATOMIC_RELAXED);
+	stats->reconnects		= stats->connects ? stats->connects - 1 : 0;
+	stats->typeahead		= __atomic_load_n(&counters->typeahead,__ATOMIC_RELAXED);
+	stats->typeahead_max	= __atomic_load_n(&counters->typeahead_max,__ATOMIC_RELAXED);
+	stats->typeahead_dropped = __atomic_load_n(&counters->typeahead_dropped,__ATOMIC_RELAXED);
+
+	load_histogram(&stats->response,&counters->response);
+	load_histogram(&stats->process_ds,&counters->process_ds);
+	load_histogram(&stats->screen_update,&counters->screen_update);
+	load_histogram(&stats->tls_handshake,&counters->tls_handshake);
+
+	return 0;
+}
+
+static void reset_histogram(LIB3270_HISTOGRAM *histogram) {
+
+	size_t bucket;
+
+	// Count first, so it never exceeds the total of the buckets.
+	stats_set(histogram->count,0);
+	stats_set(histogram->sum,0);
+
+	for(bucket = 0; bucket < LIB3270_HISTOGRAM_BUCKETS; bucket++)
+		stats_set(histogram->buckets[bucket],0);
+
+}
+
+LIB3270_EXPORT void lib3270_reset_stats(H3270 *hSession) {
+
+	LIB3270_STATS *counters = &hSession->stats.counters;
+
+	stats_set(counters->bytes_received,0);
+	stats_set(counters->bytes_sent,0);
+	stats_set(counters->records_received,0);
+	stats_set(counters->records_sent,0);
+	stats_set(counters->connects,0);
+	stats_set(counters->reconnects,0);
+	stats_set(counters->typeahead_dropped,0);
+
+	// Keep the current queue depth, it's a gauge.
+	stats_set(counters->typeahead_max,__atomic_load_n(&counters->typeahead,__ATOMIC_RELAXED));
+
+	reset_histogram(&counters->response);
+	reset_histogram(&counters->process_ds);
+	reset_histogram(&counters->screen_update);
+	reset_histogram(&counters->tls_handshake);
+
+}
+
+/*---[ AID spans ]------------------------------------------------------------------------------------------*/
+
+void span_begin(H3270 *hSession, unsigned char aid) {
+
+	LIB3270_AID_SPAN *span = &hSession->spans.current;
+
+	memset(span,0,sizeof(LIB3270_AID_SPAN));
+
+	span->aid = aid;
+	span->sent = stats_clock();
+
+	// Keep the current counters, span_end() converts them to deltas.
+	span->bytes_sent = hSession->stats.counters.bytes_sent;
+	span->bytes_received = hSession->stats.counters.bytes_received;
+
+}
+
+void span_end(H3270 *hSession) {
+
+	LIB3270_AID_SPAN	* span = &hSession->spans.current;
+	size_t				  head;
+
+	span->unlocked = stats_clock();
+
+	if(span->host_unlock)
+		span->unlock_delay = span->unlocked - span->host_unlock;
+	else
+		span->host_unlock = span->unlocked;
+
+	span->latency = span->unlocked - span->sent;
+	if(hSession->spans.exclude_delay)
+		span->latency -= span->unlock_delay;
+
+	span->bytes_sent = hSession->stats.counters.bytes_sent - span->bytes_sent;
+	span->bytes_received = hSession->stats.counters.bytes_received - span->bytes_received;
+
+	stats_histogram(&hSession->stats.counters.response,span->latency);
+
+	// Single producer queue, drop the span if the reader is behind.
+	head = hSession->spans.head;
+	if(head - __atomic_load_n(&hSession->spans.tail,__ATOMIC_ACQUIRE) < LIB3270_AID_SPAN_QUEUE) {
+		hSession->spans.queue[head % LIB3270_AID_SPAN_QUEUE] = *span;
+		__atomic_store_n(&hSession->spans.head,head+1,__ATOMIC_RELEASE);
+	}
+
+	if(hSession->spans.handler)
+		hSession->spans.handler(hSession,span,hSession->spans.userdata);
+
+	span_abort(hSession);
+
+}
+
+LIB3270_EXPORT void lib3270_set_aid_span_handler(H3270 *hSession, LIB3270_AID_SPAN_HANDLER handler, void *userdata) {
+	hSession->spans.handler = handler;
+	hSession->spans.userdata = userdata;
+}
+
+LIB3270_EXPORT size_t lib3270_get_aid_spans(H3270 *hSession, LIB3270_AID_SPAN *spans, size_t count) {
+
+	size_t tail = hSession->spans.tail;
+	size_t head = __atomic_load_n(&hSession->spans.head,__ATOMIC_ACQUIRE);
+	size_t ix;
+
+	for(ix = 0; ix < count && tail != head; ix++)
+		spans[ix] = hSession->spans.queue[(tail++) % LIB3270_AID_SPAN_QUEUE];
+
+	__atomic_store_n(&hSession->spans.tail,tail,__ATOMIC_RELEASE);
+
+	return ix;
+}
+
+LIB3270_EXPORT int lib3270_set_exclude_unlock_delay(H3270 *hSession, int enable) {
+	hSession->spans.exclude_delay = (enable ? 1 : 0);
+	return 0;
+}
+
+LIB3270_EXPORT int lib3270_get_exclude_unlock_delay(const H3270 *hSession) {
+	return hSession->spans.exclude_delay;
+}
+
+/*---[ Prometheus ]-----------------------------------------------------------------------------------------*/
+
+struct text {
+	size_t	  length;
+	size_t	  size;
+	char	* str;
+};
+
+static void append(struct text *text, const char *fmt, ...) LIB3270_AS_PRINTF(2,3);
+
+static void append(struct text *text, const char *fmt, ...) {
+
+	va_list args;
+
+	for(;;) {
+
+		va_start(args, fmt);
+		int len = vsnprintf(text->str+text->length,text->size-text->length,fmt,args);
+		va_end(args);
+
+		if(len < 0)
+			return;
+
+		if(((size_t) len) < (text->size-text->length)) {
+			text->length += len;
+			return;
+		}
+
+		text->size += ((size_t) len) + 4096;
+		text->str = lib3270_realloc(text->str,text->size);
+
+	}
+
+}
+
+static void append_counter(struct text *text, const char *labels, const char *name, const char *type, const char *help, unsigned long long value) {
+	append(text,"# HELP lib3270_%s %s\n# TYPE lib3270_%s %s\n",name,help,name,type);
+	append(text,"lib3270_%s%s%s%s %llu\n",name,*labels ? "{" : "",labels,*labels ? "}" : "",value);
+}
+
+static void append_histogram(struct text *text, const char *labels, const char *name, const char *help, const LIB3270_HISTOGRAM *histogram) {
+
+	unsigned long long	total = 0;
+	size_t				bucket;
+
+	append(text,"# HELP lib3270_%s_seconds %s\n# TYPE lib3270_%s_seconds histogram\n",name,help,name);
+
+	for(bucket = 0; bucket < LIB3270_HISTOGRAM_BUCKETS; bucket++) {
+
+		unsigned long long bound = lib3270_get_histogram_bound(bucket);
+
+		total += histogram->buckets[bucket];
+
+		if(bound) {
+			append(text,"lib3270_%s_seconds_bucket{%s%sle=\"%g\"} %llu\n",name,labels,*labels ? "," : "",bound / 1e6,total);
+		} else {
+			append(text,"lib3270_%s_seconds_bucket{%s%sle=\"+Inf\"} %llu\n",name,labels,*labels ? "," : "",total);
+		}
+
+	}
+
+	append(text,"lib3270_%s_seconds_sum%s%s%s %g\n",name,*labels ? "{" : "",labels,*labels ? "}" : "",histogram->sum / 1e6);
+	append(text,"lib3270_%s_seconds_count%s%s%s %llu\n",name,*labels ? "{" : "",labels,*labels ? "}" : "",total);
+
+}
+
+LIB3270_EXPORT char * lib3270_get_stats_prometheus(const H3270 *hSession, const char *labels) {
+
+	LIB3270_STATS	stats;
+	struct text		text = { .length = 0, .size = 4096 };
+
+	if(!labels)
+		labels = "";
+
+	lib3270_get_stats(hSession,&stats);
+
+	text.str = lib3270_malloc(text.size);
+	*text.str = 0;
+
+	append_counter(&text,labels,"received_bytes_total","counter","Bytes received from host.",stats.bytes_received);
+	append_counter(&text,labels,"sent_bytes_total","counter","Bytes sent to host.",stats.bytes_sent);
+	append_counter(&text,labels,"received_records_total","counter","Records received from host.",stats.records_received);
+	append_counter(&text,labels,"sent_records_total","counter","Records sent to host.",stats.records_sent);
+	append_counter(&text,labels,"connects_total","counter","Connections to host.",stats.connects);
+	append_counter(&text,labels,"reconnects_total","counter","Connections to host after the first one.",stats.reconnects);
+	append_counter(&text,labels,"typeahead_depth","gauge","Actions waiting on the typeahead queue.",stats.typeahead);
+	append_counter(&text,labels,"typeahead_depth_max","gauge","Maximum typeahead queue depth.",stats.typeahead_max);
+	append_counter(&text,labels,"typeahead_dropped_total","counter","Actions dropped because the typeahead queue was full.",stats.typeahead_dropped);
+
+	append_histogram(&text,labels,"response","Host response time, from AID to keyboard unlock.",&stats.response);
+	append_histogram(&text,labels,"process_ds","Time processing host commands.",&stats.process_ds);
+	append_histogram(&text,labels,"screen_update","Time updating the screen.",&stats.screen_update);
+	append_histogram(&text,labels,"tls_handshake","TLS/SSL negotiation time.",&stats.tls_handshake);
+
+	return text.str;
+
+}
@@ -95,6 +95,7 @@
 // #include "proxyc.h"
 //#include "resolverc.h"
 #include "statusc.h"
+#include "statsc.h"
 // #include "tablesc.h"
 #include "telnetc.h"
 #include "trace_dsc.h"
@@ -139,6 +140,7 @@ static void continue_tls(H3270 *hSession, unsigned char *sbbuf, int len);
 static int tn3270e_negotiate(H3270 *hSession);
 #endif /*]*/
 static int process_eor(H3270 *hSession);
+static int process_record(H3270 *hSession);
 #if defined(X3270_TN3270E) /*[*/
 #if defined(X3270_TRACE) /*[*/
 static const char *tn3270e_function_names(const unsigned char *, int);
@@ -208,13 +210,11 @@ static const char *reason_code[8] = { "CONN-PARTNER", "DEVICE-IN-USE",
                                     };
 #define rsn(n)	(((n) <= TN3270E_REASON_UNSUPPORTED_REQ) ? \
 			reason_code[(n)] : "??")
-#endif /*]*/
 static const char *function_name[5] = { "BIND-IMAGE", "DATA-STREAM-CTL",
                                         "RESPONSES", "SCS-CTL-CODES", "SYSREQ"
                                       };
 #define fnn(n)	(((n) <= TN3270E_FUNC_SYSREQ) ? \
 			function_name[(n)] : "??")
-#if defined(X3270_TRACE) /*[*/
 static const char *data_type[9] = { "3270-DATA", "SCS-DATA", "RESPONSE",
                                     "BIND-IMAGE", "UNBIND", "NVT-DATA", "REQUEST", "SSCP-LU-DATA",
                                     "PRINT-EOJ"
@@ -425,6 +425,7 @@ LIB3270_EXPORT void lib3270_setup_session(H3270 *hSession) {
 	hSession->tn3270e_negotiated = 0;
 	hSession->tn3270e_submode = E_NONE;
 	hSession->tn3270e_bound = 0;
+	hSession->dft_limit = 0;
 
 	setup_lus(hSession);
 
@@ -470,6 +471,9 @@ void net_disconnect(H3270 *hSession) {
 
 	hSession->network.module->disconnect(hSession);
 
+	// Drop the coalesced output, there's no one to receive it.
+	hSession->network.cork.length = 0;
+
 	trace_dsn(hSession,"SENT disconnect\n");
 
 	// We're not connected to an LU any more.
@@ -480,16 +484,39 @@ void net_disconnect(H3270 *hSession) {
 
 LIB3270_EXPORT void lib3270_data_recv(H3270 *hSession, size_t nr, const unsigned char *netrbuf) {
 	register const unsigned char * cp;
+	unsigned long long started = stage_begin(hSession);
 
 //	trace("%s: nr=%d",__FUNCTION__,(int) nr);
 
 	trace_netdata(hSession, '<', netrbuf, nr);
+	trace_binary(hSession, LIB3270_BINARY_TRACE_DATA, '<', netrbuf, nr);
 
 	hSession->ns_brcvd += nr;
+	stats_add(hSession->stats.counters.bytes_received,nr);
+
+#if defined(X3270_ANSI)
+	const unsigned char * iac = memchr(netrbuf,IAC,nr);
+#endif // X3270_ANSI
+
 	for (cp = netrbuf; cp < (netrbuf + nr); cp++) {
+
+#if defined(X3270_ANSI)
+		// Plain NVT text goes to the screen in runs, without the state machines.
+		if (hSession->telnet_state == TNS_DATA && IN_ANSI && !IN_E && !hSession->syncing && !trace_enabled(hSession,LIB3270_TOGGLE_DS_TRACE)) {
+
+			if (iac && iac < cp)
+				iac = memchr(cp,IAC,(netrbuf + nr) - cp);
+
+			cp += ansi_process_text(hSession,cp,(iac ? iac : (netrbuf + nr)) - cp);
+			if (cp >= (netrbuf + nr))
+				break;
+		}
+#endif // X3270_ANSI
+
 		if(telnet_fsm(hSession,*cp)) {
 			(void) ctlr_dbcs_postprocess(hSession);
 			host_disconnect(hSession,True);
+			stage_end(hSession,LIB3270_STAGE_TELNET,started);
 			return;
 		}
 	}
@@ -504,6 +531,8 @@ LIB3270_EXPORT void lib3270_data_recv(H3270 *hSession, size_t nr, const unsigned
 		hSession->ansi_data = 0;
 	}
 #endif // X3270_ANSI
+
+	stage_end(hSession,LIB3270_STAGE_TELNET,started);
 }
 
 /**
@@ -547,6 +576,9 @@ void net_input(H3270 *hSession, int GNUC_UNUSED(fd), LIB3270_IO_FLAG GNUC_UNUSED
 
 		debug("%s: recv=%d",__FUNCTION__,nr);
 
+		if(nr > 0 && hSession->network.profile == LIB3270_NETWORK_PROFILE_LATENCY)
+			lib3270_network_quickack(hSession);
+
 		if (nr < 0) {
 			if (nr == -EWOULDBLOCK) {
 				return;
@@ -719,6 +751,7 @@ static int telnet_fsm(H3270 *hSession, unsigned char c) {
 
 			if (IN_3270 || (IN_E && hSession->tn3270e_negotiated)) {
 				hSession->ns_rrcvd++;
+				stats_add(hSession->stats.counters.records_received,1);
 				if (process_eor(hSession))
 					return -1;
 			} else {
@@ -881,7 +914,7 @@ static int telnet_fsm(H3270 *hSession, unsigned char c) {
 				          opt(TELOPT_STARTTLS),
 				          cmd(SE));
 
-				debug("%s: %s requires TLS/SSL",__FUNCTION__,opt(TELOPT_STARTTLS));
+				debug("%s: START-TLS requires TLS/SSL",__FUNCTION__);
 				hSession->need_tls_follows = 1;
 			}
 			break;
@@ -1001,6 +1034,10 @@ static void continue_tls(H3270 *hSession, unsigned char *sbbuf, int len) {
 	trace_dsn(hSession,"%s FOLLOWS %s\n", opt(TELOPT_STARTTLS), cmd(SE));
 
 	hSession->ssl.host = 1;	// Set host type as SSL.
+
+	// Anything still corked must go out before the handshake.
+	net_flush(hSession);
+
 	if(lib3270_start_tls(hSession)) {
 		lib3270_disconnect(hSession);
 		return;
@@ -1056,7 +1093,7 @@ static void tn3270e_request(H3270 *hSession) {
 /*
  * Back off of TN3270E.
  */
-static void backoff_tn3270e(H3270 *hSession, const char *why) {
+static void backoff_tn3270e(H3270 *hSession, const char GNUC_UNUSED(*why)) {
 	trace_dsn(hSession,"Aborting TN3270E: %s\n", why);
 
 	/* Tell the host 'no'. */
@@ -1340,12 +1377,28 @@ static void process_bind(H3270 *hSession, unsigned char *buf, int buflen) {
 #endif /*]*/
 
 static int process_eor(H3270 *hSession) {
+	int rc;
 
 	trace("%s: syncing=%s",__FUNCTION__,hSession->syncing ? "Yes" : "No");
 
 	if (hSession->syncing || !(hSession->ibptr - hSession->ibuf))
 		return(0);
 
+	span_record(hSession);
+
+	// Coalesce the responses generated by this record (TN3270E ACK/NAK followed by data).
+	net_cork(hSession);
+	rc = process_record(hSession);
+	net_uncork(hSession);
+
+	// The screen may have the text a macro is waiting for.
+	lib3270_macro_wakeup(hSession);
+
+	return rc;
+}
+
+static int process_record(H3270 *hSession) {
+
 #if defined(X3270_TN3270E) /*[*/
 	if (IN_E) {
 		tn3270e_header *h = (tn3270e_header *) hSession->ibuf;
@@ -1462,7 +1515,7 @@ LIB3270_INTERNAL int lib3270_sock_send(H3270 *hSession, unsigned const char *buf
 }
 
 /**
- * @brief Send out raw telnet data.
+ * @brief Write data to the network.
  *
  * We assume that there will always be enough space to buffer what we want to transmit,
  * so we don't handle EAGAIN or EWOULDBLOCK.
@@ -1472,8 +1525,7 @@ LIB3270_INTERNAL int lib3270_sock_send(H3270 *hSession, unsigned const char *buf
  * @param len		Buffer length
  *
  */
-static void net_rawout(H3270 *hSession, unsigned const char *buf, size_t len) {
-	trace_netdata(hSession, '>', buf, len);
+static void net_send(H3270 *hSession, unsigned const char *buf, size_t len) {
 
 	while (len) {
 		int nw = lib3270_sock_send(hSession,buf,len);
@@ -1481,6 +1533,7 @@ static void net_rawout(H3270 *hSession, unsigned const char *buf, size_t len) {
 		if (nw > 0) {
 			// Data sent
 			hSession->ns_bsent += nw;
+			stats_add(hSession->stats.counters.bytes_sent,nw);
 			len -= nw;
 			buf += nw;
 		} else if(nw < 0) {
@@ -1490,6 +1543,83 @@ static void net_rawout(H3270 *hSession, unsigned const char *buf, size_t len) {
 	}
 }
 
+/**
+ * @brief Send out raw telnet data.
+ *
+ * While the output is corked the data is appended to the pending buffer
+ * and sent in a single write by net_uncork().
+ *
+ * @param hSession	Session handle.
+ * @param buf		Buffer to send.
+ * @param len		Buffer length
+ *
+ */
+static void net_rawout(H3270 *hSession, unsigned const char *buf, size_t len) {
+	trace_netdata(hSession, '>', buf, len);
+	trace_binary(hSession, LIB3270_BINARY_TRACE_DATA, '>', buf, len);
+
+	if(!hSession->network.cork.level) {
+		net_send(hSession,buf,len);
+		return;
+	}
+
+	if(hSession->network.cork.length + len > hSession->network.cork.size) {
+		while(hSession->network.cork.length + len > hSession->network.cork.size)
+			hSession->network.cork.size += BUFSZ;
+		hSession->network.cork.buffer = lib3270_realloc(hSession->network.cork.buffer,hSession->network.cork.size);
+	}
+
+	memcpy(hSession->network.cork.buffer+hSession->network.cork.length,buf,len);
+	hSession->network.cork.length += len;
+
+}
+
+/**
+ * @brief Start coalescing network output.
+ *
+ * Calls can be nested; the output is sent when the outermost net_uncork() is called.
+ *
+ * @param hSession	Session handle.
+ *
+ */
+void net_cork(H3270 *hSession) {
+	hSession->network.cork.level++;
+}
+
+/**
+ * @brief Send the output buffered since the first net_cork().
+ *
+ * @param hSession	Session handle.
+ *
+ */
+void net_uncork(H3270 *hSession) {
+
+	if(!hSession->network.cork.level || --hSession->network.cork.level)
+		return;
+
+	net_flush(hSession);
+
+}
+
+/**
+ * @brief Send pending output now, even if corked.
+ *
+ * @param hSession	Session handle.
+ *
+ */
+void net_flush(H3270 *hSession) {
+
+	size_t length = hSession->network.cork.length;
+
+	if(!length)
+		return;
+
+	// Reset first, a send failure will disconnect and drop the pending output.
+	hSession->network.cork.length = 0;
+	net_send(hSession,hSession->network.cork.buffer,length);
+
+}
+
 #if defined(X3270_ANSI)
 
 /**
@@ -2002,9 +2132,12 @@ static const char * opt(unsigned char c) {
 
 #define LINEDUMP_MAX	32
 
+#undef trace_netdata
 void trace_netdata(H3270 *hSession, char direction, unsigned const char *buf, int len) {
 #define NETDUMP_MAX 121
 
+	static const char hexdigits[] = "0123456789abcdef";
+
 	if (lib3270_get_toggle(hSession,LIB3270_TOGGLE_NETWORK_TRACE)) {
 		char l1[NETDUMP_MAX+2];
 		char l2[NETDUMP_MAX+2];
@@ -2028,14 +2161,11 @@ void trace_netdata(H3270 *hSession, char direction, unsigned const char *buf, in
 		lib3270_write_nettrace(hSession,"%c %s %s data len=%d\n\n",direction,l1,direction == '>' ? "SEND" : "RECV", len);
 
 		for (offset = 0; offset < len; offset++) {
-			unsigned char text[4];
+			unsigned char chr = hSession->charset.ebc2asc[buf[offset]];
 
-			text[0] = hSession->charset.ebc2asc[buf[offset]];
-			l1[col] = (text[0] >= ' ' ? text[0] : '.');
-
-			snprintf((char *) text,4,"%02x",buf[offset]);
-			l2[col] = text[0];
-			l3[col] = text[1];
+			l1[col] = (chr >= ' ' ? chr : '.');
+			l2[col] = hexdigits[buf[offset] >> 4];
+			l3[col] = hexdigits[buf[offset] & 0x0f];
 
 			if(++col >= NETDUMP_MAX) {
 				l1[col] = l2[col] = l3[col] = 0;
@@ -2063,10 +2193,20 @@ void trace_netdata(H3270 *hSession, char direction, unsigned const char *buf, in
 		}
 
 		hSession->ds_ts = ts;
-		for (offset = 0; offset < len; offset++) {
-			if (!(offset % LINEDUMP_MAX))
-				trace_dsn(hSession,"%s%c 0x%-3x ",(offset ? "\n" : ""), direction, offset);
-			trace_dsn(hSession,"%02x", buf[offset]);
+
+		// Emit one trace message per line instead of one per byte.
+		for (offset = 0; offset < len; offset += LINEDUMP_MAX) {
+			char	hex[(LINEDUMP_MAX * 2) + 1];
+			int		count = (len - offset) < LINEDUMP_MAX ? (len - offset) : LINEDUMP_MAX;
+			int		ix;
+
+			for(ix = 0; ix < count; ix++) {
+				hex[ix*2]		= hexdigits[buf[offset+ix] >> 4];
+				hex[(ix*2)+1]	= hexdigits[buf[offset+ix] & 0x0f];
+			}
+			hex[count*2] = 0;
+
+			trace_dsn(hSession,"%s%c 0x%-3x %s",(offset ? "\n" : ""), direction, offset, hex);
 		}
 		trace_dsn(hSession,"\n");
 	}
@@ -2098,6 +2238,9 @@ void net_output(H3270 *hSession) {
 #define BSTART	obuf
 #endif
 
+	// The TN3270E response and the data record should go out in a single write.
+	net_cork(hSession);
+
 #if defined(X3270_TN3270E) /*[*/
 	/* Set the TN3720E header. */
 	if (IN_TN3270E || IN_SSCP) {
@@ -2148,6 +2291,9 @@ void net_output(H3270 *hSession) {
 
 	trace_dsn(hSession,"SENT EOR\n");
 	hSession->ns_rsent++;
+	stats_add(hSession->stats.counters.records_sent,1);
+
+	net_uncork(hSession);
 #undef BSTART
 }
 
@@ -2184,7 +2330,9 @@ static void tn3270e_nak(H3270 *hSession, enum pds rv) {
 	unsigned char rsp_buf[10];
 	tn3270e_header *h_in = (tn3270e_header *) hSession->ibuf;
 	int rsp_len = 0;
+#if defined(X3270_TRACE)
 	char *neg = NULL;
+#endif
 
 	rsp_buf[rsp_len++] = TN3270E_DT_RESPONSE;	    /* data_type */
 	rsp_buf[rsp_len++] = 0;				    /* request_flag */
@@ -2199,11 +2347,15 @@ static void tn3270e_nak(H3270 *hSession, enum pds rv) {
 	default:
 	case PDS_BAD_CMD:
 		rsp_buf[rsp_len++] = TN3270E_NEG_COMMAND_REJECT;
+#if defined(X3270_TRACE)
 		neg = "COMMAND-REJECT";
+#endif
 		break;
 	case PDS_BAD_ADDR:
 		rsp_buf[rsp_len++] = TN3270E_NEG_OPERATION_CHECK;
+#if defined(X3270_TRACE)
 		neg = "OPERATION-CHECK";
+#endif
 		break;
 	}
 	rsp_buf[rsp_len++] = IAC;
@@ -38,6 +38,7 @@
 #include <lib3270/toggle.h>
 #include <lib3270/log.h>
 #include "togglesc.h"
+#include "trace_dsc.h"
 
 /*---[ Implement ]------------------------------------------------------------------------------------------------------------*/
 
@@ -57,6 +58,8 @@ LIB3270_EXPORT unsigned char lib3270_get_toggle(const H3270 *hSession, LIB3270_T
 static void toggle_notify(H3270 *session, struct lib3270_toggle *t, LIB3270_TOGGLE_ID ix) {
 	trace("%s: ix=%d upcall=%p",__FUNCTION__,ix,t->upcall);
 
+	trace_update_mask(session);
+
 	t->upcall(session, t, LIB3270_TOGGLE_TYPE_INTERACTIVE);
 
 	if(session->cbk.update_toggle)
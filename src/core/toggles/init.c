@@ -234,6 +234,8 @@ void initialize_toggles(H3270 *session) {
 	}
 #endif // _WIN32
 
+	trace_update_mask(session);
+
 	// Initialize upcalls.
 	for(f=0; f<LIB3270_TOGGLE_COUNT; f++) {
 		if(session->toggle[f].value)
@@ -245,7 +247,7 @@ void initialize_toggles(H3270 *session) {
 /**
  * @brief Called from system exit code to handle toggles.
  */
-void shutdown_toggles(H3270 *session) {
+void shutdown_toggles(H3270 GNUC_UNUSED(*session)) {
 #if defined(X3270_TRACE)
 	static const LIB3270_TOGGLE_ID disable_on_shutdown[] = {LIB3270_TOGGLE_DS_TRACE, LIB3270_TOGGLE_EVENT_TRACE, LIB3270_TOGGLE_SCREEN_TRACE};
 
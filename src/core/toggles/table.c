@@ -36,6 +36,7 @@
 #include <config.h>
 #include <internals.h>
 #include <lib3270/toggle.h>
+#include <lib3270/properties.h>
 #include "togglesc.h"
 #include "utilc.h"
 
@@ -369,7 +370,13 @@ LIB3270_EXPORT const char * lib3270_get_toggle_name(LIB3270_TOGGLE_ID ix) {
 
 LIB3270_EXPORT const LIB3270_TOGGLE * lib3270_toggle_get_by_name(const char *name) {
 	if(name) {
+		const LIB3270_RESOLVED_NAME * resolved = lib3270_find_name(name,LIB3270_NAME_TOGGLE);
 		int ix;
+
+		if(resolved)
+			return resolved->value.toggle;
+
+		// Check for partial names (for compatibility)
 		for(ix=0; ix<LIB3270_TOGGLE_COUNT; ix++) {
 			if(!lib3270_compare_alnum(name,toggle_descriptor[ix].name))
 				return &toggle_descriptor[ix];
@@ -380,7 +387,13 @@ LIB3270_EXPORT const LIB3270_TOGGLE * lib3270_toggle_get_by_name(const char *nam
 
 LIB3270_EXPORT LIB3270_TOGGLE_ID lib3270_get_toggle_id(const char *name) {
 	if(name) {
+		const LIB3270_RESOLVED_NAME * resolved = lib3270_find_name(name,LIB3270_NAME_TOGGLE);
 		int f;
+
+		if(resolved)
+			return resolved->value.toggle->id;
+
+		// Check for partial names (for compatibility)
 		for(f=0; f<LIB3270_TOGGLE_COUNT; f++) {
 			if(!lib3270_compare_alnum(name,toggle_descriptor[f].name))
 				return f;
@@ -0,0 +1,156 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como trace_binary.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Binary network trace.
+ *
+ * Records the raw network blocks with timestamp, direction and session; the
+ * text rendering is left to lib3270-tracedump.
+ *
+ */
+
+#include <config.h>
+#include <internals.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <lib3270/properties.h>
+#include <lib3270/trace.h>
+#include <trace_dsc.h>
+
+static void put_uint16(unsigned char *ptr, unsigned int value) {
+	ptr[0] = (unsigned char) (value & 0xff);
+	ptr[1] = (unsigned char) ((value >> 8) & 0xff);
+}
+
+static void put_uint32(unsigned char *ptr, unsigned long value) {
+	size_t ix;
+	for(ix = 0; ix < 4; ix++) {
+		ptr[ix] = (unsigned char) (value & 0xff);
+		value >>= 8;
+	}
+}
+
+static void put_uint64(unsigned char *ptr, unsigned long long value) {
+	size_t ix;
+	for(ix = 0; ix < 8; ix++) {
+		ptr[ix] = (unsigned char) (value & 0xff);
+		value >>= 8;
+	}
+}
+
+static LIB3270_BINARY_TRACE_HEADER header;
+
+static void binary_trace_header_init(void) {
+	put_uint16(header.version,LIB3270_BINARY_TRACE_VERSION);
+	put_uint16(header.record_size,sizeof(LIB3270_BINARY_TRACE_RECORD));
+	memcpy(header.magic,LIB3270_BINARY_TRACE_MAGIC,sizeof(header.magic));
+}
+
+static const LIB3270_BINARY_TRACE_HEADER * binary_trace_header(void) {
+
+	static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+	// Sessions on other threads can start tracing at the same time.
+	pthread_once(&once,binary_trace_header_init);
+
+	return &header;
+}
+
+void trace_binary_record(H3270 *hSession, LIB3270_BINARY_TRACE_TYPE type, char direction, const void *data, size_t length) {
+
+	LIB3270_BINARY_TRACE_RECORD	record;
+	struct timeval				tv;
+
+	gettimeofday(&tv,NULL);
+
+	put_uint32(record.length,(unsigned long) length);
+	record.type			= (unsigned char) type;
+	record.direction	= (unsigned char) direction;
+	record.id			= (unsigned char) hSession->id;
+	record.reserved		= 0;
+	put_uint32(record.serial,hSession->trace.binary.serial);
+	put_uint64(record.timestamp,(((unsigned long long) tv.tv_sec) * 1000000ULL) + tv.tv_usec);
+
+	trace_writer_write_record(hSession->trace.binary.writer,&record,sizeof(record),data,length);
+
+}
+
+void trace_binary_connect(H3270 *hSession) {
+
+	char		  model[40];
+	const char	* oversize = lib3270_get_oversize(hSession);
+	const char	* url = lib3270_get_url(hSession);
+
+	// The replay needs the screen size before the host data.
+	if(oversize)
+		snprintf(model,sizeof(model),"%u %s",lib3270_get_model_number(hSession),oversize);
+	else
+		snprintf(model,sizeof(model),"%u",lib3270_get_model_number(hSession));
+
+	trace_binary(hSession,LIB3270_BINARY_TRACE_MODEL,'>',model,strlen(model));
+	trace_binary(hSession,LIB3270_BINARY_TRACE_CONNECT,'>',url,url ? strlen(url) : 0);
+
+}
+
+LIB3270_EXPORT const char * lib3270_get_binary_trace_filename(const H3270 * hSession) {
+	return hSession->trace.binary.file;
+}
+
+LIB3270_EXPORT int lib3270_set_binary_trace_filename(H3270 * hSession, const char *filename) {
+
+	static unsigned int serial = 0;
+
+	if(hSession->trace.binary.writer) {
+		trace_writer_free(hSession->trace.binary.writer);
+		hSession->trace.binary.writer = NULL;
+	}
+
+	if(hSession->trace.binary.file) {
+		lib3270_free(hSession->trace.binary.file);
+		hSession->trace.binary.file = NULL;
+	}
+
+	if(filename && *filename) {
+
+		const LIB3270_BINARY_TRACE_HEADER * header = binary_trace_header();
+
+		if(!hSession->trace.binary.serial)
+			hSession->trace.binary.serial = __atomic_add_fetch(&serial,1,__ATOMIC_RELAXED);
+
+		hSession->trace.binary.file = lib3270_strdup(filename);
+		hSession->trace.binary.writer = trace_writer_new(filename,hSession->trace.max_size,header,sizeof(LIB3270_BINARY_TRACE_HEADER));
+
+		if(lib3270_is_connected(hSession))
+			trace_binary_connect(hSession);
+
+	}
+
+	return 0;
+
+}
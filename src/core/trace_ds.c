@@ -65,32 +65,47 @@
 /* Maximum size of a tracefile header. */
 #define MAX_HEADER_SIZE		(10*1024)
 
+/* Size of the stack buffer used to format trace messages. */
+#define TRACE_BUFFER_SIZE	1024
+
 
 #undef trace
 
+// The trace_dsc.h macros check the trace mask before calling these.
+#undef trace_ds
+#undef trace_ds_nb
+#undef trace_dsn
+#undef trace_ssl
+#undef trace_char
+#undef trace_screen
+#undef trace_ansi_disc
+
 /* Statics */
 static void	wtrace(H3270 *session, const char *fmt, ...);
 
 static void write_trace(const H3270 *session, const char *fmt, va_list args) {
 
 	// 'mount' message.
-	char *message = lib3270_vsprintf(fmt,args);
+	char	  buffer[TRACE_BUFFER_SIZE];
+	char	* message = lib3270_format_buffer(buffer,TRACE_BUFFER_SIZE,fmt,args);
+
+	if(!message)
+		return;
 
 	if(session->trace.file) {
 
-		// Has log file. Use it if possible.
-		FILE *f = fopen(session->trace.file, "a");
+		// Has trace file, send the message to the buffered writer.
+		if(!session->trace.writer)
+			((H3270 *) session)->trace.writer = trace_writer_new(session->trace.file,session->trace.max_size,NULL,0);
 
-		if(f) {
-			fprintf(f,"%s",message);
-			fclose(f);
-		}
+		trace_writer_write(session->trace.writer,message,strlen(message));
 
 	}
 
 	session->trace.handler(session,session->trace.userdata,message);
 
-	lib3270_free(message);
+	if(message != buffer)
+		lib3270_free(message);
 
 }
 
@@ -104,6 +119,29 @@ static void wtrace(H3270 *session, const char *fmt, ...) {
 	va_end(args);
 }
 
+void trace_update_mask(H3270 *hSession) {
+
+	static const LIB3270_TOGGLE_ID toggles[] = {
+		LIB3270_TOGGLE_DS_TRACE,
+		LIB3270_TOGGLE_SCREEN_TRACE,
+		LIB3270_TOGGLE_EVENT_TRACE,
+		LIB3270_TOGGLE_NETWORK_TRACE,
+		LIB3270_TOGGLE_SSL_TRACE
+	};
+
+	size_t			ix;
+	unsigned int	mask = 0;
+
+	for(ix = 0; ix < (sizeof(toggles)/sizeof(toggles[0])); ix++) {
+		if(hSession->toggle[toggles[ix]].value)
+			mask |= TRACE_MASK(toggles[ix]);
+	}
+
+	hSession->trace.mask = mask;
+
+}
+
+#if defined(X3270_TRACE)
 
 /* display a (row,col) */
 const char * rcba(H3270 *hSession, int baddr) {
@@ -152,6 +190,7 @@ static void trace_ds_s(H3270 *hSession, char *s, Boolean can_break) {
 }
 
 void trace_ds(H3270 *hSession, const char *fmt, ...) {
+	char	  buffer[TRACE_BUFFER_SIZE];
 	char	* text;
 	va_list   args;
 
@@ -161,15 +200,20 @@ void trace_ds(H3270 *hSession, const char *fmt, ...) {
 	va_start(args, fmt);
 
 	/* print out remainder of message */
-	text = lib3270_vsprintf(fmt,args);
-	trace_ds_s(hSession,text, True);
+	text = lib3270_format_buffer(buffer,TRACE_BUFFER_SIZE,fmt,args);
 	va_end(args);
-	lib3270_free(text);
+
+	if(text) {
+		trace_ds_s(hSession,text, True);
+		if(text != buffer)
+			lib3270_free(text);
+	}
 }
 
 void trace_ds_nb(H3270 *hSession, const char *fmt, ...) {
-	char *text;
-	va_list args;
+	char	  buffer[TRACE_BUFFER_SIZE];
+	char	* text;
+	va_list   args;
 
 	if (!lib3270_get_toggle(hSession,LIB3270_TOGGLE_DS_TRACE))
 		return;
@@ -177,9 +221,14 @@ void trace_ds_nb(H3270 *hSession, const char *fmt, ...) {
 	va_start(args, fmt);
 
 	/* print out remainder of message */
-	text = lib3270_vsprintf(fmt,args);
-	trace_ds_s(hSession, text, False);
-	lib3270_free(text);
+	text = lib3270_format_buffer(buffer,TRACE_BUFFER_SIZE,fmt,args);
+	va_end(args);
+
+	if(text) {
+		trace_ds_s(hSession, text, False);
+		if(text != buffer)
+			lib3270_free(text);
+	}
 }
 
 /**
@@ -212,6 +261,8 @@ void trace_ssl(H3270 *session, const char *fmt, ...) {
 	va_end(args);
 }
 
+#endif // X3270_TRACE
+
 LIB3270_EXPORT void lib3270_write_trace(H3270 *session, const char *fmt, ...) {
 	va_list args;
 
@@ -276,6 +327,8 @@ LIB3270_EXPORT void lib3270_trace_event(H3270 *session, const char *fmt, ...) {
 }
 
 
+#if defined(X3270_TRACE)
+
 /**
  * Screen trace function, called when the host clears the screen.
  *
@@ -333,6 +386,8 @@ void trace_ansi_disc(H3270 *hSession) {
 	hSession->trace_skipping = 1;
 }
 
+#endif // X3270_TRACE
+
 void lib3270_trace_data(H3270 *hSession, const char *msg, const unsigned char *data, size_t datalen) {
 	// 00000000001111111111222222222233333333334444444444555555555566666666667777777777
 	// 01234567890123456789012345678901234567890123456789012345678901234567890123456789
@@ -375,6 +430,11 @@ LIB3270_EXPORT const char * lib3270_get_trace_filename(const H3270 * hSession) {
 
 LIB3270_EXPORT int lib3270_set_trace_filename(H3270 * hSession, const char *filename) {
 
+	if(hSession->trace.writer) {
+		trace_writer_free(hSession->trace.writer);
+		hSession->trace.writer = NULL;
+	}
+
 	if(hSession->trace.file) {
 		lib3270_free(hSession->trace.file);
 	}
@@ -388,23 +448,30 @@ LIB3270_EXPORT int lib3270_set_trace_filename(H3270 * hSession, const char *file
 
 }
 
-static int def_trace(const H3270 *session, void GNUC_UNUSED(*userdata), const char *message) {
+LIB3270_EXPORT void lib3270_flush_trace(H3270 *hSession) {
+	if(hSession->trace.writer)
+		trace_writer_flush(hSession->trace.writer);
+}
 
-	if(session->log.file) {
+LIB3270_EXPORT unsigned int lib3270_get_trace_max_size(const H3270 *hSession) {
+	return (unsigned int) (hSession->trace.max_size / 1024);
+}
 
-		// Has log file. Use it if possible.
-		FILE *f = fopen(session->log.file, "a");
+LIB3270_EXPORT int lib3270_set_trace_max_size(H3270 *hSession, unsigned int kbytes) {
 
-		if(f) {
-			fprintf(f,"%s",message);
-			fclose(f);
-		}
+	hSession->trace.max_size = ((size_t) kbytes) * 1024;
 
-		return 0;
+	if(hSession->trace.writer)
+		trace_writer_set_max_size(hSession->trace.writer,hSession->trace.max_size);
 
-	}
+	if(hSession->trace.binary.writer)
+		trace_writer_set_max_size(hSession->trace.binary.writer,hSession->trace.max_size);
 
-	return -1;
+	return 0;
+}
+
+static int def_trace(const H3270 *session, void GNUC_UNUSED(*userdata), const char *message) {
+	return log_write_text(session,message,strlen(message));
 }
 
 LIB3270_EXPORT void lib3270_set_trace_handler(H3270 *hSession, LIB3270_TRACE_HANDLER handler, void *userdata) {
@@ -0,0 +1,520 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como trace_writer.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Buffered trace file writer.
+ *
+ * The producer (the session thread) only copies the formatted text into a ring
+ * buffer; a background thread keeps the trace file open and writes the pending
+ * data in batches, rotating the file when it reaches the configured size or age.
+ *
+ * Writers are shared by file name, sessions tracing to the same file use the
+ * same buffer so their messages are never mixed in the middle.
+ *
+ */
+
+#include <config.h>
+#include <internals.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <trace_dsc.h>
+
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif // !_WIN32
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif // HAVE_UNISTD_H
+
+/// @brief Size of the ring buffer.
+#define TRACE_WRITER_BUFFER		(256 * 1024)
+
+/// @brief Wake up the flusher when the buffer is this full.
+#define TRACE_WRITER_WATERMARK	(TRACE_WRITER_BUFFER / 2)
+
+/// @brief Maximum time (in ms) the data stays in the buffer.
+#define TRACE_WRITER_INTERVAL	200
+
+struct _trace_writer {
+
+	TRACE_WRITER	* next;					///< @brief Next writer on the shared list.
+	unsigned int	  refs;					///< @brief Number of sessions using this writer.
+
+	pthread_mutex_t	  mutex;
+	pthread_cond_t	  wakeup;				///< @brief Signals the flusher thread.
+	pthread_cond_t	  drained;				///< @brief Signals the producers (space available or data written).
+	pthread_t		  thread;
+
+	unsigned int	  started	: 1;		///< @brief Is the flusher thread running?
+	unsigned int	  stopping	: 1;		///< @brief Flusher thread should exit.
+	unsigned int	  flushing	: 1;		///< @brief Producer is waiting for a flush.
+
+	int				  fd;
+	char			* filename;
+	size_t			  max_size;				///< @brief Rotate the file when it reaches this size (0 = never).
+	size_t			  file_size;			///< @brief Current size of the file.
+	unsigned int	  interval;				///< @brief Rotate the file after this number of seconds (0 = never).
+	time_t			  opened;				///< @brief When the file was opened.
+
+	const void		* header;				///< @brief Data to write at the beginning of every new (binary) file.
+	size_t			  header_length;
+
+	size_t			  head;					///< @brief Total of bytes copied to the buffer.
+	size_t			  tail;					///< @brief Total of bytes written to the file.
+
+	unsigned char	  buffer[TRACE_WRITER_BUFFER];
+
+};
+
+/// @brief Writers in use.
+static struct {
+	pthread_mutex_t	  mutex;
+	TRACE_WRITER	* first;
+} writers = {
+	PTHREAD_MUTEX_INITIALIZER,
+	NULL
+};
+
+static int trace_writer_open(TRACE_WRITER *writer) {
+
+	struct stat st;
+	int flags = O_WRONLY|O_CREAT|O_APPEND;
+
+#ifdef O_BINARY
+	if(writer->header)
+		flags |= O_BINARY;
+#endif // O_BINARY
+
+	writer->fd = open(writer->filename, flags, 0644);
+	if(writer->fd < 0)
+		return errno;
+
+	writer->opened = time(NULL);
+
+	if(fstat(writer->fd,&st) == 0)
+		writer->file_size = (size_t) st.st_size;
+	else
+		writer->file_size = 0;
+
+	if(!writer->file_size && writer->header_length) {
+		if(write(writer->fd,writer->header,writer->header_length) == (ssize_t) writer->header_length)
+			writer->file_size = writer->header_length;
+	}
+
+	return 0;
+}
+
+static void trace_writer_rotate(TRACE_WRITER *writer) {
+
+	size_t	  sz = strlen(writer->filename) + 3;
+	char	* backup = lib3270_malloc(sz);
+
+	snprintf(backup,sz,"%s.1",writer->filename);
+
+	close(writer->fd);
+	writer->fd = -1;
+
+#ifdef _WIN32
+	remove(backup);
+#endif // _WIN32
+	rename(writer->filename,backup);
+
+	lib3270_free(backup);
+
+	trace_writer_open(writer);
+
+}
+
+/// @brief Write two blocks of data to the file, opening or rotating it as needed.
+/// @param max_size	Rotation size, read with the lock (the flusher calls this unlocked).
+/// @param interval	Rotation interval, read with the lock.
+static void trace_writer_segments(TRACE_WRITER *writer, size_t max_size, unsigned int interval, const void *first, size_t first_length, const void *second, size_t second_length) {
+
+	size_t length = first_length + second_length;
+
+	if(writer->fd < 0 && trace_writer_open(writer))
+		return;		// Can't open the file, drop the data as the old fopen() based code did.
+
+	if(writer->file_size && (
+			(max_size && (writer->file_size + length) > max_size) ||
+			(interval && (time(NULL) - writer->opened) >= (time_t) interval)
+		)) {
+		trace_writer_rotate(writer);
+		if(writer->fd < 0)
+			return;
+	}
+
+#ifdef _WIN32
+	{
+		if(first_length && write(writer->fd,first,first_length) < 0)
+			return;
+		if(second_length && write(writer->fd,second,second_length) < 0)
+			return;
+	}
+#else
+	{
+		struct iovec	  iov[2];
+		int				  count = 0;
+		ssize_t			  rc;
+
+		if(first_length) {
+			iov[count].iov_base	= (void *) first;
+			iov[count].iov_len	= first_length;
+			count++;
+		}
+
+		if(second_length) {
+			iov[count].iov_base	= (void *) second;
+			iov[count].iov_len	= second_length;
+			count++;
+		}
+
+		while(count) {
+
+			rc = writev(writer->fd,iov,count);
+
+			if(rc < 0) {
+				if(errno == EINTR)
+					continue;
+				return;
+			}
+
+			// Handle short writes.
+			while(count && (size_t) rc >= iov[0].iov_len) {
+				rc -= iov[0].iov_len;
+				iov[0] = iov[1];
+				count--;
+			}
+
+			if(count) {
+				iov[0].iov_base = ((unsigned char *) iov[0].iov_base) + rc;
+				iov[0].iov_len -= rc;
+			}
+
+		}
+	}
+#endif // _WIN32
+
+	writer->file_size += length;
+
+}
+
+/// @brief Write the buffer segments to the file (called without the lock).
+static void trace_writer_output(TRACE_WRITER *writer, size_t max_size, unsigned int interval, size_t from, size_t length) {
+
+	// Split the pending data into at most two contiguous segments.
+	size_t offset = from % TRACE_WRITER_BUFFER;
+	size_t first = TRACE_WRITER_BUFFER - offset;
+
+	if(first > length)
+		first = length;
+
+	trace_writer_segments(writer,max_size,interval,writer->buffer+offset,first,writer->buffer,length-first);
+
+}
+
+static void * trace_writer_thread(void *arg) {
+
+	TRACE_WRITER * writer = (TRACE_WRITER *) arg;
+
+	pthread_mutex_lock(&writer->mutex);
+
+	for(;;) {
+
+		size_t pending = writer->head - writer->tail;
+
+		if(!pending) {
+
+			if(writer->stopping)
+				break;
+
+			pthread_cond_wait(&writer->wakeup,&writer->mutex);
+			continue;
+
+		}
+
+		if(pending < TRACE_WRITER_WATERMARK && !(writer->stopping || writer->flushing)) {
+
+			// Give the producer some time to batch more data.
+			struct timespec	ts;
+
+			clock_gettime(CLOCK_REALTIME,&ts);
+			ts.tv_nsec += (TRACE_WRITER_INTERVAL * 1000000L);
+			if(ts.tv_nsec >= 1000000000L) {
+				ts.tv_sec++;
+				ts.tv_nsec -= 1000000000L;
+			}
+
+			pthread_cond_timedwait(&writer->wakeup,&writer->mutex,&ts);
+			pending = writer->head - writer->tail;
+
+		}
+
+		{
+			size_t			from		= writer->tail;
+			size_t			max_size	= writer->max_size;
+			unsigned int	interval	= writer->interval;
+
+			// The producers never overwrite the range [tail,head), it's safe to write it unlocked.
+			pthread_mutex_unlock(&writer->mutex);
+			trace_writer_output(writer,max_size,interval,from,pending);
+			pthread_mutex_lock(&writer->mutex);
+
+			writer->tail += pending;
+			pthread_cond_broadcast(&writer->drained);
+		}
+
+	}
+
+	pthread_mutex_unlock(&writer->mutex);
+
+	return NULL;
+}
+
+/// @brief Get a writer for the file, sharing it with the other sessions using the same file.
+///
+/// When the writer is shared it keeps the smallest non-zero max_size asked by its users,
+/// a session can't make the file grow beyond the limit set by another one.
+TRACE_WRITER * trace_writer_new(const char *filename, size_t max_size, const void *header, size_t header_length) {
+
+	TRACE_WRITER * writer;
+
+	pthread_mutex_lock(&writers.mutex);
+
+	for(writer = writers.first; writer; writer = writer->next) {
+		if(!strcmp(writer->filename,filename)) {
+			writer->refs++;
+			pthread_mutex_lock(&writer->mutex);
+			if(max_size && (!writer->max_size || max_size < writer->max_size))
+				writer->max_size = max_size;
+			pthread_mutex_unlock(&writer->mutex);
+			pthread_mutex_unlock(&writers.mutex);
+			return writer;
+		}
+	}
+
+	writer = lib3270_malloc(sizeof(TRACE_WRITER));
+
+	pthread_mutex_init(&writer->mutex,NULL);
+	pthread_cond_init(&writer->wakeup,NULL);
+	pthread_cond_init(&writer->drained,NULL);
+
+	writer->refs			= 1;
+	writer->fd				= -1;
+	writer->filename		= lib3270_strdup(filename);
+	writer->max_size		= max_size;
+	writer->header			= header;
+	writer->header_length	= header_length;
+
+	writer->next	= writers.first;
+	writers.first	= writer;
+
+	pthread_mutex_unlock(&writers.mutex);
+
+	return writer;
+}
+
+/// @brief Change the rotation size, an explicit change applies to every session sharing the file.
+void trace_writer_set_max_size(TRACE_WRITER *writer, size_t max_size) {
+	pthread_mutex_lock(&writer->mutex);
+	writer->max_size = max_size;
+	pthread_mutex_unlock(&writer->mutex);
+}
+
+void trace_writer_set_interval(TRACE_WRITER *writer, unsigned int seconds) {
+	pthread_mutex_lock(&writer->mutex);
+	writer->interval = seconds;
+	pthread_mutex_unlock(&writer->mutex);
+}
+
+/// @brief Wait for buffer space (called with the lock).
+static size_t trace_writer_wait(TRACE_WRITER *writer, size_t length) {
+
+	size_t space;
+
+	if(length > TRACE_WRITER_BUFFER)
+		length = TRACE_WRITER_BUFFER;
+
+	while((space = TRACE_WRITER_BUFFER - (writer->head - writer->tail)) < length) {
+		// Buffer is full, block instead of losing trace data.
+		pthread_cond_signal(&writer->wakeup);
+		pthread_cond_wait(&writer->drained,&writer->mutex);
+	}
+
+	return space;
+}
+
+/// @brief Copy data to the buffer (called with the lock).
+static void trace_writer_put(TRACE_WRITER *writer, const unsigned char *data, size_t length) {
+
+	while(length) {
+
+		size_t	  space		= trace_writer_wait(writer,1);
+		size_t	  offset	= writer->head % TRACE_WRITER_BUFFER;
+		size_t	  block		= TRACE_WRITER_BUFFER - offset;
+
+		if(block > space)
+			block = space;
+		if(block > length)
+			block = length;
+
+		memcpy(writer->buffer+offset,data,block);
+		writer->head += block;
+		data += block;
+		length -= block;
+
+	}
+
+}
+
+static int trace_writer_start(TRACE_WRITER *writer) {
+
+	if(!writer->started) {
+
+		if(pthread_create(&writer->thread,NULL,trace_writer_thread,writer))
+			return errno ? errno : EAGAIN;
+
+		writer->started = 1;
+
+	}
+
+	return 0;
+}
+
+int trace_writer_write(TRACE_WRITER *writer, const char *text, size_t length) {
+	return trace_writer_write_record(writer,text,length,NULL,0);
+}
+
+int trace_writer_write_record(TRACE_WRITER *writer, const void *header, size_t header_length, const void *data, size_t length) {
+
+	int rc;
+
+	pthread_mutex_lock(&writer->mutex);
+
+	rc = trace_writer_start(writer);
+	if(!rc && (header_length+length) > TRACE_WRITER_BUFFER) {
+
+		// Larger than the buffer, drain it and write the record to the file holding the lock.
+		while(writer->head != writer->tail) {
+			writer->flushing = 1;
+			pthread_cond_signal(&writer->wakeup);
+			pthread_cond_wait(&writer->drained,&writer->mutex);
+		}
+
+		// The flusher thread is idle and needs the lock to get new data.
+		writer->flushing = 0;
+		trace_writer_segments(writer,writer->max_size,writer->interval,header,header_length,data,length);
+
+	} else if(!rc) {
+
+		// Wait for space to the whole record, no other producer can get in the middle of it.
+		trace_writer_wait(writer,header_length+length);
+
+		trace_writer_put(writer,header,header_length);
+		trace_writer_put(writer,data,length);
+
+		if((writer->head - writer->tail) >= TRACE_WRITER_WATERMARK)
+			pthread_cond_signal(&writer->wakeup);
+
+	}
+
+	pthread_mutex_unlock(&writer->mutex);
+
+	return rc;
+}
+
+void trace_writer_flush(TRACE_WRITER *writer) {
+
+	pthread_mutex_lock(&writer->mutex);
+
+	if(writer->started) {
+
+		size_t head = writer->head;
+
+		writer->flushing = 1;
+		pthread_cond_signal(&writer->wakeup);
+
+		while((ssize_t) (head - writer->tail) > 0)
+			pthread_cond_wait(&writer->drained,&writer->mutex);
+
+		writer->flushing = 0;
+
+	}
+
+	pthread_mutex_unlock(&writer->mutex);
+
+}
+
+void trace_writer_free(TRACE_WRITER *writer) {
+
+	TRACE_WRITER **link;
+
+	if(!writer)
+		return;
+
+	pthread_mutex_lock(&writers.mutex);
+
+	if(--writer->refs) {
+		pthread_mutex_unlock(&writers.mutex);
+		trace_writer_flush(writer);
+		return;
+	}
+
+	for(link = &writers.first; *link; link = &(*link)->next) {
+		if(*link == writer) {
+			*link = writer->next;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&writers.mutex);
+
+	pthread_mutex_lock(&writer->mutex);
+	writer->stopping = 1;
+	pthread_cond_signal(&writer->wakeup);
+	pthread_mutex_unlock(&writer->mutex);
+
+	if(writer->started)
+		pthread_join(writer->thread,NULL);
+
+	if(writer->fd >= 0)
+		close(writer->fd);
+
+	pthread_cond_destroy(&writer->drained);
+	pthread_cond_destroy(&writer->wakeup);
+	pthread_mutex_destroy(&writer->mutex);
+
+	lib3270_free(writer->filename);
+	lib3270_free(writer);
+
+}
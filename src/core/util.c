@@ -100,6 +100,22 @@ LIB3270_EXPORT char * lib3270_strdup_printf(const char *fmt, ...) {
 	return r;
 }
 
+char * lib3270_format_buffer(char *buffer, size_t length, const char *fmt, va_list args) {
+
+	int		rc;
+	va_list	copy;
+
+	va_copy(copy,args);
+	rc = vsnprintf(buffer,length,fmt,copy);
+	va_end(copy);
+
+	if(rc >= 0 && ((size_t) rc) < length)
+		return buffer;
+
+	return lib3270_vsprintf(fmt,args);
+
+}
+
 /**
  * @brief Common helper functions to insert strings, through a template, into a new  buffer.
  *
@@ -385,6 +385,8 @@ int net_reconnect(H3270 *hSession, int seconds) {
 		trace_dsn(hSession,"Network keep-alive is %s\n",optval ? "enabled" : "disabled" );
 	}
 
+	lib3270_network_apply_profile(hSession);
+
 	// Connecting, set callbacks, wait for connection
 	lib3270_set_cstate(hSession, LIB3270_PENDING);
 	lib3270_st_changed(hSession, LIB3270_STATE_HALF_CONNECT, True);
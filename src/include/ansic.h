@@ -19,6 +19,7 @@
 #if defined(X3270_ANSI) /*[*/
 
 LIB3270_INTERNAL void ansi_process(H3270 *hSession, unsigned int c);
+LIB3270_INTERNAL size_t ansi_process_text(H3270 *hSession, const unsigned char *text, size_t length);
 LIB3270_INTERNAL void ansi_send_clear(H3270 *hSession);
 LIB3270_INTERNAL void ansi_send_down(H3270 *hSession);
 LIB3270_INTERNAL void ansi_send_home(H3270 *hSession);
@@ -34,6 +35,7 @@ LIB3270_INTERNAL void toggle_lineWrap(H3270 *session, struct lib3270_toggle *t,
 #else /*][*/
 
 #define ansi_process(n)
+#define ansi_process_text(h, t, l)	0
 #define ansi_send_clear()
 #define ansi_send_down()
 #define ansi_send_home()
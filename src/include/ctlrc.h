@@ -46,6 +46,7 @@ LIB3270_INTERNAL void ctlr_add_cs(H3270 *hSession, int baddr, unsigned char cs);
 LIB3270_INTERNAL void ctlr_add_fa(H3270 *hSession, int baddr, unsigned char fa, unsigned char cs);
 LIB3270_INTERNAL void ctlr_add_fg(H3270 *hSession, int baddr, unsigned char color);
 LIB3270_INTERNAL void ctlr_add_gr(H3270 *hSession, int baddr, unsigned char gr);
+LIB3270_INTERNAL void ctlr_add_string(H3270 *hSession, int baddr, const unsigned char *text, int count, unsigned char cs, unsigned char gr, unsigned char fg, unsigned char bg);
 LIB3270_INTERNAL void ctlr_altbuffer(H3270 *session, int alt);
 LIB3270_INTERNAL int  ctlr_any_data(H3270 *session);
 LIB3270_INTERNAL void ctlr_bcopy(H3270 *hSession, int baddr_from, int baddr_to, int count, int move_ea);
@@ -56,6 +57,8 @@ LIB3270_INTERNAL void ctlr_read_buffer(H3270 *session, unsigned char aid_byte);
 LIB3270_INTERNAL void ctlr_read_modified(H3270 *hSession, unsigned char aid_byte, Boolean all);
 LIB3270_INTERNAL void ctlr_model_changed(H3270 *session);
 LIB3270_INTERNAL void ctlr_scroll(H3270 *hSession);
+LIB3270_INTERNAL void scrollback_add(H3270 *hSession, const struct lib3270_ea *row, int cols);
+LIB3270_INTERNAL void scrollback_free(H3270 *hSession);
 LIB3270_INTERNAL void ctlr_wrapping_memmove(H3270 *session, int baddr_to, int baddr_from, int count);
 LIB3270_INTERNAL enum pds ctlr_write(H3270 *hSession, unsigned char buf[], int buflen, Boolean erase);
 LIB3270_INTERNAL void ctlr_write_sscp_lu(H3270 *session, unsigned char buf[], int buflen);
@@ -39,4 +39,88 @@ LIB3270_INTERNAL void		  ft_message(H3270FT *h, const char *msg);
 LIB3270_INTERNAL void		  ft_running(H3270FT *h, Boolean is_cut);
 LIB3270_INTERNAL void		  ft_update_length(H3270FT *h);
 
+/**
+ * @brief Create a transfer.
+ *
+ * @param file	Local file already opened by the caller (NULL to open it); kept by the caller on failure.
+ *
+ */
+LIB3270_INTERNAL H3270FT	* ft_new(H3270 *session, LIB3270_FT_OPTION flags, const char *local, const char *remote, int lrecl, int blksize, int primspace, int secspace, int dft, FILE *file, const char **message);
+
+/// @brief Account a finished transfer and start the next queued one (ft_queue.c).
+LIB3270_INTERNAL void		  ft_queue_done(H3270FT *ft, int failed);
+
+/// @brief Forget a transfer being destroyed.
+LIB3270_INTERNAL void		  ft_queue_detach(H3270FT *ft);
+
+/// @brief Release the transfer queue of the session.
+LIB3270_INTERNAL void		  ft_queue_free(H3270 *hSession);
+
+/// @brief Block reader for the local file (ft_reader.c).
+typedef struct _ft_reader FT_READER;
+
+/**
+ * @brief Create a reader for the local file.
+ *
+ * Regular files are memory mapped when possible, other files are read in large blocks.
+ * Reading starts at the current file position.
+ *
+ */
+LIB3270_INTERNAL FT_READER	* ft_reader_new(FILE *file);
+LIB3270_INTERNAL void		  ft_reader_free(FT_READER *reader);
+
+/**
+ * @brief Get the next bytes of the file without consuming them.
+ *
+ * @param data	Receives a pointer to the bytes, valid until the next call.
+ * @param max	Maximum number of bytes wanted.
+ *
+ * @return Number of available bytes (up to max), 0 on end of file or error.
+ *
+ */
+LIB3270_INTERNAL size_t		  ft_reader_peek(FT_READER *reader, const unsigned char **data, size_t max);
+LIB3270_INTERNAL void		  ft_reader_consume(FT_READER *reader, size_t length);
+
+/// @brief Check for end of file (all bytes consumed).
+LIB3270_INTERNAL int		  ft_reader_eof(FT_READER *reader);
+
+/// @brief Get the read error (0 if none).
+LIB3270_INTERNAL int		  ft_reader_error(const FT_READER *reader);
+
+/// @brief Ask the system to start loading the beginning of a mapped file.
+LIB3270_INTERNAL void		  ft_reader_prefetch(FT_READER *reader);
+
+/// @brief Write-behind for the local file (ft_writer.c).
+typedef struct _ft_writer FT_WRITER;
+
+/**
+ * @brief Create a write-behind for the local file.
+ *
+ * Writing starts at the current file position, the file should not be used
+ * until the writer is released.
+ *
+ */
+LIB3270_INTERNAL FT_WRITER	* ft_writer_new(FILE *file);
+
+/**
+ * @brief Flush the pending data and release the writer.
+ *
+ * @return 0 if all data was written or the error code.
+ *
+ */
+LIB3270_INTERNAL int		  ft_writer_free(FT_WRITER *writer);
+
+/**
+ * @brief Queue data to the local file.
+ *
+ * Blocks only when all buffers are waiting for the disk.
+ *
+ * @return 0 or the error code of a previous failed write.
+ *
+ */
+LIB3270_INTERNAL int		  ft_writer_write(FT_WRITER *writer, const void *data, size_t length);
+
+/// @brief Wait for all queued data to reach the file, returns 0 or the error code.
+LIB3270_INTERNAL int		  ft_writer_flush(FT_WRITER *writer);
+
 #endif /*]*/
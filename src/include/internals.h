@@ -43,6 +43,7 @@
 #include <lib3270/os.h>
 #include <lib3270/log.h>
 #include <lib3270/trace.h>
+#include <lib3270/stats.h>
 
 #if defined(HAVE_LDAP) && defined (HAVE_LIBSSL)
 #include <openssl/x509.h>
@@ -188,6 +189,9 @@ LIB3270_INTERNAL Boolean		dbcs;
 #define DFT_BUF		(4 * 1024)
 #endif /*]*/
 
+/* Number of modules tracked by the log rate limiter. */
+#define LOG_RATE_MODULES	8
+
 /**
  * @brief input key type
  */
@@ -306,6 +310,17 @@ struct _h3270 {
 		/// @brief Network context.
 		LIB3270_NET_CONTEXT			* context;
 
+		/// @brief Socket tuning profile.
+		LIB3270_NETWORK_PROFILE		  profile;
+
+		/// @brief Output coalescing (see net_cork() and net_uncork()).
+		struct {
+			unsigned int			  level;		///< @brief Cork nesting level, output is buffered while non zero.
+			size_t					  length;		///< @brief Length of the pending output.
+			size_t					  size;			///< @brief Allocated size of the buffer.
+			unsigned char			* buffer;		///< @brief Pending output.
+		} cork;
+
 	} network;
 
 	// Connection info
@@ -371,6 +386,18 @@ struct _h3270 {
 
 	struct lib3270_charset	  charset;
 
+	/// @brief Byte copies of charset.ebc2asc and charset.asc2ebc for the bulk converters (charset/convert.c).
+	struct {
+		unsigned char			  ebc2asc[256];
+		unsigned char			  asc2ebc[256];
+	} charset_bytes;
+
+	/// @brief Display charset to UTF-8 converter for lib3270_ebc2utf8() (charset/convert.c).
+	struct {
+		struct _lib3270_iconv	* conv;
+		char					* charset;			///< @brief Display charset of the converter.
+	} utf8;
+
 	struct {
 		LIB3270_MESSAGE		  status;
 		unsigned char		  flag[LIB3270_FLAG_COUNT];
@@ -450,6 +477,29 @@ struct _h3270 {
 	int             		  ns_bsent;
 	int             		  ns_rsent;
 	struct timeval 			  ds_ts;
+
+	/// @brief Data stream processing time (see lib3270_set_stage_timing).
+	struct {
+		unsigned int		  enabled			: 1;
+		LIB3270_STAGE_COUNTER counters[LIB3270_STAGE_COUNT];
+	} stages;
+
+	/// @brief Performance counters (see lib3270_get_stats).
+	struct {
+		LIB3270_STATS		  counters;
+	} stats;
+
+	/// @brief AID round trips (see lib3270_get_aid_spans).
+	struct {
+		unsigned int				  exclude_delay	: 1;	///< @brief Remove unlock delay from latency.
+		LIB3270_AID_SPAN			  current;				///< @brief Active span (current.sent != 0).
+		LIB3270_AID_SPAN_HANDLER	  handler;
+		void						* userdata;
+		size_t						  head;					///< @brief Written by the session thread.
+		size_t						  tail;					///< @brief Written by the reader.
+		LIB3270_AID_SPAN			  queue[LIB3270_AID_SPAN_QUEUE];
+	} spans;
+
 	unsigned short			  e_xmit_seq;			/**< @brief transmit sequence number */
 	int						  response_required;
 	int						  ansi_data;
@@ -512,11 +562,21 @@ struct _h3270 {
 	void					* unlock_id;
 	time_t					  unlock_delay_time;
 	unsigned long 			  unlock_delay_ms;		///< @brief Delay before actually unlocking the keyboard after the host permits it.
-	LIB3270_TA				* ta_head;
-	LIB3270_TA				* ta_tail;
+
+	/// @brief Typeahead queue.
+	struct {
+		LIB3270_TA			* ring;				///< @brief Queue entries (allocated on first use).
+		unsigned int		  size;				///< @brief Ring size (a power of 2).
+		unsigned int		  head;				///< @brief Index of the first queued entry.
+		unsigned int		  count;			///< @brief Number of queued entries.
+		unsigned int		  limit;			///< @brief Maximum number of queued entries (0 = no limit).
+		unsigned char		  overflow;			///< @brief LIB3270_TYPEAHEAD_OVERFLOW policy.
+	} ta;
 
 	// ft_dft.c
 	int						  dft_buffersize;		///< @brief Buffer size (LIMIN, LIMOUT)
+	int						  dft_limit;			///< @brief Buffer size sent on the last query reply (0 if none).
+	unsigned int			  dft_auto : 1;			///< @brief Adapt the upload record size by default.
 
 	// rpq.c
 	unsigned int			  rpq_complained : 1;
@@ -531,7 +591,9 @@ struct _h3270 {
 	void					* user_data;
 
 	// selection
-	char					* paste_buffer;
+	char					* paste_buffer;		///< @brief Text waiting for lib3270_paste_next().
+	int						  paste_length;		///< @brief Length of the paste buffer.
+	int						  paste_offset;		///< @brief Start of the next segment on the paste buffer.
 	struct {
 		int start;
 		int end;
@@ -628,6 +690,14 @@ struct _h3270 {
 	// Trace methods.
 	struct {
 		char *file;	///< @brief Trace file name (if set).
+		unsigned int mask;	///< @brief Enabled trace toggles (TRACE_MASK() bits).
+		size_t max_size;	///< @brief Rotate the trace file when it reaches this size (0 = never).
+		struct _trace_writer *writer;	///< @brief Buffered trace file writer (created on first use).
+		struct {
+			char *file;	///< @brief Binary trace file name (if set).
+			struct _trace_writer *writer;
+			unsigned int serial;	///< @brief Session number on the binary trace.
+		} binary;
 		LIB3270_TRACE_HANDLER handler;
 		void *userdata;
 	} trace;
@@ -636,6 +706,16 @@ struct _h3270 {
 		char *file; 		///< @brief Log file name (if set).
 		LIB3270_LOG_HANDLER handler;
 		void *userdata;
+		struct _trace_writer *writer;	///< @brief Buffered log file writer (created on first use).
+		size_t max_size;				///< @brief Rotate the log file when it reaches this size (0 = never).
+		unsigned int interval;			///< @brief Rotate the log file after this number of seconds (0 = never).
+		unsigned int rate_limit;		///< @brief Maximum messages per module per second (0 = unlimited).
+		struct {
+			char module[32];
+			time_t window;				///< @brief Second being counted.
+			unsigned int count;			///< @brief Messages logged on this second.
+			unsigned int suppressed;	///< @brief Messages dropped since the last summary.
+		} limits[LOG_RATE_MODULES];
 	} log;
 
 	struct {
@@ -662,6 +742,18 @@ struct _h3270 {
 
 	unsigned int tasks;
 
+	/// @brief Macro running on the session (macro.c).
+	struct _lib3270_macro_state * macro;
+
+	/// @brief Pending file transfers (ft_queue.c).
+	struct _lib3270_ft_queue * ft_queue;
+
+	/// @brief Rows scrolled out of the NVT screen (scrollback.c).
+	struct _lib3270_scrollback * scrollback;
+
+	/// @brief Query replies built for the current configuration (sf.c).
+	struct _lib3270_query_replies * query_replies;
+
 };
 
 #define SELECTION_LEFT			0x01
@@ -742,6 +834,47 @@ LIB3270_INTERNAL unsigned char get_field_attribute(H3270 *session, int baddr);
 /// @brief Default log writer.
 LIB3270_INTERNAL int default_loghandler(const H3270 *session, void *dunno, const char *module, int rc, const char *message);
 
+/**
+ * @brief Find an action, toggle or property by name.
+ *
+ * @param type	LIB3270_NAME_TYPE to search (negative for any).
+ *
+ * @return The resolved name or NULL if not found (sets errno).
+ */
+LIB3270_INTERNAL const struct _lib3270_resolved_name * lib3270_find_name(const char *name, int type);
+
+/**
+ * @brief Translate a buffer through a 256 entries table (charset/convert.c).
+ *
+ * Uses SSSE3/AVX2 when available; dst can be the same as src.
+ *
+ */
+LIB3270_INTERNAL void lib3270_charset_translate(unsigned char *dst, const unsigned char *src, size_t len, const unsigned char *table);
+
+/// @brief Build the byte table of a charset translation table for lib3270_charset_translate() (charset/convert.c).
+LIB3270_INTERNAL void lib3270_charset_bytes(unsigned char *bytes, const unsigned short *table);
+
+/**
+ * @brief Resume the macro waiting on the session (if any).
+ *
+ * Called when the host may have satisfied a wait step; the macro continues
+ * from the event loop, not from the caller.
+ *
+ */
+LIB3270_INTERNAL void lib3270_macro_wakeup(H3270 *hSession);
+
+/// @brief Check the transfer queue of the session (if any) as soon as possible (ft/ft_queue.c).
+LIB3270_INTERNAL void lib3270_ft_queue_wakeup(H3270 *hSession);
+
+/// @brief Drop the cached query replies, call it when something they report changes (sf.c).
+LIB3270_INTERNAL void query_reply_reset(H3270 *hSession);
+
+/// @brief Drop the cached query reply with this code, it will be rebuilt on the next query (sf.c).
+LIB3270_INTERNAL void query_reply_drop(H3270 *hSession, unsigned char code);
+
+/// @brief Write text to the log file (if set), returns non zero if there's no log file.
+LIB3270_INTERNAL int log_write_text(const H3270 *session, const char *text, size_t length);
+
 LIB3270_INTERNAL char * lib3270_get_user_name();
 
 /// @brief Query data from URL.
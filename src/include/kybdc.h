@@ -21,9 +21,11 @@
 #define KYBDC_H_INCLUDED
 #include <lib3270/keyboard.h>
 
+/// @brief Parameters up to this length are stored inside the typeahead entry.
+#define TA_PARM_INLINE	16
+
 /// @brief Element in typeahead queue.
 struct ta {
-	struct ta *next;
 
 	enum _ta_type {
 		TA_TYPE_DEFAULT,
@@ -37,7 +39,9 @@ struct ta {
 		unsigned char aid_code;
 		struct {
 			void (*fn)(H3270 *, const char *, const char *);
-			char *parm[2];
+			char *parm[2];						///< @brief Allocated parameters (longer than TA_PARM_INLINE).
+			unsigned char inline_parm;			///< @brief Bit 'n' is set when parameter 'n' is on the buffer.
+			char buffer[2][TA_PARM_INLINE];
 		} def;
 
 		int (*action)(H3270 *);
@@ -77,11 +81,14 @@ LIB3270_INTERNAL void lib3270_kybdlock_clear(H3270 *hSession, LIB3270_KEYBOARD_L
 
 LIB3270_INTERNAL void kybd_inhibit(H3270 *session, Boolean inhibit);
 LIB3270_INTERNAL int  kybd_prime(H3270 *hSession);
+LIB3270_INTERNAL void kybd_blank_fill(H3270 *hSession, int faddr, int baddr);
 LIB3270_INTERNAL void kybd_scroll_lock(Boolean lock);
 LIB3270_INTERNAL void kybd_connect(H3270 *session, int connected, void *dunno);
 LIB3270_INTERNAL void kybd_in3270(H3270 *session, int in3270, void *dunno);
 
 LIB3270_INTERNAL int			run_ta(H3270 *hSession);
+
+/// @brief Get a new entry on the typeahead queue, returns NULL if the action was dropped.
 LIB3270_INTERNAL struct ta *	new_ta(H3270 *hSession, enum _ta_type type);
 
 /// @brief Put a lib3270 action on the typeahead queue.
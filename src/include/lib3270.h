@@ -287,6 +287,18 @@ typedef enum lib3270_host_type {
 
 #define LIB3270_HOSTTYPE_DEFAULT LIB3270_HOST_S390
 
+/**
+ * @brief Socket tuning profiles.
+ *
+ */
+typedef enum lib3270_network_profile {
+	LIB3270_NETWORK_PROFILE_DEFAULT,		///< @brief Keep the system defaults.
+	LIB3270_NETWORK_PROFILE_LATENCY,		///< @brief Interactive sessions (no Nagle, quick ACKs).
+	LIB3270_NETWORK_PROFILE_THROUGHPUT,		///< @brief Bulk transfers (Nagle enabled, large socket buffers).
+
+	LIB3270_NETWORK_PROFILE_COUNT
+} LIB3270_NETWORK_PROFILE;
+
 typedef struct _LIB3270_HOST_TYPE_entry {
 	LIB3270_HOST_TYPE	  type;
 	const char			* name;
@@ -649,6 +661,41 @@ LIB3270_EXPORT int lib3270_translate_to_address(const H3270 *hSession, unsigned
  */
 LIB3270_EXPORT int lib3270_set_field(H3270 *hSession, const char *text, int length);
 
+/**
+ * @brief Field contents for lib3270_set_fields().
+ */
+typedef struct _lib3270_field_value {
+	int				  baddr;	///< @brief Address of any position inside the field (-1 to select it by index).
+	unsigned int	  index;	///< @brief Index of the unprotected field (0 is the first on the screen), used if baddr is negative.
+	const char		* text;		///< @brief Field contents.
+	int				  length;	///< @brief Length of the text (-1 for auto-detect).
+} LIB3270_FIELD_VALUE;
+
+/**
+ * @brief Set the contents of several fields at once.
+ *
+ * Replaces the contents of each field with the text (the remaining positions are set to nulls)
+ * and sets the modified data tag without running the keyboard emulation for every character;
+ * the fields are checked before the first change and the screen is updated once.
+ *
+ * The cursor is not moved.
+ *
+ * @param hSession	Session handle.
+ * @param fields	Fields to set.
+ * @param count		Number of fields.
+ *
+ * @return 0 if ok, negative if failed (no field was changed).
+ *
+ * @retval -EPERM		The keyboard is locked or a field is protected.
+ * @retval -ENOTCONN	Disconnected from host.
+ * @retval -ENOTSUP		The screen is not formatted or the field is DBCS.
+ * @retval -ENODATA		There's no field at the address or index.
+ * @retval -EOVERFLOW	The address is beyond the screen length or the text is bigger than the field.
+ * @retval -EINVAL		The text has control characters or non numeric characters in a numeric field.
+ *
+ */
+LIB3270_EXPORT int lib3270_set_fields(H3270 *hSession, const LIB3270_FIELD_VALUE *fields, unsigned int count);
+
 /**
  * @brief Set string at current cursor position.
  *
@@ -1154,6 +1201,60 @@ LIB3270_EXPORT char * lib3270_get_string_at_address(H3270 *h, int offset, int le
  */
 LIB3270_EXPORT char * lib3270_get_string_at(H3270 *h, unsigned int row, unsigned int col, int len, char lf);
 
+/**
+ * @brief Set the size of the NVT scrollback.
+ *
+ * Rows scrolled out of the NVT screen are kept as UTF-8 text (without trailing blanks,
+ * runs of a repeated character packed), the oldest ones are dropped when the limit
+ * is reached. Clears the stored lines.
+ *
+ * @param hSession	Session handle.
+ * @param lines		Maximum number of lines (0 disables the scrollback).
+ *
+ * @return 0 if ok.
+ *
+ */
+LIB3270_EXPORT int lib3270_set_scrollback(H3270 *hSession, unsigned int lines);
+
+/**
+ * @brief Get the maximum number of lines on the NVT scrollback.
+ *
+ */
+LIB3270_EXPORT unsigned int lib3270_get_scrollback(const H3270 *hSession);
+
+/**
+ * @brief Get the number of lines stored on the NVT scrollback.
+ *
+ * The stored lines are the last ones, from lib3270_get_scrollback_total() - length.
+ *
+ */
+LIB3270_EXPORT unsigned int lib3270_get_scrollback_length(const H3270 *hSession);
+
+/**
+ * @brief Get the number of lines scrolled out of the NVT screen.
+ *
+ * Never decreases, readers can poll it to get the new lines.
+ *
+ */
+LIB3270_EXPORT unsigned long lib3270_get_scrollback_total(const H3270 *hSession);
+
+/**
+ * @brief Get a line from the NVT scrollback.
+ *
+ * The line is UTF-8, the field attributes and control characters are returned as blanks,
+ * DEC line drawing as its Unicode equivalents and any other character set
+ * as U+FFFD.
+ *
+ * @param hSession	Session handle.
+ * @param line		Line number (the first line scrolled out is 0).
+ *
+ * @return Line contents or NULL if error (sets errno). Release it with lib3270_free()
+ *
+ * @exception ENOENT	The line wasn't scrolled out yet or was dropped.
+ *
+ */
+LIB3270_EXPORT char * lib3270_get_scrollback_line(const H3270 *hSession, unsigned long line);
+
 /**
  * @brief Check for text at requested position
  *
@@ -1377,6 +1478,28 @@ LIB3270_EXPORT int			  lib3270_set_model_number(H3270 *hSession, unsigned int mo
 LIB3270_EXPORT int lib3270_set_unlock_delay(H3270 *session, unsigned int delay);
 LIB3270_EXPORT unsigned int lib3270_get_unlock_delay(const H3270 *session);
 
+/**
+ * @brief Set the socket tuning profile.
+ *
+ * The profile is applied when the connection is established. It can't be
+ * changed while connected: the options a profile sets (the socket buffer
+ * sizes, for instance) can't be reliably restored on a live socket.
+ *
+ * @param hSession	TN3270 Session handle.
+ * @param profile	The socket tuning profile.
+ *
+ * @return 0 if ok, error code if not (sets errno).
+ *
+ * @retval EINVAL	Invalid profile.
+ * @retval EISCONN	Session is connected (and the profile is not the current one).
+ *
+ */
+LIB3270_EXPORT int lib3270_set_network_profile(H3270 *hSession, LIB3270_NETWORK_PROFILE profile);
+LIB3270_EXPORT LIB3270_NETWORK_PROFILE lib3270_get_network_profile(const H3270 *hSession);
+
+LIB3270_EXPORT int lib3270_set_network_profile_by_name(H3270 *hSession, const char *name);
+LIB3270_EXPORT const char * lib3270_get_network_profile_name(const H3270 *hSession);
+
 /**
  * @brief Alloc/Realloc memory buffer.
  *
@@ -33,6 +33,8 @@
 
 #define LIB3270_CHARSET_H_INCLUDED 1
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -79,6 +81,18 @@ LIB3270_EXPORT void			  lib3270_remap_char(H3270 *hSession, unsigned short ebc,
 LIB3270_EXPORT const char	* lib3270_ebc2asc(H3270 *hSession, unsigned char *buffer, int sz);
 LIB3270_EXPORT const char	* lib3270_asc2ebc(H3270 *hSession, unsigned char *buffer, int sz);
 
+/**
+ * @brief Convert EBCDIC text to UTF-8 using the current host charset.
+ *
+ * @param hSession	Session Handle.
+ * @param buffer	EBCDIC text.
+ * @param sz		Length of the text (-1 for auto-detect).
+ *
+ * @return UTF-8 string (release it with lib3270_free) or NULL if failed (sets errno).
+ *
+ */
+LIB3270_EXPORT char			* lib3270_ebc2utf8(H3270 *hSession, const unsigned char *buffer, int sz);
+
 /**
  * @brief Get character code from string definition.
  *
@@ -112,6 +126,42 @@ LIB3270_EXPORT char * lib3270_iconv_from_host(LIB3270_ICONV *conv, const char *s
 ///
 LIB3270_EXPORT char * lib3270_iconv_to_host(LIB3270_ICONV *conv, const char *str, int len);
 
+///
+/// @brief Reusable buffer for the ICONV wrapper.
+///
+typedef struct _lib3270_iconv_buffer {
+	char	* text;		///< @brief Converted text, nul terminated (allocated with lib3270_malloc).
+	size_t	  length;	///< @brief Length of the converted text.
+	size_t	  size;		///< @brief Allocated size.
+} LIB3270_ICONV_BUFFER;
+
+///
+/// @brief Convert from host to local appending to a buffer.
+///
+/// The buffer grows as needed and can be reused (set length to 0 to restart);
+/// single byte charsets are converted through a precomputed table.
+///
+/// @param conv		ICONV wrapper.
+/// @param buffer	Buffer to receive the converted text, NULL to use a buffer owned by the wrapper (reset on every call).
+/// @param str		String to convert.
+/// @param len		Length of str (-1 if nul terminated).
+///
+/// @return Pointer to the buffer text (valid until the next call) or NULL if the string can't be converted (sets errno).
+///
+LIB3270_EXPORT const char * lib3270_iconv_from_host_buffer(LIB3270_ICONV *conv, LIB3270_ICONV_BUFFER *buffer, const char *str, int len);
+
+///
+/// @brief Convert from local to host appending to a buffer.
+///
+/// @see lib3270_iconv_from_host_buffer
+///
+LIB3270_EXPORT const char * lib3270_iconv_to_host_buffer(LIB3270_ICONV *conv, LIB3270_ICONV_BUFFER *buffer, const char *str, int len);
+
+///
+/// @brief Release the buffer text.
+///
+LIB3270_EXPORT void lib3270_iconv_buffer_free(LIB3270_ICONV_BUFFER *buffer);
+
 #ifdef __cplusplus
 }
 #endif
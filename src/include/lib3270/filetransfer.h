@@ -109,11 +109,15 @@ struct _h3270ft {
 	unsigned int				  ascii_flag	: 1;	///< @brief Convert to ascii
 	unsigned int				  ft_is_cut		: 1;	///< @brief File transfer is CUT-style
 	unsigned int				  dft_eof		: 1;
+	unsigned int				  dft_auto		: 1;	///< @brief Adapt the upload record size to the measured throughput.
+	unsigned int				  dft_settled	: 1;	///< @brief Stop growing the upload record size.
 
 
 	H3270					* host;
 	void					* user_data;			///< @brief File transfer dialog handle
 	FILE 					* local_file;			///< @brief File descriptor for local file
+	struct _ft_reader		* reader;				///< @brief Block reader for DFT uploads (created on the first Get).
+	struct _ft_writer		* writer;				///< @brief Write-behind for DFT downloads (created on the first Data Insert).
 	unsigned long			  length;				///< @brief File length
 
 	LIB3270_FT_STATE		  state;
@@ -138,6 +142,12 @@ struct _h3270ft {
 	unsigned char			* dft_savebuf;
 	int						  dft_savebuf_len;
 	int						  dft_savebuf_max;
+	int						  dft_size;				///< @brief Upload record size.
+	int						  dft_best;				///< @brief Record size with the best throughput (auto mode).
+	double					  dft_rate;				///< @brief Best throughput (bytes/s, auto mode).
+	unsigned long			  dft_rtt;				///< @brief Last record round trip time (microseconds).
+	size_t					  dft_sent_length;		///< @brief Bytes on the last Get reply (0 if not measuring).
+	struct timeval			  dft_sent;				///< @brief When the last Get reply was sent.
 
 	// ft_cut.c
 	int						  quadrant;
@@ -146,6 +156,7 @@ struct _h3270ft {
 	int						  xlate_buffered;					///< buffer count
 	int						  xlate_buf_ix;						///< buffer index
 	unsigned char			  xlate_buf[LIB3270_XLATE_NBUF];	///< buffer
+	struct _ft_cut_tables	* cut_tables;						///< @brief Conversion tables (built on the host ack).
 
 	// Charset
 	struct lib3270_charset	  charset;
@@ -170,7 +181,7 @@ typedef struct _lib3270_ft_message {
  * @param blksize
  * @param primspace
  * @param secspace
- * @param dft
+ * @param dft		DFT record size for this transfer (0 for the session default, LIB3270_DFT_BUFFER_AUTO to adapt).
  * @param msg		Pointer to receive message text.
  *
  * @return Filetransfer session handle.
@@ -195,8 +206,18 @@ LIB3270_EXPORT int							  lib3270_ft_set_blksize(H3270 *hSession, int blksize);
 LIB3270_EXPORT int							  lib3270_ft_set_primspace(H3270 *hSession, int primspace);
 LIB3270_EXPORT int							  lib3270_ft_set_secspace(H3270 *hSession, int secspace);
 
+/// @brief Advertise the largest DFT buffer and adapt the record size to the measured round trip time.
+#define LIB3270_DFT_BUFFER_AUTO	-1
+
 /**
  * @brief Update the buffersize for generating a Query Reply.
+ *
+ * The value is sent to the host on the next query reply and limits the
+ * record size of every transfer on that connection.
+ *
+ * With LIB3270_DFT_BUFFER_AUTO the largest buffer is advertised and uploads
+ * start with small records, doubling the size while the throughput improves.
+ *
  */
 LIB3270_EXPORT int							  lib3270_set_dft_buffersize(H3270 *hSession, int dft_buffersize);
 
@@ -250,5 +271,51 @@ LIB3270_EXPORT int							  lib3270_reset_ft_callbacks(H3270 *hSession);
  */
 LIB3270_EXPORT const LIB3270_FT_MESSAGE * lib3270_translate_ft_message(const char *msg);
 
+/**
+ * @brief Queue a file transfer.
+ *
+ * Queued transfers run one after the other as soon as the session is ready,
+ * the next upload is opened while the current transfer drains.
+ *
+ * Each transfer reports through the queue callbacks (see lib3270_ft_queue_get_callbacks());
+ * when the queue drains the totals are sent to the message callback.
+ *
+ * @param hSession	TN3270 session.
+ * @param flags		File transfer options (see lib3270_ft_new()).
+ * @param local		Local filename.
+ * @param remote	Remote filename.
+ * @param dft		DFT record size for this transfer (0 for the session default, LIB3270_DFT_BUFFER_AUTO to adapt).
+ *
+ * @return 0 if ok, error code if not.
+ *
+ * @retval	EINVAL	Invalid file name.
+ *
+ */
+LIB3270_EXPORT int							  lib3270_ft_enqueue(H3270 *hSession, LIB3270_FT_OPTION flags, const char *local, const char *remote, int lrecl, int blksize, int primspace, int secspace, int dft);
+
+/**
+ * @brief Get the callbacks used by the queued transfers.
+ *
+ * Unset (NULL) callbacks use the default handlers.
+ *
+ * @return Callback table or NULL if sz doesn't match.
+ *
+ */
+LIB3270_EXPORT struct lib3270_ft_callbacks	* lib3270_ft_queue_get_callbacks(H3270 *hSession, unsigned short sz);
+
+/// @brief Set the user data for the queued transfers.
+LIB3270_EXPORT void							  lib3270_ft_queue_set_user_data(H3270 *hSession, void *ptr);
+
+/// @brief Get the number of transfers waiting on the queue (not including the active one).
+LIB3270_EXPORT unsigned int					  lib3270_ft_queue_get_length(const H3270 *hSession);
+
+/**
+ * @brief Remove the transfers waiting on the queue.
+ *
+ * The active transfer is not cancelled.
+ *
+ */
+LIB3270_EXPORT void							  lib3270_ft_queue_clear(H3270 *hSession);
+
 
 #endif // LIB3270_FILETRANSFER_INCLUDED
@@ -39,6 +39,23 @@ LIB3270_EXPORT void lib3270_set_disconnected(H3270 *hSession);
 LIB3270_EXPORT void lib3270_set_connected_initial(H3270 *hSession);
 LIB3270_EXPORT void lib3270_setup_session(H3270 *session);
 
+/**
+ * @brief Put a disconnected session online without a socket.
+ *
+ * The session is left in the initial connected state with a network module
+ * that discards all output, host data must be injected with lib3270_data_recv().
+ * Used to replay captured data streams; the session stays in replay mode
+ * until a new URL is set.
+ *
+ * @param hSession	TN3270 Session handle.
+ *
+ * @return 0 if ok, error code if not.
+ *
+ * @retval EISCONN	The session is online.
+ *
+ */
+LIB3270_EXPORT int lib3270_replay_connect(H3270 *hSession);
+
 
 #ifdef __cplusplus
 }
@@ -57,6 +57,14 @@ typedef enum lib3270_keyboard_lock_state {
 
 } LIB3270_KEYBOARD_LOCK_STATE;
 
+/**
+ * @brief What to do when the typeahead queue is full.
+ */
+typedef enum lib3270_typeahead_overflow {
+	LIB3270_TYPEAHEAD_DROP_NEW		= 0,	///< @brief Ring the bell and drop the new action (the default).
+	LIB3270_TYPEAHEAD_DROP_OLDEST	= 1		///< @brief Drop the oldest queued action.
+} LIB3270_TYPEAHEAD_OVERFLOW;
+
 /**
  * @brief Wait for keyboard unlock.
  *
@@ -89,6 +97,35 @@ LIB3270_EXPORT int lib3270_get_lock_on_operator_error(const H3270 *hSession);
 LIB3270_EXPORT int lib3270_set_numeric_lock(H3270 *hSession, int enable);
 LIB3270_EXPORT int lib3270_get_numeric_lock(const H3270 *hSession);
 
+/**
+ * @brief Set the typeahead queue capacity.
+ *
+ * Actions entered while the keyboard is locked are queued and executed on unlock; when
+ * the queue reaches the limit the overflow policy decides which action is lost.
+ *
+ * @param hSession	TN3270 Session handle.
+ * @param entries	Maximum number of queued actions (0 for no limit).
+ *
+ * @return 0 if ok, error code if not.
+ *
+ */
+LIB3270_EXPORT int lib3270_set_typeahead_limit(H3270 *hSession, unsigned int entries);
+LIB3270_EXPORT unsigned int lib3270_get_typeahead_limit(const H3270 *hSession);
+
+/**
+ * @brief Set the typeahead queue overflow policy.
+ *
+ * @param hSession	TN3270 Session handle.
+ * @param policy	What to do when the queue is full.
+ *
+ * @return 0 if ok, error code if not.
+ *
+ * @retval EINVAL	Invalid policy.
+ *
+ */
+LIB3270_EXPORT int lib3270_set_typeahead_overflow(H3270 *hSession, LIB3270_TYPEAHEAD_OVERFLOW policy);
+LIB3270_EXPORT LIB3270_TYPEAHEAD_OVERFLOW lib3270_get_typeahead_overflow(const H3270 *hSession);
+
 
 #ifdef __cplusplus
 }
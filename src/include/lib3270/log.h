@@ -58,6 +58,58 @@ LIB3270_EXPORT void	  lib3270_set_log_handler(H3270 *session, const LIB3270_LOG_
 LIB3270_EXPORT int	  lib3270_set_log_filename(H3270 * hSession, const char *name);
 LIB3270_EXPORT const char * lib3270_get_log_filename(const H3270 * hSession);
 
+/**
+ * @brief Write the buffered log messages to the log file.
+ *
+ * The log file is written by a background thread shared by all sessions logging to the
+ * same file; this call reports the pending rate limiter counts and waits for the data.
+ *
+ * @param hSession	TN3270 Session.
+ *
+ */
+LIB3270_EXPORT void	  lib3270_flush_log(H3270 *hSession);
+
+/**
+ * @brief Set the maximum log file size.
+ *
+ * When the log file reaches this size it's renamed to "filename.1" and a new one is started.
+ *
+ * @param hSession	TN3270 Session.
+ * @param kbytes	Maximum size in kbytes (0 for no limit).
+ *
+ * @return 0 if ok, error code if not.
+ *
+ */
+LIB3270_EXPORT int	  lib3270_set_log_max_size(H3270 *hSession, unsigned int kbytes);
+LIB3270_EXPORT unsigned int lib3270_get_log_max_size(const H3270 *hSession);
+
+/**
+ * @brief Set the log file rotation interval.
+ *
+ * @param hSession	TN3270 Session.
+ * @param seconds	Rotate the log file after this number of seconds (0 to disable).
+ *
+ * @return 0 if ok, error code if not.
+ *
+ */
+LIB3270_EXPORT int	  lib3270_set_log_rotate_interval(H3270 *hSession, unsigned int seconds);
+LIB3270_EXPORT unsigned int lib3270_get_log_rotate_interval(const H3270 *hSession);
+
+/**
+ * @brief Limit the number of log messages per module.
+ *
+ * Messages above the limit are dropped; a "messages suppressed" line with the number
+ * of dropped messages is logged when the module's flood ends.
+ *
+ * @param hSession	TN3270 Session.
+ * @param messages	Maximum messages per module per second (0 for no limit).
+ *
+ * @return 0 if ok, error code if not.
+ *
+ */
+LIB3270_EXPORT int	  lib3270_set_log_rate_limit(H3270 *hSession, unsigned int messages);
+LIB3270_EXPORT unsigned int lib3270_get_log_rate_limit(const H3270 *hSession);
+
 LIB3270_EXPORT int	  lib3270_write_log(const H3270 *session, const char *module, const char *fmt, ...) LIB3270_GNUC_FORMAT(3,4);
 LIB3270_EXPORT int	  lib3270_write_rc(const H3270 *session, const char *module, int rc, const char *fmt, ...) LIB3270_GNUC_FORMAT(4,5);
 LIB3270_EXPORT void	  lib3270_write_va_log(const H3270 *session, const char *module, const char *fmt, va_list arg);
@@ -0,0 +1,157 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como macro.h e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @file lib3270/macro.h
+ *
+ * @brief Compiled macros, action sequences executed inside the library.
+ *
+ * A macro is a text script compiled once into a sequence of steps that the
+ * library runs on the session event loop; waits don't return to the caller,
+ * the macro resumes when the host answers.
+ *
+ * Script syntax (one statement per line, '#' starts a comment):
+ *
+ * @code
+ *	action NAME							Activate the action NAME (see lib3270_get_actions).
+ *	field ROW COL "TEXT"					Replace the contents of the field at ROW,COL.
+ *	wait [SECONDS]							Wait for the terminal to be ready.
+ *	waitfor ROW COL "TEXT" [SECONDS]		Wait for TEXT at ROW,COL.
+ *	if ROW COL "TEXT" goto LABEL			Jump to LABEL if the screen has TEXT at ROW,COL.
+ *	goto LABEL								Jump to LABEL.
+ *	exit [CODE]								End the macro with CODE (default 0).
+ *	LABEL:									Define a label.
+ * @endcode
+ *
+ */
+
+#ifndef LIB3270_MACRO_H_INCLUDED
+
+#define LIB3270_MACRO_H_INCLUDED 1
+
+#include <lib3270.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Compiled macro; immutable, can be shared by many sessions.
+typedef struct _lib3270_macro LIB3270_MACRO;
+
+/**
+ * @brief Called (on the session thread) when a macro started with lib3270_macro_start finishes.
+ *
+ * @param hSession	TN3270 Session handle.
+ * @param rc		0 if the macro finished, error code if failed (see lib3270_macro_run).
+ * @param exit_code	Code of the exit step (0 if the macro ended without one).
+ * @param userdata	Argument given to lib3270_macro_start.
+ *
+ */
+typedef void (*LIB3270_MACRO_HANDLER)(H3270 *hSession, int rc, int exit_code, void *userdata);
+
+/**
+ * @brief Compile a macro script.
+ *
+ * Action names and labels are resolved here, running the macro doesn't search any name.
+ *
+ * @param script	Macro source.
+ * @param line		If not NULL receives the number of the offending line on error.
+ *
+ * @return Compiled macro (release it with lib3270_macro_free) or NULL if failed (sets errno).
+ *
+ * @retval EINVAL	Syntax error or undefined label.
+ * @retval ENOENT	Unknown action.
+ *
+ */
+LIB3270_EXPORT LIB3270_MACRO * lib3270_macro_compile(const char *script, unsigned int *line);
+
+LIB3270_EXPORT void lib3270_macro_free(LIB3270_MACRO *macro);
+
+/**
+ * @brief Get the number of compiled steps.
+ *
+ */
+LIB3270_EXPORT unsigned int lib3270_macro_get_length(const LIB3270_MACRO *macro);
+
+/**
+ * @brief Run a macro, return when it finishes.
+ *
+ * @param hSession	TN3270 Session handle.
+ * @param macro		Compiled macro.
+ * @param seconds	Timeout for the wait steps without an explicit one (0 = no timeout).
+ * @param exit_code	If not NULL receives the code of the exit step (0 if the macro ended without one).
+ *
+ * @return 0 if the macro finished (by an exit step or the end of the script), error code if failed.
+ *
+ * @retval EBUSY		The session is already running a macro.
+ * @retval ETIMEDOUT	A wait step timed out.
+ * @retval ENOTCONN		The session was disconnected.
+ * @retval EPERM		The keyboard is locked by an operator error.
+ * @retval ELOOP		Too many steps without waiting for the host.
+ *
+ */
+LIB3270_EXPORT int lib3270_macro_run(H3270 *hSession, const LIB3270_MACRO *macro, int seconds, int *exit_code);
+
+/**
+ * @brief Start a macro on the session event loop.
+ *
+ * Returns immediately, the macro runs as the host answers and the handler is
+ * called when it finishes (with the same codes of lib3270_macro_run). The macro
+ * must be kept until the handler is called.
+ *
+ * @param hSession	TN3270 Session handle.
+ * @param macro		Compiled macro.
+ * @param seconds	Timeout for the wait steps without an explicit one (0 = no timeout).
+ * @param handler	Completion handler (can be NULL).
+ * @param userdata	Argument for the handler.
+ *
+ * @return 0 if the macro was started, error code if not.
+ *
+ * @retval EBUSY	The session is already running a macro.
+ *
+ */
+LIB3270_EXPORT int lib3270_macro_start(H3270 *hSession, const LIB3270_MACRO *macro, int seconds, LIB3270_MACRO_HANDLER handler, void *userdata);
+
+/**
+ * @brief Stop the macro running on the session.
+ *
+ * The completion handler is called with ECANCELED.
+ *
+ * @return 0 if ok, ENOENT if the session isn't running a macro.
+ *
+ */
+LIB3270_EXPORT int lib3270_macro_cancel(H3270 *hSession);
+
+LIB3270_EXPORT int lib3270_macro_is_running(const H3270 *hSession);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LIB3270_MACRO_H_INCLUDED
@@ -39,6 +39,8 @@
 #define LIB3270_PROPERTIES_H_INCLUDED
 
 #include <lib3270.h>
+#include <lib3270/actions.h>
+#include <lib3270/toggle.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -116,6 +118,51 @@ LIB3270_EXPORT const LIB3270_STRING_PROPERTY * lib3270_get_string_properties_lis
  */
 LIB3270_EXPORT const LIB3270_PROPERTY * lib3270_property_get_by_name(const char *name);
 
+/**
+ * @brief Type of a resolved name.
+ *
+ * When a name is used by more than one table lib3270_resolve_name() returns the first one in this order.
+ */
+typedef enum _lib3270_name_type {
+	LIB3270_NAME_ACTION,		///< @brief Action (LIB3270_ACTION).
+	LIB3270_NAME_TOGGLE,		///< @brief Toggle (LIB3270_TOGGLE).
+	LIB3270_NAME_BOOLEAN,		///< @brief Boolean property (LIB3270_INT_PROPERTY).
+	LIB3270_NAME_INT,			///< @brief Signed int property (LIB3270_INT_PROPERTY).
+	LIB3270_NAME_UINT,			///< @brief Unsigned int property (LIB3270_UINT_PROPERTY).
+	LIB3270_NAME_STRING			///< @brief String property (LIB3270_STRING_PROPERTY).
+} LIB3270_NAME_TYPE;
+
+/**
+ * @brief Resolved name.
+ */
+typedef struct _lib3270_resolved_name {
+	LIB3270_NAME_TYPE type;
+	union {
+		const LIB3270_PROPERTY			* property;		///< @brief Common header of all types.
+		const LIB3270_ACTION			* action;
+		const LIB3270_TOGGLE			* toggle;
+		const LIB3270_INT_PROPERTY		* int_property;		///< @brief Boolean or signed int property.
+		const LIB3270_UINT_PROPERTY		* uint_property;
+		const LIB3270_STRING_PROPERTY	* string_property;
+	} value;
+} LIB3270_RESOLVED_NAME;
+
+/**
+ * @brief Resolve the name of an action, toggle or property.
+ *
+ * Names are compared ignoring case and non alphanumeric characters ("host_type" matches "HostType")
+ * using an index built on the first call; the returned handle is static and can be kept to
+ * avoid repeating the lookup.
+ *
+ * @param name	Name to search.
+ *
+ * @return Resolved name or NULL if not found (sets errno).
+ *
+ * @retval ENOENT	No action, toggle or property with this name.
+ *
+ */
+LIB3270_EXPORT const LIB3270_RESOLVED_NAME * lib3270_resolve_name(const char *name);
+
 /**
  * @brief Get lib3270 integer property by name.
  *
@@ -188,6 +235,55 @@ LIB3270_EXPORT int lib3270_set_boolean_property(H3270 * hSession, const char *na
  */
 LIB3270_EXPORT int lib3270_set_string_property(H3270 * hSession, const char *name, const char * value, int seconds);
 
+/// @brief Operation on a property batch.
+typedef enum _lib3270_property_operation {
+	LIB3270_PROPERTY_GET,		///< @brief Get the property value.
+	LIB3270_PROPERTY_SET		///< @brief Set the property value.
+} LIB3270_PROPERTY_OPERATION;
+
+/**
+ * @brief Item of a property batch.
+ *
+ * For LIB3270_PROPERTY_SET 'type' is the type of the supplied value, the property is searched
+ * as in the lib3270_set_*_property() call for the same type (a string value is converted to the
+ * property type); for LIB3270_PROPERTY_GET it receives the type of the property.
+ *
+ */
+typedef struct _lib3270_property_item {
+	const char						* name;			///< @brief Property name.
+	LIB3270_PROPERTY_OPERATION		  operation;
+	LIB3270_NAME_TYPE				  type;			///< @brief Value type (LIB3270_NAME_BOOLEAN, LIB3270_NAME_INT, LIB3270_NAME_UINT or LIB3270_NAME_STRING).
+	union {
+		int							  int_value;	///< @brief Boolean or signed int value.
+		unsigned int				  uint_value;
+		const char					* string_value;	///< @brief String value (from get: static, valid until the property changes).
+	} value;
+	const LIB3270_RESOLVED_NAME		* resolved;		///< @brief Resolved property (NULL to search the name, kept for the next batch).
+	int								  rc;			///< @brief Result (0 or error code).
+} LIB3270_PROPERTY_ITEM;
+
+/**
+ * @brief Get and set several properties at once.
+ *
+ * The names are resolved before the first change (the resolved property is kept on the item so
+ * the batch can be repeated without searching again), the session waits for "ready" at most once
+ * and the items are applied in order without running the event loop, so no host data is processed
+ * between them.
+ *
+ * @param hSession	Session handle.
+ * @param items		Operations, receive the values and the per item results.
+ * @param count		Number of items.
+ * @param seconds	Time (in seconds) whe should wait for "ready" state (0 = none).
+ *
+ * @return 0 if all items succeeded, the error code of the first failed item if not (sets errno).
+ *
+ * @retval ENOENT		Can't find a property with the item name (no item was applied).
+ * @retval EINVAL		Invalid operation or value type (no item was applied).
+ * @retval EPERM		Property is read only (or write only on get).
+ *
+ */
+LIB3270_EXPORT int lib3270_property_batch(H3270 *hSession, LIB3270_PROPERTY_ITEM *items, unsigned int count, int seconds);
+
 
 /**
  * @brief Get Oversize.
@@ -0,0 +1,247 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como stats.h e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+#ifndef LIB3270_STATS_H_INCLUDED
+
+#define LIB3270_STATS_H_INCLUDED 1
+
+#include <lib3270.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Data stream processing stages.
+ *
+ * The stages are nested (telnet > process_ds > ctlr_write > screen_update),
+ * each counter includes the time spent on the inner ones.
+ *
+ */
+typedef enum _lib3270_stage {
+	LIB3270_STAGE_TELNET,			///< @brief Telnet parser (lib3270_data_recv).
+	LIB3270_STAGE_PROCESS_DS,		///< @brief 3270 command processing (process_ds).
+	LIB3270_STAGE_CTLR_WRITE,		///< @brief Write orders (ctlr_write).
+	LIB3270_STAGE_SCREEN_UPDATE,	///< @brief Screen rendering (screen_update).
+
+	LIB3270_STAGE_COUNT				///< @brief Number of stages.
+} LIB3270_STAGE;
+
+typedef struct _lib3270_stage_counter {
+	unsigned long long	calls;		///< @brief Number of calls.
+	unsigned long long	ticks;		///< @brief Accumulated time (see lib3270_get_ticks).
+} LIB3270_STAGE_COUNTER;
+
+/**
+ * @brief Get the timestamp used by the stage counters.
+ *
+ * @return CPU cycles (TSC) on x86, nanoseconds on other architectures.
+ *
+ */
+LIB3270_EXPORT unsigned long long lib3270_get_ticks(void);
+
+/**
+ * @brief Enable/disable the per stage timing.
+ *
+ * @param hSession	TN3270 Session handle.
+ * @param enable	Non zero to collect timing.
+ *
+ * @return 0 if ok, error code if not.
+ *
+ */
+LIB3270_EXPORT int lib3270_set_stage_timing(H3270 *hSession, int enable);
+LIB3270_EXPORT int lib3270_get_stage_timing(const H3270 *hSession);
+
+/**
+ * @brief Get the stage counters.
+ *
+ * @param hSession	TN3270 Session handle.
+ * @param counters	Array to receive the counters.
+ * @param count		Number of elements in counters (up to LIB3270_STAGE_COUNT).
+ *
+ * @return 0 if ok, error code if not.
+ *
+ */
+LIB3270_EXPORT int lib3270_get_stage_counters(const H3270 *hSession, LIB3270_STAGE_COUNTER *counters, size_t count);
+
+LIB3270_EXPORT void lib3270_reset_stage_counters(H3270 *hSession);
+
+LIB3270_EXPORT const char * lib3270_get_stage_name(LIB3270_STAGE stage);
+
+/// @brief Number of buckets on the latency histograms.
+#define LIB3270_HISTOGRAM_BUCKETS	20
+
+/**
+ * @brief Latency histogram.
+ *
+ * Values are in microseconds; bucket 'n' counts the samples above the bound
+ * of bucket 'n-1' up to lib3270_get_histogram_bound(n), the last one has no
+ * upper bound.
+ *
+ */
+typedef struct _lib3270_histogram {
+	unsigned long long	count;								///< @brief Number of samples.
+	unsigned long long	sum;								///< @brief Sum of all samples (in microseconds).
+	unsigned long long	buckets[LIB3270_HISTOGRAM_BUCKETS];	///< @brief Samples per bucket (not cumulative).
+} LIB3270_HISTOGRAM;
+
+/**
+ * @brief Session performance counters.
+ *
+ * Counters are cumulative since the session creation (or lib3270_reset_stats),
+ * they are not cleared on reconnect.
+ *
+ */
+typedef struct _lib3270_stats {
+	unsigned long long	bytes_received;			///< @brief Bytes received from host.
+	unsigned long long	bytes_sent;				///< @brief Bytes sent to host.
+	unsigned long long	records_received;		///< @brief Records (EOR) received from host.
+	unsigned long long	records_sent;			///< @brief Records sent to host.
+	unsigned long long	connects;				///< @brief Number of connections.
+	unsigned long long	reconnects;				///< @brief Number of connections after the first one.
+	unsigned long long	typeahead;				///< @brief Current typeahead queue depth.
+	unsigned long long	typeahead_max;			///< @brief Maximum typeahead queue depth.
+	unsigned long long	typeahead_dropped;		///< @brief Actions dropped because the typeahead queue was full.
+
+	LIB3270_HISTOGRAM	response;				///< @brief Host response time, from AID to keyboard unlock.
+	LIB3270_HISTOGRAM	process_ds;				///< @brief Time processing 3270 commands.
+	LIB3270_HISTOGRAM	screen_update;			///< @brief Time updating the screen.
+	LIB3270_HISTOGRAM	tls_handshake;			///< @brief TLS/SSL negotiation time.
+} LIB3270_STATS;
+
+/**
+ * @brief Get a snapshot of the session counters.
+ *
+ * The counters are updated without locks by the session thread, the snapshot can
+ * be taken from any thread; each value is consistent but the set is not atomic.
+ *
+ * @param hSession	TN3270 Session handle.
+ * @param stats		Structure to receive the counters.
+ *
+ * @return 0 if ok, error code if not.
+ *
+ */
+LIB3270_EXPORT int lib3270_get_stats(const H3270 *hSession, LIB3270_STATS *stats);
+
+/**
+ * @brief Reset the session counters.
+ *
+ * Clears the counters and histograms with the same relaxed atomic stores used to
+ * update them; the current typeahead depth is kept, it's a gauge, and becomes the
+ * new maximum. A concurrent lib3270_get_stats() can see a partially reset set.
+ *
+ * @param hSession	TN3270 Session handle.
+ *
+ */
+LIB3270_EXPORT void lib3270_reset_stats(H3270 *hSession);
+
+/**
+ * @brief Get the upper bound of a histogram bucket.
+ *
+ * @return Bucket upper bound in microseconds, 0 for the last (unbounded) bucket.
+ *
+ */
+LIB3270_EXPORT unsigned long long lib3270_get_histogram_bound(size_t bucket);
+
+/**
+ * @brief Format the session counters in the Prometheus text exposition format.
+ *
+ * @param hSession	TN3270 Session handle.
+ * @param labels	Labels to add on every sample (ex: 'session="a"'), NULL for none.
+ *
+ * @return Formatted counters (release it with lib3270_free).
+ *
+ */
+LIB3270_EXPORT char * lib3270_get_stats_prometheus(const H3270 *hSession, const char *labels);
+
+/// @brief Number of finished spans kept by the session.
+#define LIB3270_AID_SPAN_QUEUE	64
+
+/**
+ * @brief AID round trip, from the AID key to the keyboard unlock.
+ *
+ * Timestamps are in microseconds from the same monotonic clock, 0 if the
+ * event didn't happen.
+ *
+ */
+typedef struct _lib3270_aid_span {
+	unsigned char		aid;				///< @brief AID code.
+	unsigned long long	sent;				///< @brief AID sent to host.
+	unsigned long long	first_record;		///< @brief First record received from host.
+	unsigned long long	host_unlock;		///< @brief Host allowed the keyboard unlock (start of the unlock delay).
+	unsigned long long	unlocked;			///< @brief Keyboard unlocked.
+	unsigned long long	unlock_delay;		///< @brief Time on the artificial unlock delay (microseconds).
+	unsigned long long	latency;			///< @brief Round trip time (microseconds), without unlock delay if requested.
+	unsigned long long	bytes_sent;			///< @brief Bytes sent during the span.
+	unsigned long long	bytes_received;		///< @brief Bytes received during the span.
+	unsigned int		host_writes;		///< @brief Number of host write commands.
+} LIB3270_AID_SPAN;
+
+typedef void (*LIB3270_AID_SPAN_HANDLER)(H3270 *hSession, const LIB3270_AID_SPAN *span, void *userdata);
+
+/**
+ * @brief Set the handler called (on the session thread) when a span finishes.
+ *
+ * @param hSession	TN3270 Session handle.
+ * @param handler	Span handler (NULL to disable).
+ * @param userdata	Argument to the handler.
+ *
+ */
+LIB3270_EXPORT void lib3270_set_aid_span_handler(H3270 *hSession, LIB3270_AID_SPAN_HANDLER handler, void *userdata);
+
+/**
+ * @brief Get the finished spans, oldest first.
+ *
+ * The session keeps the last LIB3270_AID_SPAN_QUEUE spans, new ones are dropped
+ * while the queue is full. Can be called from any thread (single reader).
+ *
+ * @param hSession	TN3270 Session handle.
+ * @param spans		Array to receive the spans.
+ * @param count		Length of the array.
+ *
+ * @return Number of spans removed from the queue.
+ *
+ */
+LIB3270_EXPORT size_t lib3270_get_aid_spans(H3270 *hSession, LIB3270_AID_SPAN *spans, size_t count);
+
+/**
+ * @brief Exclude the unlock delay from the span latency and the response histogram.
+ *
+ * @see lib3270_set_unlock_delay
+ *
+ */
+LIB3270_EXPORT int lib3270_set_exclude_unlock_delay(H3270 *hSession, int enable);
+LIB3270_EXPORT int lib3270_get_exclude_unlock_delay(const H3270 *hSession);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LIB3270_STATS_H_INCLUDED
@@ -47,6 +47,41 @@ extern "C" {
 
 typedef int (*LIB3270_TRACE_HANDLER)(const H3270 *, void *, const char *);
 
+/**
+ * @brief Binary trace file layout.
+ *
+ * The file starts with a LIB3270_BINARY_TRACE_HEADER followed by records; every record is
+ * a LIB3270_BINARY_TRACE_RECORD followed by 'length' bytes of payload. All the integers
+ * are little endian.
+ *
+ */
+#define LIB3270_BINARY_TRACE_MAGIC		"L3270BT"
+#define LIB3270_BINARY_TRACE_VERSION	1
+
+typedef enum _lib3270_binary_trace_type {
+	LIB3270_BINARY_TRACE_DATA,			///< @brief Raw network data.
+	LIB3270_BINARY_TRACE_CONNECT,		///< @brief Session connected, the payload is the host URL.
+	LIB3270_BINARY_TRACE_DISCONNECT,	///< @brief Session disconnected.
+	LIB3270_BINARY_TRACE_MODEL			///< @brief Terminal model, written before the connect record; the payload is the model number and the oversize (if any) as text ("2" or "2 100x40").
+} LIB3270_BINARY_TRACE_TYPE;
+
+typedef struct _lib3270_binary_trace_header {
+	char			magic[8];			///< @brief LIB3270_BINARY_TRACE_MAGIC
+	unsigned char	version[2];			///< @brief LIB3270_BINARY_TRACE_VERSION
+	unsigned char	record_size[2];		///< @brief Size of the record header.
+	unsigned char	reserved[4];
+} LIB3270_BINARY_TRACE_HEADER;
+
+typedef struct _lib3270_binary_trace_record {
+	unsigned char	length[4];			///< @brief Payload length.
+	unsigned char	type;				///< @brief Record type (LIB3270_BINARY_TRACE_TYPE).
+	unsigned char	direction;			///< @brief '<' for data received, '>' for data sent.
+	unsigned char	id;					///< @brief Session identifier (lib3270_get_session_id()).
+	unsigned char	reserved;
+	unsigned char	serial[4];			///< @brief Session number, unique inside the process.
+	unsigned char	timestamp[8];		///< @brief Microseconds since the epoch.
+} LIB3270_BINARY_TRACE_RECORD;
+
 /**
  * @brief Set trace filename.
  *
@@ -65,6 +100,60 @@ LIB3270_EXPORT int lib3270_set_trace_filename(H3270 * hSession, const char *name
  */
 LIB3270_EXPORT const char * lib3270_get_trace_filename(const H3270 * hSession);
 
+/**
+ * @brief Write all the buffered trace data to the trace file.
+ *
+ * The trace file is written by a background thread; this call blocks until
+ * everything traced so far is on the file.
+ *
+ * @param hSession	TN3270 Session handle.
+ *
+ */
+LIB3270_EXPORT void lib3270_flush_trace(H3270 *hSession);
+
+/**
+ * @brief Set the trace file size limit.
+ *
+ * When the trace file reaches the limit it's renamed to "name.1" and a new one is started; the size
+ * is checked before each batched write, so the file can go over the limit by up to one batch.
+ *
+ * @param hSession	TN3270 Session handle.
+ * @param kbytes	Maximum file size in kbytes (0 for no limit).
+ *
+ */
+LIB3270_EXPORT int lib3270_set_trace_max_size(H3270 *hSession, unsigned int kbytes);
+
+/**
+ * @brief Get the trace file size limit.
+ *
+ * @param hSession	TN3270 Session handle.
+ * @return Maximum file size in kbytes (0 for no limit).
+ *
+ */
+LIB3270_EXPORT unsigned int lib3270_get_trace_max_size(const H3270 *hSession);
+
+/**
+ * @brief Set binary trace file name.
+ *
+ * When set, every network block sent or received is written, without formatting, to the
+ * binary trace file regardless of the trace toggles; use lib3270-tracedump to render it.
+ * Sessions can share the same file, the records are tagged with the session.
+ *
+ * @param hSession	TN3270 Session handle.
+ * @param name		The binary trace file name (null to disable).
+ *
+ */
+LIB3270_EXPORT int lib3270_set_binary_trace_filename(H3270 * hSession, const char *name);
+
+/**
+ * @brief Get binary trace file name.
+ *
+ * @param hSession	TN3270 Session handle.
+ * @return The binary trace file name or NULL if disabled.
+ *
+ */
+LIB3270_EXPORT const char * lib3270_get_binary_trace_filename(const H3270 * hSession);
+
 /**
  * @brief Set trace handle callback.
  *
@@ -229,6 +229,24 @@ LIB3270_INTERNAL int lib3270_socket_send_failed(H3270 *hSession);
 
 LIB3270_INTERNAL int lib3270_socket_set_non_blocking(H3270 *hSession, int sock, const unsigned char on);
 
+/**
+ * @brief Apply the session's socket tuning profile to the connected socket.
+ *
+ * Failures are not fatal, they're only reported on the network trace.
+ *
+ * @param hSession	TN3270 Session handle.
+ *
+ */
+LIB3270_INTERNAL void lib3270_network_apply_profile(H3270 *hSession);
+
+/**
+ * @brief Re-arm TCP quick ACK after a receive, the caller checks for the latency profile.
+ *
+ * @param hSession	TN3270 Session handle.
+ *
+ */
+LIB3270_INTERNAL void lib3270_network_quickack(H3270 *hSession);
+
 /**
  * @breif Select the network context from URL.
  *
@@ -252,6 +270,14 @@ LIB3270_INTERNAL void	  lib3270_set_libssl_network_module(H3270 *hSession);
 
 LIB3270_INTERNAL int	  lib3270_activate_ssl_network_module(H3270 *hSession, int sock);
 
+/**
+ * @brief Select the replay network context (no socket, output is discarded).
+ *
+ * @param hSession	TN3270 Session handle.
+ *
+ */
+LIB3270_INTERNAL void	  lib3270_set_replay_network_module(H3270 *hSession);
+
 
 #endif // LIB3270_NETWORKING_H_INCLUDED
 
@@ -0,0 +1,124 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como statsc.h e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+#ifndef LIB3270_STATSC_H_INCLUDED
+
+#define LIB3270_STATSC_H_INCLUDED 1
+
+#include <lib3270/stats.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#include <time.h>
+
+/// @brief Read the stage timer (cycles on x86, nanoseconds elsewhere).
+static inline unsigned long long stats_ticks(void) {
+#if defined(__i386__) || defined(__x86_64__)
+	return __rdtsc();
+#elif defined(_WIN32)
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (unsigned long long) ((counter.QuadPart * 1000000000.0) / frequency.QuadPart);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return (((unsigned long long) ts.tv_sec) * 1000000000ULL) + ts.tv_nsec;
+#endif
+}
+
+/// @brief Read the monotonic clock used by the histograms (in microseconds).
+static inline unsigned long long stats_clock(void) {
+#ifdef _WIN32
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (unsigned long long) ((counter.QuadPart * 1000000.0) / frequency.QuadPart);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return (((unsigned long long) ts.tv_sec) * 1000000ULL) + (ts.tv_nsec / 1000);
+#endif
+}
+
+/// @brief Update a counter; only the session thread writes, readers use relaxed loads.
+#define stats_add(v,n)	__atomic_store_n(&(v), __atomic_load_n(&(v),__ATOMIC_RELAXED) + (n), __ATOMIC_RELAXED)
+#define stats_set(v,n)	__atomic_store_n(&(v), (n), __ATOMIC_RELAXED)
+
+/// @brief Add a sample (in microseconds) to a histogram.
+LIB3270_INTERNAL void stats_histogram(LIB3270_HISTOGRAM *histogram, unsigned long long value);
+
+/// @brief Add the time since 'started' (from stats_clock) to a histogram.
+#define stats_elapsed(h,started) stats_histogram(&(h),stats_clock() - (started))
+
+/// @brief Start an AID span.
+LIB3270_INTERNAL void span_begin(H3270 *hSession, unsigned char aid);
+
+/// @brief Keyboard unlocked, finish the active span.
+LIB3270_INTERNAL void span_end(H3270 *hSession);
+
+#define span_active(h)		((h)->spans.current.sent != 0)
+#define span_abort(h)		((h)->spans.current.sent = 0)
+
+/// @brief Record received from host.
+#define span_record(h) \
+	do { \
+		if(span_active(h) && !(h)->spans.current.first_record) \
+			(h)->spans.current.first_record = stats_clock(); \
+	} while(0)
+
+/// @brief Host write command.
+#define span_write(h) \
+	do { \
+		if(span_active(h)) \
+			(h)->spans.current.host_writes++; \
+	} while(0)
+
+/// @brief Host allowed the keyboard unlock.
+#define span_host_unlock(h) \
+	do { \
+		if(span_active(h) && !(h)->spans.current.host_unlock) \
+			(h)->spans.current.host_unlock = stats_clock(); \
+	} while(0)
+
+/// @brief Start timing a stage (returns 0 when the stage timing is disabled).
+#define stage_begin(h)		((h)->stages.enabled ? stats_ticks() : 0)
+
+/// @brief Account the time since stage_begin() to the stage.
+#define stage_end(h,s,t) \
+	do { \
+		if(t) { \
+			(h)->stages.counters[s].calls++; \
+			(h)->stages.counters[s].ticks += (stats_ticks() - (t)); \
+		} \
+	} while(0)
+
+#endif // LIB3270_STATSC_H_INCLUDED
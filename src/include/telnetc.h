@@ -49,6 +49,9 @@ LIB3270_INTERNAL void net_exception(H3270 *session, int fd, LIB3270_IO_FLAG flag
 LIB3270_INTERNAL void net_input(H3270 *session, int fd, LIB3270_IO_FLAG flag, void *dunno);
 LIB3270_INTERNAL void net_interrupt(H3270 *hSession);
 LIB3270_INTERNAL void net_output(H3270 *hSession);
+LIB3270_INTERNAL void net_cork(H3270 *hSession);
+LIB3270_INTERNAL void net_uncork(H3270 *hSession);
+LIB3270_INTERNAL void net_flush(H3270 *hSession);
 LIB3270_INTERNAL void net_sendc(H3270 *hSession, char c);
 LIB3270_INTERNAL void net_sends(H3270 *hSession, const char *s);
 LIB3270_INTERNAL void net_send_erase(H3270 *hSession);
@@ -58,7 +61,9 @@ LIB3270_INTERNAL void space3270out(H3270 *hSession, int n);
 
 #if defined(X3270_TRACE)
 LIB3270_INTERNAL void trace_netdata(H3270 *hSession, char direction, unsigned const char *buf, int len);
+#define trace_netdata(hSession, direction, buf, len) \
+	(((hSession)->trace.mask & (TRACE_MASK(LIB3270_TOGGLE_NETWORK_TRACE)|TRACE_MASK(LIB3270_TOGGLE_DS_TRACE))) ? trace_netdata(hSession, direction, buf, len) : (void) 0)
 #else
-#define trace_netdata(direction, buf, len) /* */
+#define trace_netdata(hSession, direction, buf, len) ((void) 0)
 #endif // X3270_TRACE
 
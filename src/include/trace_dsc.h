@@ -31,6 +31,31 @@
  *	@brief Global declarations for trace_ds.c.
  */
 
+typedef struct _trace_writer TRACE_WRITER;
+
+TRACE_WRITER * trace_writer_new(const char *filename, size_t max_size, const void *header, size_t header_length);
+void trace_writer_set_max_size(TRACE_WRITER *writer, size_t max_size);
+void trace_writer_set_interval(TRACE_WRITER *writer, unsigned int seconds);
+int trace_writer_write(TRACE_WRITER *writer, const char *text, size_t length);
+int trace_writer_write_record(TRACE_WRITER *writer, const void *header, size_t header_length, const void *data, size_t length);
+void trace_writer_flush(TRACE_WRITER *writer);
+void trace_writer_free(TRACE_WRITER *writer);
+
+void trace_binary_record(H3270 *hSession, LIB3270_BINARY_TRACE_TYPE type, char direction, const void *data, size_t length);
+
+/// @brief Write the model and connect records of the session to the binary trace file.
+void trace_binary_connect(H3270 *hSession);
+
+/// @brief Write record to the binary trace file (if enabled).
+#define trace_binary(hSession, type, direction, data, length) \
+	do { if((hSession)->trace.binary.writer) trace_binary_record(hSession, type, direction, data, length); } while(0)
+
+/// @brief Bit of a trace toggle on the session trace mask.
+#define TRACE_MASK(toggle)	(1U << (toggle))
+
+/// @brief Rebuild the session trace mask from the toggles.
+void trace_update_mask(H3270 *hSession);
+
 #if defined(X3270_TRACE)
 
 const char *rcba(H3270 *session, int baddr);
@@ -43,19 +68,26 @@ void trace_dsn(H3270 *hSession, const char *fmt, ...) LIB3270_GNUC_FORMAT(2, 3);
 void trace_ssl(H3270 *hSession, const char *fmt, ...) LIB3270_GNUC_FORMAT(2, 3);
 void trace_screen(H3270 *session);
 
-#elif defined(__GNUC__)
+/// @brief Check the trace mask; the trace arguments are only evaluated when the trace is enabled.
+#define trace_enabled(hSession, toggle) ((hSession)->trace.mask & TRACE_MASK(toggle))
 
-#define trace_ds(session, format, args...)
-#define trace_dsn(session, format, args...)
-#define trace_ssl(session, format, args...)
-#define trace_ds_nb(session, format, args...)
+#define trace_ds(hSession, ...)		(trace_enabled(hSession,LIB3270_TOGGLE_DS_TRACE) ? trace_ds(hSession, __VA_ARGS__) : (void) 0)
+#define trace_ds_nb(hSession, ...)	(trace_enabled(hSession,LIB3270_TOGGLE_DS_TRACE) ? trace_ds_nb(hSession, __VA_ARGS__) : (void) 0)
+#define trace_dsn(hSession, ...)	(trace_enabled(hSession,LIB3270_TOGGLE_DS_TRACE) ? trace_dsn(hSession, __VA_ARGS__) : (void) 0)
+#define trace_ssl(hSession, ...)	(trace_enabled(hSession,LIB3270_TOGGLE_SSL_TRACE) ? trace_ssl(hSession, __VA_ARGS__) : (void) 0)
+#define trace_char(hSession, c)		(trace_enabled(hSession,LIB3270_TOGGLE_SCREEN_TRACE) ? trace_char(hSession, c) : (void) 0)
 
 #else
 
-#define trace_ds 0 &&
-#define trace_ds_nb 0 &&
-#define trace_dsn 0 &&
-#define trace_ssl 0 &&
-#define rcba 0 &&
+#define trace_enabled(hSession, toggle) 0
+
+// Consume the session so it doesn't become unused without the traces.
+#define trace_ds(hSession, ...)		((void) (hSession))
+#define trace_ds_nb(hSession, ...)	((void) (hSession))
+#define trace_dsn(hSession, ...)	((void) (hSession))
+#define trace_ssl(hSession, ...)	((void) (hSession))
+#define trace_char(hSession, c)		((void) (hSession))
+#define trace_screen(hSession)		((void) ((hSession)->trace_skipping = 0))
+#define trace_ansi_disc(hSession)	((void) (hSession))
 
 #endif
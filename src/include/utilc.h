@@ -41,6 +41,17 @@ LIB3270_INTERNAL void	  RemoveTimer(H3270 *session, void *cookie);
  */
 LIB3270_INTERNAL char * lib3270_unescape(const char *text);
 
+/**
+ * @brief Format a message on the supplied buffer, allocating a new one if it doesn't fit.
+ *
+ * @param buffer	Preallocated buffer.
+ * @param length	Size of the buffer.
+ *
+ * @return The formatted message; if it's not the supplied buffer it should be released with lib3270_free().
+ *
+ */
+LIB3270_INTERNAL char * lib3270_format_buffer(char *buffer, size_t length, const char *fmt, va_list args);
+
 /**
  * @brief Compare strings ignoring non alphanumeric chars.
  *
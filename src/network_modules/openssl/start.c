@@ -359,6 +359,7 @@ int openssl_network_start_tls(H3270 *hSession) {
 	hSession->ssl.message = lib3270_openssl_message_from_id(verify_result);
 	debug("Verify message: %s",hSession->ssl.message->summary);
 
+#if defined(X3270_TRACE)
 	// Trace cypher
 	if(lib3270_get_toggle(hSession,LIB3270_TOGGLE_SSL_TRACE)) {
 		char				  buffer[4096];
@@ -372,6 +373,7 @@ int openssl_network_start_tls(H3270 *hSession) {
 		          SSL_CIPHER_get_version(cipher),
 		          alg_bits);
 	}
+#endif // X3270_TRACE
 
 	// Check results.
 	if(hSession->ssl.message)
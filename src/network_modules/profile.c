@@ -0,0 +1,144 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como profile.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ */
+
+/**
+ * @brief Socket tuning profiles.
+ *
+ */
+
+#include <config.h>
+#include <lib3270.h>
+#include <lib3270/log.h>
+#include <internals.h>
+#include <networking.h>
+#include <trace_dsc.h>
+
+#ifdef _WIN32
+#include <ws2tcpip.h>
+#else
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif // _WIN32
+
+/// @brief Socket buffer size for the throughput profile.
+#define THROUGHPUT_SOCKET_BUFFER	(256 * 1024)
+
+/*--[ Implement ]------------------------------------------------------------------------------------*/
+
+static const char * profile_names[LIB3270_NETWORK_PROFILE_COUNT] = {
+	"default",
+	"latency",
+	"throughput"
+};
+
+static void set_option(H3270 *hSession, int level, int optname, const char GNUC_UNUSED(*name), int optval) {
+
+	if(hSession->network.module->setsockopt(hSession, level, optname, &optval, sizeof(optval)) < 0) {
+		trace_dsn(hSession,"Can't set %s to %d: %s\n",name,optval,strerror(errno));
+	} else {
+		trace_dsn(hSession,"Network option %s is %d\n",name,optval);
+	}
+
+}
+
+void lib3270_network_apply_profile(H3270 *hSession) {
+
+	trace_dsn(hSession,"Applying '%s' network profile\n",profile_names[hSession->network.profile]);
+
+	switch(hSession->network.profile) {
+	case LIB3270_NETWORK_PROFILE_LATENCY:
+		// Interactive AIDs are small, don't let Nagle hold them waiting for a delayed ACK.
+		set_option(hSession, IPPROTO_TCP, TCP_NODELAY, "TCP_NODELAY", 1);
+		lib3270_network_quickack(hSession);
+		break;
+
+	case LIB3270_NETWORK_PROFILE_THROUGHPUT:
+		set_option(hSession, IPPROTO_TCP, TCP_NODELAY, "TCP_NODELAY", 0);
+		set_option(hSession, SOL_SOCKET, SO_SNDBUF, "SO_SNDBUF", THROUGHPUT_SOCKET_BUFFER);
+		set_option(hSession, SOL_SOCKET, SO_RCVBUF, "SO_RCVBUF", THROUGHPUT_SOCKET_BUFFER);
+		break;
+
+	default:
+		// Keep the system defaults.
+		break;
+
+	}
+
+}
+
+void lib3270_network_quickack(H3270 *hSession) {
+
+#ifdef TCP_QUICKACK
+	// TCP_QUICKACK isn't sticky, the kernel may fall back to delayed ACKs after each receive.
+	int optval = 1;
+	hSession->network.module->setsockopt(hSession, IPPROTO_TCP, TCP_QUICKACK, &optval, sizeof(optval));
+#else
+	(void) hSession;
+#endif // TCP_QUICKACK
+
+}
+
+LIB3270_EXPORT int lib3270_set_network_profile(H3270 *hSession, LIB3270_NETWORK_PROFILE profile) {
+
+	if((int) profile < 0 || profile >= LIB3270_NETWORK_PROFILE_COUNT)
+		return errno = EINVAL;
+
+	if(profile == hSession->network.profile)
+		return 0;
+
+	// The socket buffers can't be given back to the system autotuning, only new connections get the profile.
+	if(hSession->connection.state != LIB3270_NOT_CONNECTED)
+		return errno = EISCONN;
+
+	hSession->network.profile = profile;
+
+	return 0;
+}
+
+LIB3270_EXPORT LIB3270_NETWORK_PROFILE lib3270_get_network_profile(const H3270 *hSession) {
+	return hSession->network.profile;
+}
+
+LIB3270_EXPORT int lib3270_set_network_profile_by_name(H3270 *hSession, const char *name) {
+
+	size_t ix;
+
+	if(!name)
+		return lib3270_set_network_profile(hSession,LIB3270_NETWORK_PROFILE_DEFAULT);
+
+	for(ix = 0; ix < LIB3270_NETWORK_PROFILE_COUNT; ix++) {
+		if(!strcasecmp(name,profile_names[ix]))
+			return lib3270_set_network_profile(hSession,(LIB3270_NETWORK_PROFILE) ix);
+	}
+
+	return errno = EINVAL;
+}
+
+LIB3270_EXPORT const char * lib3270_get_network_profile_name(const H3270 *hSession) {
+	return profile_names[hSession->network.profile];
+}
@@ -0,0 +1,159 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como main.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Replay network methods.
+ *
+ * Network module without a socket; the host data is injected with lib3270_data_recv()
+ * and everything sent by the session is discarded.
+ *
+ */
+
+#include "private.h"
+#include <errno.h>
+#include <lib3270/internals.h>
+
+static void replay_network_finalize(H3270 *hSession) {
+
+	debug("%s",__FUNCTION__);
+
+	if(hSession->network.context) {
+		lib3270_free(hSession->network.context);
+		hSession->network.context = NULL;
+	}
+
+}
+
+static int replay_network_disconnect(H3270 *hSession) {
+	hSession->network.context->connected = 0;
+	return 0;
+}
+
+static void replay_network_reset(H3270 GNUC_UNUSED(*hSession)) {
+}
+
+static ssize_t replay_network_send(H3270 GNUC_UNUSED(*hSession), const void GNUC_UNUSED(*buffer), size_t length) {
+	return length;
+}
+
+static ssize_t replay_network_recv(H3270 GNUC_UNUSED(*hSession), void GNUC_UNUSED(*buf), size_t GNUC_UNUSED(len)) {
+	return -EWOULDBLOCK;
+}
+
+static int replay_network_getsockname(const H3270 GNUC_UNUSED(*hSession), struct sockaddr GNUC_UNUSED(*addr), socklen_t GNUC_UNUSED(*addrlen)) {
+	errno = ENOTSOCK;
+	return -1;
+}
+
+static void * replay_network_add_poll(H3270 GNUC_UNUSED(*hSession), LIB3270_IO_FLAG GNUC_UNUSED(flag), void GNUC_UNUSED(*call)(H3270 *, int, LIB3270_IO_FLAG, void *), void GNUC_UNUSED(*userdata)) {
+	return NULL;
+}
+
+static int replay_network_non_blocking(H3270 GNUC_UNUSED(*hSession), const unsigned char GNUC_UNUSED(on)) {
+	return 0;
+}
+
+static int replay_network_is_connected(const H3270 *hSession) {
+	return hSession->network.context->connected;
+}
+
+static int replay_network_setsockopt(H3270 GNUC_UNUSED(*hSession), int GNUC_UNUSED(level), int GNUC_UNUSED(optname), const void GNUC_UNUSED(*optval), size_t GNUC_UNUSED(optlen)) {
+	errno = ENOTSOCK;
+	return -1;
+}
+
+static int replay_network_getsockopt(H3270 GNUC_UNUSED(*hSession), int GNUC_UNUSED(level), int GNUC_UNUSED(optname), void GNUC_UNUSED(*optval), socklen_t GNUC_UNUSED(*optlen)) {
+	errno = ENOTSOCK;
+	return -1;
+}
+
+static int replay_network_init(H3270 GNUC_UNUSED(*hSession)) {
+	return 0;
+}
+
+static int replay_network_connect(H3270 GNUC_UNUSED(*hSession), LIB3270_NETWORK_STATE *state) {
+	// There's no host, use lib3270_replay_connect().
+	state->syserror = ENOTSUP;
+	return -1;
+}
+
+static int replay_network_start_tls(H3270 GNUC_UNUSED(*hSession)) {
+	return ENOTSUP;
+}
+
+void lib3270_set_replay_network_module(H3270 *hSession) {
+
+	static const LIB3270_NET_MODULE module = {
+		.name = "replay",
+		.service = "0",
+		.init = replay_network_init,
+		.finalize = replay_network_finalize,
+		.connect = replay_network_connect,
+		.disconnect = replay_network_disconnect,
+		.start_tls = replay_network_start_tls,
+		.send = replay_network_send,
+		.recv = replay_network_recv,
+		.add_poll = replay_network_add_poll,
+		.non_blocking = replay_network_non_blocking,
+		.is_connected = replay_network_is_connected,
+		.getsockname = replay_network_getsockname,
+		.getpeername = replay_network_getsockname,
+		.setsockopt = replay_network_setsockopt,
+		.getsockopt = replay_network_getsockopt,
+		.reset = replay_network_reset
+	};
+
+	debug("%s",__FUNCTION__);
+
+	if(hSession->network.context) {
+		// Has context, finalize it.
+		hSession->network.module->finalize(hSession);
+	}
+
+	hSession->ssl.host = 0;
+	hSession->network.context = lib3270_malloc(sizeof(LIB3270_NET_CONTEXT));
+	memset(hSession->network.context,0,sizeof(LIB3270_NET_CONTEXT));
+
+	hSession->network.module = &module;
+
+}
+
+LIB3270_EXPORT int lib3270_replay_connect(H3270 *hSession) {
+
+	FAIL_IF_ONLINE(hSession);
+
+	lib3270_set_replay_network_module(hSession);
+	hSession->network.context->connected = 1;
+
+	lib3270_setup_session(hSession);
+	lib3270_set_connected_initial(hSession);
+
+	return 0;
+
+}
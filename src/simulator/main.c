@@ -0,0 +1,231 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como main.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Loopback TN3270/TN3270E host simulator.
+ *
+ * Usage: lib3270-simulator [--port=3270] [--script=file] [--mode=tn3270|tn3270e] [--once] [--verbose]
+ *
+ * Connect with "tn3270://127.0.0.1:3270".
+ *
+ */
+
+#include "private.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <getopt.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+/*---[ Implement ]------------------------------------------------------------------------------------------*/
+
+static int serve(int sock, const SIMULATOR_SCRIPT *script, int verbose) {
+
+	SIMULATOR	  simulator;
+	int			  rc;
+	int			  on = 1;
+
+	memset(&simulator,0,sizeof(simulator));
+	simulator.sock = sock;
+	simulator.script = script;
+	simulator.verbose = verbose ? 1 : 0;
+
+	setsockopt(sock,IPPROTO_TCP,TCP_NODELAY,&on,sizeof(on));
+
+	rc = simulator_negotiate(&simulator,SIMULATOR_EXPECT_TIMEOUT);
+	if(rc) {
+		fprintf(stderr,"Negotiation failed: %s\n",strerror(rc));
+	} else {
+		rc = simulator_script_run(&simulator);
+		if(rc)
+			fprintf(stderr,"Script failed: %s\n",strerror(rc));
+	}
+
+	fprintf(
+		stderr,
+		"Session closed (%s): %lu bytes/%lu records received, %lu bytes/%lu records sent\n",
+			simulator.tn3270e ? "TN3270E" : "TN3270",
+			simulator.stats.bytes_in,
+			simulator.stats.records_in,
+			simulator.stats.bytes_out,
+			simulator.stats.records_out
+	);
+
+	while(simulator.pending.count) {
+		SIMULATOR_RECORD record;
+		simulator_get_record(&simulator,&record);
+		free(record.data);
+	}
+
+	free(simulator.input.data);
+	close(sock);
+
+	return rc;
+
+}
+
+int main(int argc, char *argv[]) {
+
+	static const struct option options[] = {
+		{ "port",		required_argument,	0,	'p' },
+		{ "script",		required_argument,	0,	's' },
+		{ "mode",		required_argument,	0,	'm' },
+		{ "once",		no_argument,		0,	'1' },
+		{ "verbose",	no_argument,		0,	'v' },
+		{ 0, 0, 0, 0}
+	};
+
+	unsigned short		  port		= 3270;
+	const char			* filename	= NULL;
+	const char			* mode		= NULL;
+	int					  once		= 0;
+	int					  verbose	= 0;
+	int					  opt;
+
+	while((opt = getopt_long(argc, argv, "p:s:m:1v", options, NULL)) != -1) {
+		switch(opt) {
+		case 'p':
+			port = (unsigned short) atoi(optarg);
+			break;
+
+		case 's':
+			filename = optarg;
+			break;
+
+		case 'm':
+			mode = optarg;
+			break;
+
+		case '1':
+			once = 1;
+			break;
+
+		case 'v':
+			verbose = 1;
+			break;
+
+		default:
+			fprintf(stderr,"Usage: %s [--port=3270] [--script=file] [--mode=tn3270|tn3270e] [--once] [--verbose]\n",argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	SIMULATOR_SCRIPT *script = simulator_script_load(filename);
+	if(!script)
+		return EXIT_FAILURE;
+
+	if(mode) {
+		if(!strcasecmp(mode,"tn3270e")) {
+			script->tn3270e = 1;
+		} else if(!strcasecmp(mode,"tn3270")) {
+			script->tn3270e = 0;
+		} else {
+			fprintf(stderr,"Invalid mode \"%s\"\n",mode);
+			simulator_script_free(script);
+			return EXIT_FAILURE;
+		}
+	}
+
+	int listener = socket(AF_INET,SOCK_STREAM,0);
+	if(listener < 0) {
+		perror("socket");
+		simulator_script_free(script);
+		return EXIT_FAILURE;
+	}
+
+	int on = 1;
+	setsockopt(listener,SOL_SOCKET,SO_REUSEADDR,&on,sizeof(on));
+
+	// Loopback only, this is a test tool.
+	struct sockaddr_in addr;
+	memset(&addr,0,sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if(bind(listener,(struct sockaddr *) &addr,sizeof(addr)) || listen(listener,16)) {
+		perror("bind");
+		close(listener);
+		simulator_script_free(script);
+		return EXIT_FAILURE;
+	}
+
+	fprintf(stderr,"Listening on 127.0.0.1:%u (%s)\n",(unsigned int) port, script->tn3270e ? "TN3270E" : "TN3270");
+
+	signal(SIGCHLD,SIG_IGN);
+	signal(SIGPIPE,SIG_IGN);
+
+	int rc = 0;
+
+	for(;;) {
+
+		int sock = accept(listener,NULL,NULL);
+
+		if(sock < 0) {
+			if(errno == EINTR)
+				continue;
+			perror("accept");
+			rc = errno;
+			break;
+		}
+
+		if(once) {
+			rc = serve(sock,script,verbose);
+			break;
+		}
+
+		pid_t pid = fork();
+
+		if(pid == 0) {
+			close(listener);
+			rc = serve(sock,script,verbose);
+			simulator_script_free(script);
+			return rc ? EXIT_FAILURE : EXIT_SUCCESS;
+		}
+
+		if(pid < 0)
+			perror("fork");
+
+		close(sock);
+
+	}
+
+	close(listener);
+	simulator_script_free(script);
+
+	return rc ? EXIT_FAILURE : EXIT_SUCCESS;
+
+}
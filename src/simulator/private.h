@@ -0,0 +1,156 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como private.h e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Loopback TN3270/TN3270E host simulator.
+ *
+ * Scriptable host for offline tests and benchmarks, speaks just enough of
+ * the telnet negotiation to bring lib3270 into 3270 mode.
+ *
+ */
+
+#ifndef SIMULATOR_PRIVATE_H_INCLUDED
+
+#define SIMULATOR_PRIVATE_H_INCLUDED
+
+#include <stdio.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+/// @brief Maximum number of inbound records waiting for an 'expect'.
+#define SIMULATOR_MAX_PENDING	16
+
+/// @brief Default timeout for 'expect' (in milliseconds).
+#define SIMULATOR_EXPECT_TIMEOUT	30000
+
+/// @brief Script commands.
+typedef enum _simulator_command_type {
+	SIMULATOR_SEND,			///< @brief Send a 3270 record.
+	SIMULATOR_NVT,			///< @brief Send NVT (ANSI) data.
+	SIMULATOR_EXPECT,		///< @brief Wait for an inbound record with the selected AID.
+	SIMULATOR_SLEEP,		///< @brief Wait for some milliseconds.
+	SIMULATOR_REPEAT,		///< @brief Start of a repeat block.
+	SIMULATOR_END,			///< @brief End of a repeat block.
+	SIMULATOR_CLOSE			///< @brief Close the connection.
+} SIMULATOR_COMMAND_TYPE;
+
+typedef struct _simulator_command {
+	SIMULATOR_COMMAND_TYPE	  type;
+	unsigned int			  line;			///< @brief Script line (for messages).
+	unsigned char			* data;			///< @brief Data to send.
+	size_t					  length;		///< @brief Length of data.
+	int						  aid;			///< @brief AID to expect (-1 = any).
+	unsigned long			  value;		///< @brief Timeout, delay or repeat count.
+	size_t					  jump;			///< @brief For 'end', index of the matching 'repeat'.
+} SIMULATOR_COMMAND;
+
+typedef struct _simulator_script {
+	unsigned int			  tn3270e	: 1;	///< @brief Negotiate TN3270E.
+	unsigned short			  columns;			///< @brief Screen width used for @row,col addresses.
+	char					* luname;			///< @brief LU name reported to the client.
+	size_t					  length;
+	size_t					  size;
+	SIMULATOR_COMMAND		* commands;
+} SIMULATOR_SCRIPT;
+
+/// @brief Inbound record.
+typedef struct _simulator_record {
+	size_t					  length;
+	unsigned char			* data;
+} SIMULATOR_RECORD;
+
+/// @brief Connection state.
+typedef struct _simulator {
+	int						  sock;
+	unsigned int			  verbose		: 1;
+	unsigned int			  tn3270e		: 1;	///< @brief TN3270E is being negotiated.
+	unsigned int			  ready			: 1;	///< @brief Negotiation complete, 3270 data can flow.
+	unsigned int			  closed		: 1;	///< @brief Client has disconnected.
+
+	const SIMULATOR_SCRIPT	* script;
+
+	// Telnet parser.
+	unsigned char			  state;
+	size_t					  sblen;
+	unsigned char			  sbbuf[1024];
+
+	// Current inbound record.
+	struct {
+		size_t				  length;
+		size_t				  size;
+		unsigned char		* data;
+	} input;
+
+	// Records waiting for 'expect'.
+	struct {
+		size_t				  first;
+		size_t				  count;
+		SIMULATOR_RECORD	  records[SIMULATOR_MAX_PENDING];
+	} pending;
+
+	unsigned short			  seq;				///< @brief TN3270E sequence number.
+
+	struct {
+		unsigned long		  bytes_in;
+		unsigned long		  bytes_out;
+		unsigned long		  records_in;
+		unsigned long		  records_out;
+	} stats;
+
+} SIMULATOR;
+
+/// @brief Load script from file (NULL for the default script).
+SIMULATOR_SCRIPT	* simulator_script_load(const char *filename);
+void				  simulator_script_free(SIMULATOR_SCRIPT *script);
+
+/// @brief Run script on connected client.
+int					  simulator_script_run(SIMULATOR *simulator);
+
+/// @brief Start telnet negotiation, returns when 3270 data can be sent.
+int					  simulator_negotiate(SIMULATOR *simulator, unsigned long timeout);
+
+/// @brief Process network input for up to 'timeout' milliseconds.
+int					  simulator_poll(SIMULATOR *simulator, unsigned long timeout);
+
+/// @brief Send a 3270 record (adds TN3270E header, doubles IACs, appends IAC EOR).
+int					  simulator_send_record(SIMULATOR *simulator, const unsigned char *data, size_t length);
+
+/// @brief Send NVT data (doubles IACs).
+int					  simulator_send_nvt(SIMULATOR *simulator, const unsigned char *data, size_t length);
+
+/// @brief Get the next inbound 3270 record (release it with free()).
+int					  simulator_get_record(SIMULATOR *simulator, SIMULATOR_RECORD *record);
+
+/// @brief Parse hex, "text" and @row,col tokens into a data buffer.
+int					  simulator_parse_data(const SIMULATOR_SCRIPT *script, const char *text, unsigned char **data, size_t *length);
+
+/// @brief Append the host records from a capture file ('<' or unprefixed hex lines) as 'send' commands.
+int					  simulator_script_replay(SIMULATOR_SCRIPT *script, const char *filename, unsigned int line);
+
+#endif // SIMULATOR_PRIVATE_H_INCLUDED
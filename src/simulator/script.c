@@ -0,0 +1,622 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como script.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Simulator script parser and interpreter.
+ *
+ * Script syntax, one command per line ('#' starts a comment):
+ *
+ *	mode tn3270|tn3270e			Protocol to negotiate (before any data).
+ *	lu <name>					LU name reported on TN3270E CONNECT.
+ *	columns <n>					Screen width used on @row,col addresses (default 80).
+ *	send <data>					Send a 3270 record.
+ *	nvt <data>					Send NVT data.
+ *	replay <file>				Send the host records from a capture file.
+ *	expect <aid|any> [ms]		Wait for an inbound record.
+ *	sleep <ms>					Wait.
+ *	repeat [n]					Repeat the block up to 'end' n times (0 or none = forever).
+ *	end							End of repeat block.
+ *	close						Disconnect the client.
+ *
+ * Data is a sequence of hex bytes, "quoted text" (translated to EBCDIC) and
+ * @row,col tokens (1-based, translated to a SBA order).
+ *
+ * Capture files have one record per line as hex bytes; lines starting with
+ * '>' are client records and are skipped, '<' (or no prefix) marks a host record.
+ *
+ */
+
+#include "private.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/time.h>
+
+#define MAX_REPEAT_DEPTH	16
+
+/// @brief ASCII to EBCDIC (CP037) for the printable range.
+static const unsigned char asc2ebc[95] = {
+	0x40, 0x5a, 0x7f, 0x7b, 0x5b, 0x6c, 0x50, 0x7d, 0x4d, 0x5d, 0x5c, 0x4e, 0x6b, 0x60, 0x4b, 0x61,	// 0x20
+	0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0x7a, 0x5e, 0x4c, 0x7e, 0x6e, 0x6f,	// 0x30
+	0x7c, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xd1, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6,	// 0x40
+	0xd7, 0xd8, 0xd9, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xba, 0xe0, 0xbb, 0xb0, 0x6d,	// 0x50
+	0x79, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96,	// 0x60
+	0x97, 0x98, 0x99, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xc0, 0x4f, 0xd0, 0xa1		// 0x70
+};
+
+/// @brief 12-bit buffer address encoding.
+static const unsigned char code_table[64] = {
+	0x40, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0x4a, 0x4b, 0x4c, 0x4d, 0x4e, 0x4f,
+	0x50, 0xd1, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0x5a, 0x5b, 0x5c, 0x5d, 0x5e, 0x5f,
+	0x60, 0x61, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e, 0x6f,
+	0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0x7a, 0x7b, 0x7c, 0x7d, 0x7e, 0x7f
+};
+
+static const struct _aids {
+	const char		* name;
+	unsigned char	  aid;
+} aids[] = {
+	{ "enter",	0x7d },
+	{ "clear",	0x6d },
+	{ "pa1",	0x6c },
+	{ "pa2",	0x6e },
+	{ "pa3",	0x6b },
+	{ "sysreq",	0xf0 },
+	{ "pf1",	0xf1 },
+	{ "pf2",	0xf2 },
+	{ "pf3",	0xf3 },
+	{ "pf4",	0xf4 },
+	{ "pf5",	0xf5 },
+	{ "pf6",	0xf6 },
+	{ "pf7",	0xf7 },
+	{ "pf8",	0xf8 },
+	{ "pf9",	0xf9 },
+	{ "pf10",	0x7a },
+	{ "pf11",	0x7b },
+	{ "pf12",	0x7c },
+	{ "pf13",	0xc1 },
+	{ "pf14",	0xc2 },
+	{ "pf15",	0xc3 },
+	{ "pf16",	0xc4 },
+	{ "pf17",	0xc5 },
+	{ "pf18",	0xc6 },
+	{ "pf19",	0xc7 },
+	{ "pf20",	0xc8 },
+	{ "pf21",	0xc9 },
+	{ "pf22",	0x4a },
+	{ "pf23",	0x4b },
+	{ "pf24",	0x4c }
+};
+
+/// @brief Default script: a minimal panel answering every AID.
+static const char *default_script[] = {
+	"mode tn3270e",
+	"send f5 c3 @1,1 1d f0 \"LIB3270 HOST SIMULATOR\" @3,1 1d f0 \"COMMAND ===>\" 1d 40 13 @3,60 1d f0",
+	"repeat",
+	"expect any",
+	"send f1 c2",
+	"end",
+	NULL
+};
+
+/*---[ Implement ]------------------------------------------------------------------------------------------*/
+
+static unsigned long now_ms(void) {
+	struct timeval tv;
+	gettimeofday(&tv,NULL);
+	return (tv.tv_sec * 1000) + (tv.tv_usec / 1000);
+}
+
+static int hexvalue(int c) {
+	if(c >= '0' && c <= '9')
+		return c - '0';
+	c = tolower(c);
+	if(c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	return -1;
+}
+
+static void append(unsigned char **data, size_t *length, size_t *size, unsigned char c) {
+	if(*length >= *size) {
+		*size += 256;
+		*data = realloc(*data,*size);
+	}
+	(*data)[(*length)++] = c;
+}
+
+int simulator_parse_data(const SIMULATOR_SCRIPT *script, const char *text, unsigned char **data, size_t *length) {
+
+	size_t size = 0;
+
+	*data = NULL;
+	*length = 0;
+
+	while(*text) {
+
+		if(isspace(*text)) {
+
+			text++;
+
+		} else if(*text == '"') {
+
+			for(text++;*text && *text != '"';text++) {
+				unsigned char c = (unsigned char) *text;
+				if(c == '\\' && text[1])
+					c = (unsigned char) *(++text);
+				append(data,length,&size,(c >= 0x20 && c < 0x7f) ? asc2ebc[c-0x20] : 0x40);
+			}
+
+			if(*text != '"') {
+				free(*data);
+				return EINVAL;
+			}
+			text++;
+
+		} else if(*text == '@') {
+
+			char			* ptr;
+			unsigned long	  row = strtoul(text+1,&ptr,10);
+			unsigned long	  col;
+
+			if(*ptr != ',' || !row) {
+				free(*data);
+				return EINVAL;
+			}
+
+			col = strtoul(ptr+1,&ptr,10);
+			if(!col) {
+				free(*data);
+				return EINVAL;
+			}
+
+			unsigned int baddr = ((row-1) * script->columns) + (col-1);
+
+			append(data,length,&size,0x11);	// SBA
+			append(data,length,&size,code_table[(baddr >> 6) & 0x3f]);
+			append(data,length,&size,code_table[baddr & 0x3f]);
+			text = ptr;
+
+		} else {
+
+			int hi = hexvalue(text[0]);
+			int lo = hi < 0 ? -1 : hexvalue(text[1]);
+
+			if(lo < 0) {
+				free(*data);
+				return EINVAL;
+			}
+
+			append(data,length,&size,(hi << 4) | lo);
+			text += 2;
+
+		}
+
+	}
+
+	return 0;
+}
+
+static SIMULATOR_COMMAND * new_command(SIMULATOR_SCRIPT *script, SIMULATOR_COMMAND_TYPE type, unsigned int line) {
+
+	if(script->length >= script->size) {
+		script->size += 64;
+		script->commands = realloc(script->commands,script->size * sizeof(SIMULATOR_COMMAND));
+	}
+
+	SIMULATOR_COMMAND *command = script->commands + script->length++;
+	memset(command,0,sizeof(SIMULATOR_COMMAND));
+
+	command->type = type;
+	command->line = line;
+	command->aid = -1;
+
+	return command;
+}
+
+static int parse_aid(const char *text) {
+
+	size_t ix;
+
+	if(!strcasecmp(text,"any"))
+		return -1;
+
+	for(ix = 0; ix < (sizeof(aids)/sizeof(aids[0])); ix++) {
+		if(!strcasecmp(aids[ix].name,text))
+			return aids[ix].aid;
+	}
+
+	if(strlen(text) == 2 && hexvalue(text[0]) >= 0 && hexvalue(text[1]) >= 0)
+		return (hexvalue(text[0]) << 4) | hexvalue(text[1]);
+
+	return -2;
+}
+
+int simulator_script_replay(SIMULATOR_SCRIPT *script, const char *filename, unsigned int line) {
+
+	FILE			* in = fopen(filename,"r");
+	char			  buffer[65536];
+	unsigned int	  records = 0;
+
+	if(!in) {
+		int err = errno;
+		fprintf(stderr,"line %u: Can't open %s: %s\n",line,filename,strerror(err));
+		return err;
+	}
+
+	while(fgets(buffer,sizeof(buffer),in)) {
+
+		char *ptr = buffer;
+
+		while(isspace(*ptr))
+			ptr++;
+
+		if(!*ptr || *ptr == '#' || *ptr == '>')
+			continue;
+
+		if(*ptr == '<')
+			ptr++;
+
+		SIMULATOR_COMMAND *command = new_command(script,SIMULATOR_SEND,line);
+
+		// Only hex bytes are allowed in capture files.
+		if(strchr(ptr,'"') || strchr(ptr,'@') || simulator_parse_data(script,ptr,&command->data,&command->length)) {
+			fprintf(stderr,"%s: Invalid record %u\n",filename,records+1);
+			script->length--;
+			fclose(in);
+			return EINVAL;
+		}
+
+		records++;
+
+	}
+
+	fclose(in);
+
+	if(!records) {
+		fprintf(stderr,"line %u: No host records in %s\n",line,filename);
+		return ENOENT;
+	}
+
+	return 0;
+}
+
+static int parse_line(SIMULATOR_SCRIPT *script, char *text, unsigned int line, size_t *stack, size_t *depth) {
+
+	char *arg;
+
+	while(isspace(*text))
+		text++;
+
+	if(!*text || *text == '#')
+		return 0;
+
+	arg = text;
+	while(*arg && !isspace(*arg))
+		arg++;
+
+	if(*arg)
+		*(arg++) = 0;
+
+	while(isspace(*arg))
+		arg++;
+
+	// Remove trailing spaces.
+	{
+		char *end = arg + strlen(arg);
+		while(end > arg && isspace(*(end-1)))
+			*(--end) = 0;
+	}
+
+	if(!strcasecmp(text,"mode")) {
+
+		if(!strcasecmp(arg,"tn3270e"))
+			script->tn3270e = 1;
+		else if(!strcasecmp(arg,"tn3270"))
+			script->tn3270e = 0;
+		else
+			return EINVAL;
+
+	} else if(!strcasecmp(text,"lu")) {
+
+		if(!*arg)
+			return EINVAL;
+
+		free(script->luname);
+		script->luname = strdup(arg);
+
+	} else if(!strcasecmp(text,"columns")) {
+
+		script->columns = (unsigned short) atoi(arg);
+		if(!script->columns)
+			return EINVAL;
+
+	} else if(!strcasecmp(text,"send") || !strcasecmp(text,"nvt")) {
+
+		SIMULATOR_COMMAND *command = new_command(script,strcasecmp(text,"send") ? SIMULATOR_NVT : SIMULATOR_SEND,line);
+
+		if(command->type == SIMULATOR_NVT && *arg == '"') {
+
+			// NVT text is sent as-is (no EBCDIC translation).
+			char *end = strrchr(arg+1,'"');
+			if(!end)
+				return EINVAL;
+
+			command->length = end - (arg+1);
+			command->data = malloc(command->length+1);
+			memcpy(command->data,arg+1,command->length);
+
+		} else if(simulator_parse_data(script,arg,&command->data,&command->length)) {
+
+			script->length--;
+			return EINVAL;
+
+		}
+
+	} else if(!strcasecmp(text,"replay")) {
+
+		if(!*arg)
+			return EINVAL;
+
+		return simulator_script_replay(script,arg,line);
+
+	} else if(!strcasecmp(text,"expect")) {
+
+		SIMULATOR_COMMAND	* command = new_command(script,SIMULATOR_EXPECT,line);
+		char				* timeout = arg;
+
+		while(*timeout && !isspace(*timeout))
+			timeout++;
+
+		if(*timeout)
+			*(timeout++) = 0;
+
+		command->aid = parse_aid(*arg ? arg : "any");
+		command->value = *timeout ? strtoul(timeout,NULL,10) : SIMULATOR_EXPECT_TIMEOUT;
+
+		if(command->aid == -2)
+			return EINVAL;
+
+	} else if(!strcasecmp(text,"sleep")) {
+
+		new_command(script,SIMULATOR_SLEEP,line)->value = strtoul(arg,NULL,10);
+
+	} else if(!strcasecmp(text,"repeat")) {
+
+		if(*depth >= MAX_REPEAT_DEPTH)
+			return E2BIG;
+
+		stack[(*depth)++] = script->length;
+		new_command(script,SIMULATOR_REPEAT,line)->value = strtoul(arg,NULL,10);
+
+	} else if(!strcasecmp(text,"end")) {
+
+		if(!*depth)
+			return EINVAL;
+
+		new_command(script,SIMULATOR_END,line)->jump = stack[--(*depth)];
+
+	} else if(!strcasecmp(text,"close")) {
+
+		new_command(script,SIMULATOR_CLOSE,line);
+
+	} else {
+
+		return EINVAL;
+
+	}
+
+	return 0;
+
+}
+
+SIMULATOR_SCRIPT * simulator_script_load(const char *filename) {
+
+	SIMULATOR_SCRIPT	* script = calloc(1,sizeof(SIMULATOR_SCRIPT));
+	size_t				  stack[MAX_REPEAT_DEPTH];
+	size_t				  depth = 0;
+	unsigned int		  line = 0;
+	int					  rc = 0;
+
+	script->columns = 80;
+
+	if(filename) {
+
+		FILE *in = fopen(filename,"r");
+		char buffer[65536];
+
+		if(!in) {
+			perror(filename);
+			simulator_script_free(script);
+			return NULL;
+		}
+
+		while(!rc && fgets(buffer,sizeof(buffer),in))
+			rc = parse_line(script,buffer,++line,stack,&depth);
+
+		fclose(in);
+
+	} else {
+
+		size_t ix;
+
+		for(ix = 0; !rc && default_script[ix]; ix++) {
+			char buffer[1024];
+			strncpy(buffer,default_script[ix],sizeof(buffer)-1);
+			buffer[sizeof(buffer)-1] = 0;
+			rc = parse_line(script,buffer,++line,stack,&depth);
+		}
+
+	}
+
+	if(!rc && depth) {
+		fprintf(stderr,"%s: 'repeat' without 'end'\n",filename ? filename : "default script");
+		rc = EINVAL;
+	} else if(rc) {
+		fprintf(stderr,"%s: Error on line %u: %s\n",filename ? filename : "default script",line,strerror(rc));
+	}
+
+	if(rc) {
+		simulator_script_free(script);
+		return NULL;
+	}
+
+	return script;
+
+}
+
+void simulator_script_free(SIMULATOR_SCRIPT *script) {
+
+	size_t ix;
+
+	if(!script)
+		return;
+
+	for(ix = 0; ix < script->length; ix++)
+		free(script->commands[ix].data);
+
+	free(script->commands);
+	free(script->luname);
+	free(script);
+
+}
+
+static int expect(SIMULATOR *simulator, const SIMULATOR_COMMAND *command) {
+
+	unsigned long limit = now_ms() + command->value;
+
+	for(;;) {
+
+		SIMULATOR_RECORD record;
+
+		while(!simulator_get_record(simulator,&record)) {
+
+			int aid = record.length ? record.data[0] : -1;
+			free(record.data);
+
+			if(command->aid < 0 || command->aid == aid)
+				return 0;
+
+			if(simulator->verbose)
+				fprintf(stderr,"line %u: Ignoring AID 0x%02x\n",command->line,(unsigned int) aid);
+
+		}
+
+		unsigned long current = now_ms();
+		if(current >= limit) {
+			fprintf(stderr,"line %u: Timeout waiting for client\n",command->line);
+			return ETIMEDOUT;
+		}
+
+		int rc = simulator_poll(simulator,limit-current);
+		if(rc)
+			return rc;
+
+	}
+
+}
+
+static int delay(SIMULATOR *simulator, unsigned long ms) {
+
+	unsigned long limit = now_ms() + ms;
+
+	for(;;) {
+
+		unsigned long current = now_ms();
+		if(current >= limit)
+			return 0;
+
+		// Keep reading while waiting, the client may be sending data.
+		int rc = simulator_poll(simulator,limit-current);
+		if(rc)
+			return rc;
+
+	}
+
+}
+
+int simulator_script_run(SIMULATOR *simulator) {
+
+	const SIMULATOR_SCRIPT	* script = simulator->script;
+	unsigned long			  counters[MAX_REPEAT_DEPTH];
+	size_t					  depth = 0;
+	size_t					  pc = 0;
+	int						  rc = 0;
+
+	while(!rc && pc < script->length) {
+
+		const SIMULATOR_COMMAND *command = script->commands + pc++;
+
+		switch(command->type) {
+		case SIMULATOR_SEND:
+			rc = simulator_send_record(simulator,command->data,command->length);
+			break;
+
+		case SIMULATOR_NVT:
+			rc = simulator_send_nvt(simulator,command->data,command->length);
+			break;
+
+		case SIMULATOR_EXPECT:
+			rc = expect(simulator,command);
+			break;
+
+		case SIMULATOR_SLEEP:
+			rc = delay(simulator,command->value);
+			break;
+
+		case SIMULATOR_REPEAT:
+			counters[depth++] = command->value;
+			break;
+
+		case SIMULATOR_END:
+			// 0 means forever.
+			if(!counters[depth-1] || --counters[depth-1]) {
+				pc = command->jump + 1;
+			} else {
+				depth--;
+			}
+			break;
+
+		case SIMULATOR_CLOSE:
+			return 0;
+
+		}
+
+	}
+
+	if(rc == ENOTCONN)
+		rc = 0;
+
+	return rc;
+
+}
@@ -0,0 +1,521 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como telnet.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Host side of the telnet/TN3270E negotiation.
+ *
+ */
+
+#include "private.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+
+#include <arpa_telnet.h>
+#include <tn3270e.h>
+
+/* telnet states */
+#define TNS_DATA	0	/* receiving data */
+#define TNS_IAC		1	/* got an IAC */
+#define TNS_WILL	2	/* got an IAC WILL */
+#define TNS_WONT	3	/* got an IAC WONT */
+#define TNS_DO		4	/* got an IAC DO */
+#define TNS_DONT	5	/* got an IAC DONT */
+#define TNS_SB		6	/* got an IAC SB */
+#define TNS_SB_IAC	7	/* got an IAC after an IAC SB */
+
+#define E_OPT(n)	(1 << (n))
+
+/// @brief TN3270E functions accepted by the simulator.
+#define SIMULATOR_FUNCTIONS	E_OPT(TN3270E_FUNC_RESPONSES)
+
+/*---[ Implement ]------------------------------------------------------------------------------------------*/
+
+static unsigned long now_ms(void) {
+	struct timeval tv;
+	gettimeofday(&tv,NULL);
+	return (tv.tv_sec * 1000) + (tv.tv_usec / 1000);
+}
+
+static int net_write(SIMULATOR *simulator, const unsigned char *buffer, size_t length) {
+
+	simulator->stats.bytes_out += length;
+
+	while(length) {
+		ssize_t bytes = send(simulator->sock,buffer,length,0);
+		if(bytes < 0) {
+			if(errno == EINTR)
+				continue;
+			return errno;
+		}
+		buffer += bytes;
+		length -= bytes;
+	}
+
+	return 0;
+}
+
+static int send_cmd(SIMULATOR *simulator, unsigned char cmd, unsigned char option) {
+	unsigned char buffer[] = { IAC, cmd, option };
+
+	if(simulator->verbose)
+		fprintf(stderr,"SENT %u %u\n",(unsigned int) cmd, (unsigned int) option);
+
+	return net_write(simulator,buffer,sizeof(buffer));
+}
+
+static int send_sb(SIMULATOR *simulator, const unsigned char *data, size_t length) {
+	unsigned char buffer[sizeof(simulator->sbbuf)+5];
+
+	if(length > sizeof(simulator->sbbuf))
+		return EINVAL;
+
+	buffer[0] = IAC;
+	buffer[1] = SB;
+	memcpy(buffer+2,data,length);
+	buffer[length+2] = IAC;
+	buffer[length+3] = SE;
+
+	return net_write(simulator,buffer,length+4);
+}
+
+static void tn3270_start(SIMULATOR *simulator) {
+	static const unsigned char ttype_send[] = { TELOPT_TTYPE, TELQUAL_SEND };
+
+	simulator->tn3270e = 0;
+	send_cmd(simulator,DO,TELOPT_TTYPE);
+	send_sb(simulator,ttype_send,sizeof(ttype_send));
+}
+
+static void tn3270_ready(SIMULATOR *simulator) {
+	send_cmd(simulator,DO,TELOPT_EOR);
+	send_cmd(simulator,WILL,TELOPT_EOR);
+	send_cmd(simulator,DO,TELOPT_BINARY);
+	send_cmd(simulator,WILL,TELOPT_BINARY);
+	simulator->ready = 1;
+}
+
+static void tn3270e_subnegotiation(SIMULATOR *simulator) {
+
+	const unsigned char	* sb = simulator->sbbuf;
+	size_t				  length = simulator->sblen;
+
+	if(length < 3)
+		return;
+
+	if(sb[1] == TN3270E_OP_DEVICE_TYPE && sb[2] == TN3270E_OP_REQUEST) {
+
+		// DEVICE-TYPE REQUEST <type> [CONNECT <lu>] -> DEVICE-TYPE IS <type> CONNECT <lu>
+		unsigned char	  response[sizeof(simulator->sbbuf)];
+		size_t			  tlen = 0;
+		size_t			  rlen = 0;
+		const char		* luname = simulator->script->luname ? simulator->script->luname : "SIMLU001";
+
+		while(3+tlen < length && sb[3+tlen] != TN3270E_OP_CONNECT && sb[3+tlen] != TN3270E_OP_ASSOCIATE)
+			tlen++;
+
+		if(tlen + strlen(luname) + 8 > sizeof(response))
+			return;
+
+		response[rlen++] = TELOPT_TN3270E;
+		response[rlen++] = TN3270E_OP_DEVICE_TYPE;
+		response[rlen++] = TN3270E_OP_IS;
+		memcpy(response+rlen,sb+3,tlen);
+		rlen += tlen;
+		response[rlen++] = TN3270E_OP_CONNECT;
+		memcpy(response+rlen,luname,strlen(luname));
+		rlen += strlen(luname);
+
+		if(simulator->verbose)
+			fprintf(stderr,"SENT DEVICE-TYPE IS %.*s CONNECT %s\n",(int) tlen, sb+3, luname);
+
+		send_sb(simulator,response,rlen);
+
+	} else if(sb[1] == TN3270E_OP_FUNCTIONS && sb[2] == TN3270E_OP_REQUEST) {
+
+		// Accept the common subset.
+		unsigned char	response[16];
+		size_t			rlen = 0;
+		size_t			ix;
+
+		response[rlen++] = TELOPT_TN3270E;
+		response[rlen++] = TN3270E_OP_FUNCTIONS;
+		response[rlen++] = TN3270E_OP_IS;
+
+		for(ix = 3; ix < length && rlen < sizeof(response); ix++) {
+			if(sb[ix] < 32 && (SIMULATOR_FUNCTIONS & E_OPT(sb[ix])))
+				response[rlen++] = sb[ix];
+		}
+
+		send_sb(simulator,response,rlen);
+		simulator->ready = 1;
+
+		if(simulator->verbose)
+			fprintf(stderr,"TN3270E negotiation complete\n");
+
+	} else if(sb[1] == TN3270E_OP_FUNCTIONS && sb[2] == TN3270E_OP_IS) {
+
+		simulator->ready = 1;
+
+	}
+
+}
+
+static void subnegotiation(SIMULATOR *simulator) {
+
+	if(!simulator->sblen)
+		return;
+
+	switch(simulator->sbbuf[0]) {
+	case TELOPT_TTYPE:
+		if(simulator->sblen > 1 && simulator->sbbuf[1] == TELQUAL_IS) {
+			if(simulator->verbose)
+				fprintf(stderr,"RCVD TERMINAL-TYPE %.*s\n",(int) (simulator->sblen-2),simulator->sbbuf+2);
+			tn3270_ready(simulator);
+		}
+		break;
+
+	case TELOPT_TN3270E:
+		tn3270e_subnegotiation(simulator);
+		break;
+
+	}
+
+}
+
+static void store_record(SIMULATOR *simulator) {
+
+	const unsigned char	* data		= simulator->input.data;
+	size_t				  length	= simulator->input.length;
+
+	simulator->input.length = 0;
+
+	if(simulator->tn3270e) {
+
+		if(length < EH_SIZE)
+			return;
+
+		// Only 3270 data is expected, ignore responses and other data types.
+		if(data[0] != TN3270E_DT_3270_DATA)
+			return;
+
+		data += EH_SIZE;
+		length -= EH_SIZE;
+
+	}
+
+	simulator->stats.records_in++;
+
+	if(simulator->pending.count >= SIMULATOR_MAX_PENDING) {
+		fprintf(stderr,"Too many pending records, dropping the oldest one\n");
+		free(simulator->pending.records[simulator->pending.first].data);
+		simulator->pending.first = (simulator->pending.first + 1) % SIMULATOR_MAX_PENDING;
+		simulator->pending.count--;
+	}
+
+	SIMULATOR_RECORD *record = simulator->pending.records + ((simulator->pending.first + simulator->pending.count) % SIMULATOR_MAX_PENDING);
+
+	record->length = length;
+	record->data = malloc(length+1);
+	memcpy(record->data,data,length);
+	simulator->pending.count++;
+
+	if(simulator->verbose)
+		fprintf(stderr,"RCVD record with %u bytes (AID 0x%02x)\n",(unsigned int) length, length ? data[0] : 0);
+
+}
+
+static void store_input(SIMULATOR *simulator, unsigned char c) {
+
+	if(simulator->input.length >= simulator->input.size) {
+		simulator->input.size += 4096;
+		simulator->input.data = realloc(simulator->input.data,simulator->input.size);
+	}
+
+	simulator->input.data[simulator->input.length++] = c;
+
+}
+
+static void telnet_fsm(SIMULATOR *simulator, unsigned char c) {
+
+	switch(simulator->state) {
+	case TNS_DATA:
+		if(c == IAC)
+			simulator->state = TNS_IAC;
+		else
+			store_input(simulator,c);
+		break;
+
+	case TNS_IAC:
+		switch(c) {
+		case IAC:
+			store_input(simulator,c);
+			simulator->state = TNS_DATA;
+			break;
+
+		case EOR:
+			store_record(simulator);
+			simulator->state = TNS_DATA;
+			break;
+
+		case WILL:
+			simulator->state = TNS_WILL;
+			break;
+
+		case WONT:
+			simulator->state = TNS_WONT;
+			break;
+
+		case DO:
+			simulator->state = TNS_DO;
+			break;
+
+		case DONT:
+			simulator->state = TNS_DONT;
+			break;
+
+		case SB:
+			simulator->sblen = 0;
+			simulator->state = TNS_SB;
+			break;
+
+		default:
+			simulator->state = TNS_DATA;
+		}
+		break;
+
+	case TNS_WILL:
+		if(simulator->verbose)
+			fprintf(stderr,"RCVD WILL %u\n",(unsigned int) c);
+
+		if(c == TELOPT_TN3270E) {
+			static const unsigned char send_device_type[] = { TELOPT_TN3270E, TN3270E_OP_SEND, TN3270E_OP_DEVICE_TYPE };
+			simulator->tn3270e = 1;
+			send_sb(simulator,send_device_type,sizeof(send_device_type));
+		} else if(c != TELOPT_TTYPE && c != TELOPT_EOR && c != TELOPT_BINARY) {
+			send_cmd(simulator,DONT,c);
+		}
+		simulator->state = TNS_DATA;
+		break;
+
+	case TNS_WONT:
+		if(simulator->verbose)
+			fprintf(stderr,"RCVD WONT %u\n",(unsigned int) c);
+
+		if(c == TELOPT_TN3270E && simulator->tn3270e) {
+			// Client refused TN3270E, fall back to TN3270.
+			tn3270_start(simulator);
+		}
+		simulator->state = TNS_DATA;
+		break;
+
+	case TNS_DO:
+		if(simulator->verbose)
+			fprintf(stderr,"RCVD DO %u\n",(unsigned int) c);
+
+		if(c != TELOPT_EOR && c != TELOPT_BINARY)
+			send_cmd(simulator,WONT,c);
+		simulator->state = TNS_DATA;
+		break;
+
+	case TNS_DONT:
+		simulator->state = TNS_DATA;
+		break;
+
+	case TNS_SB:
+		if(c == IAC)
+			simulator->state = TNS_SB_IAC;
+		else if(simulator->sblen < sizeof(simulator->sbbuf))
+			simulator->sbbuf[simulator->sblen++] = c;
+		break;
+
+	case TNS_SB_IAC:
+		if(c == SE) {
+			subnegotiation(simulator);
+			simulator->state = TNS_DATA;
+		} else {
+			if(simulator->sblen < sizeof(simulator->sbbuf))
+				simulator->sbbuf[simulator->sblen++] = c;
+			simulator->state = TNS_SB;
+		}
+		break;
+
+	}
+
+}
+
+int simulator_poll(SIMULATOR *simulator, unsigned long timeout) {
+
+	struct pollfd pfd = {
+		.fd = simulator->sock,
+		.events = POLLIN
+	};
+
+	switch(poll(&pfd,1,(int) timeout)) {
+	case -1:
+		return errno == EINTR ? 0 : errno;
+
+	case 0:
+		return 0;
+
+	}
+
+	unsigned char	buffer[16384];
+	ssize_t			bytes = recv(simulator->sock,buffer,sizeof(buffer),0);
+
+	if(bytes < 0)
+		return errno == EINTR ? 0 : errno;
+
+	if(bytes == 0) {
+		simulator->closed = 1;
+		return ENOTCONN;
+	}
+
+	simulator->stats.bytes_in += bytes;
+
+	ssize_t ix;
+	for(ix = 0; ix < bytes; ix++)
+		telnet_fsm(simulator,buffer[ix]);
+
+	return 0;
+}
+
+int simulator_negotiate(SIMULATOR *simulator, unsigned long timeout) {
+
+	unsigned long limit = now_ms() + timeout;
+
+	if(simulator->script->tn3270e) {
+		simulator->tn3270e = 1;
+		send_cmd(simulator,DO,TELOPT_TN3270E);
+	} else {
+		tn3270_start(simulator);
+	}
+
+	while(!simulator->ready) {
+
+		unsigned long current = now_ms();
+		if(current >= limit)
+			return ETIMEDOUT;
+
+		int rc = simulator_poll(simulator,limit-current);
+		if(rc)
+			return rc;
+
+	}
+
+	return 0;
+}
+
+int simulator_get_record(SIMULATOR *simulator, SIMULATOR_RECORD *record) {
+
+	if(!simulator->pending.count)
+		return ENOENT;
+
+	*record = simulator->pending.records[simulator->pending.first];
+	simulator->pending.first = (simulator->pending.first + 1) % SIMULATOR_MAX_PENDING;
+	simulator->pending.count--;
+
+	return 0;
+}
+
+static int send_escaped(SIMULATOR *simulator, const unsigned char *prefix, size_t plen, const unsigned char *data, size_t length, int eor) {
+
+	unsigned char	* buffer = malloc(((plen + length) * 2) + 2);
+	size_t			  ix;
+	size_t			  blen = 0;
+
+	for(ix = 0; ix < plen; ix++) {
+		if((buffer[blen++] = prefix[ix]) == IAC)
+			buffer[blen++] = IAC;
+	}
+
+	for(ix = 0; ix < length; ix++) {
+		if((buffer[blen++] = data[ix]) == IAC)
+			buffer[blen++] = IAC;
+	}
+
+	if(eor) {
+		buffer[blen++] = IAC;
+		buffer[blen++] = EOR;
+	}
+
+	int rc = net_write(simulator,buffer,blen);
+	free(buffer);
+
+	return rc;
+}
+
+int simulator_send_record(SIMULATOR *simulator, const unsigned char *data, size_t length) {
+
+	simulator->stats.records_out++;
+
+	if(simulator->tn3270e) {
+
+		unsigned char header[EH_SIZE] = {
+			TN3270E_DT_3270_DATA,
+			0,
+			TN3270E_RSF_NO_RESPONSE,
+			(simulator->seq >> 8) & 0xff,
+			simulator->seq & 0xff
+		};
+
+		simulator->seq = (simulator->seq + 1) & 0x7fff;
+
+		return send_escaped(simulator,header,sizeof(header),data,length,1);
+	}
+
+	return send_escaped(simulator,NULL,0,data,length,1);
+
+}
+
+int simulator_send_nvt(SIMULATOR *simulator, const unsigned char *data, size_t length) {
+
+	if(simulator->tn3270e) {
+
+		unsigned char header[EH_SIZE] = {
+			TN3270E_DT_NVT_DATA,
+			0,
+			TN3270E_RSF_NO_RESPONSE,
+			(simulator->seq >> 8) & 0xff,
+			simulator->seq & 0xff
+		};
+
+		simulator->seq = (simulator->seq + 1) & 0x7fff;
+
+		return send_escaped(simulator,header,sizeof(header),data,length,1);
+	}
+
+	return send_escaped(simulator,NULL,0,data,length,0);
+
+}
@@ -31,6 +31,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <getopt.h>
+#include <errno.h>
 #include <locale.h>
 
 #include <internals.h>
@@ -41,6 +42,8 @@
 #include <lib3270/log.h>
 #include <lib3270/properties.h>
 #include <lib3270/charset.h>
+#include <lib3270/macro.h>
+#include <lib3270/internals.h>
 
 #ifdef _WIN32
 #include <lib3270/win32.h>
@@ -64,6 +67,196 @@ static void reconnect_test(H3270 *hSession) {
 
 }
 
+static void macro_finished(H3270 GNUC_UNUSED(*hSession), int rc, int exit_code, void *userdata) {
+	int *result = (int *) userdata;
+	result[0] = rc;
+	result[1] = exit_code;
+}
+
+/// @brief Run macros with wait and exit steps on a replay session.
+static int macro_test(H3270 *hSession) {
+	static const unsigned char negotiation[] = {
+		0xff, 0xfd, 0x18,								// DO TERMINAL-TYPE
+		0xff, 0xfa, 0x18, 0x01, 0xff, 0xf0,				// SB TERMINAL-TYPE SEND SE
+		0xff, 0xfd, 0x19, 0xff, 0xfb, 0x19,				// DO/WILL EOR
+		0xff, 0xfd, 0x00, 0xff, 0xfb, 0x00				// DO/WILL BINARY
+	};
+
+	static const unsigned char unlock[] = {
+		0xf1, 0xc2, 0xff, 0xef							// Write, restore the keyboard.
+	};
+
+	LIB3270_MACRO	* macro		= lib3270_macro_compile("wait 2\nexit 11\n",NULL);
+	int				  result[2]	= { -1, -1 };
+	int				  exit_code	= -1;
+	int				  failed	= 0;
+	int				  rc;
+	int				  f;
+
+	lib3270_set_unlock_delay(hSession,0);
+
+	if(!macro || lib3270_replay_connect(hSession)) {
+		printf("Can't start the macro test\n");
+		return -1;
+	}
+
+	lib3270_data_recv(hSession,sizeof(negotiation),negotiation);
+	lib3270_data_recv(hSession,sizeof(unlock),unlock);
+
+	// Keyboard unlocked, the wait step ends at once.
+	rc = lib3270_macro_run(hSession,macro,2,&exit_code);
+	printf("Macro run exits with rc=%d exit code=%d\n",rc,exit_code);
+	failed |= (rc != 0 || exit_code != 11);
+
+	// Keyboard locked by the AID, the host never answers.
+	lib3270_enter(hSession);
+	rc = lib3270_macro_run(hSession,macro,2,&exit_code);
+	printf("Macro run on locked keyboard exits with rc=%d exit code=%d\n",rc,exit_code);
+	failed |= (rc != ETIMEDOUT || exit_code != 0);
+
+	// Still locked, the host unlocks the keyboard while the macro waits.
+	lib3270_macro_start(hSession,macro,2,macro_finished,result);
+
+	for(f = 0; f < 10 && lib3270_macro_is_running(hSession); f++)
+		lib3270_main_iterate(hSession,0);
+
+	lib3270_data_recv(hSession,sizeof(unlock),unlock);
+
+	for(f = 0; f < 1000 && lib3270_macro_is_running(hSession); f++)
+		lib3270_main_iterate(hSession,1);
+
+	printf("Macro start finishes with rc=%d exit code=%d\n",result[0],result[1]);
+	failed |= (result[0] != 0 || result[1] != 11);
+
+	lib3270_macro_free(macro);
+
+	printf("Macro test %s\n",failed ? "failed" : "ok");
+
+	return failed ? -1 : 0;
+
+}
+
+/// @brief Text collected by the trace handler.
+struct trace_text {
+	char	* text;
+	size_t	  length;
+};
+
+static void trace_text_append(struct trace_text *trace, const char *text, size_t length) {
+	trace->text = realloc(trace->text,trace->length+length+1);
+	memcpy(trace->text+trace->length,text,length);
+	trace->length += length;
+	trace->text[trace->length] = 0;
+}
+
+static int trace_text_handler(const H3270 GNUC_UNUSED(*hSession), void *userdata, const char *message) {
+	trace_text_append((struct trace_text *) userdata,message,strlen(message));
+	return 0;
+}
+
+/// @brief Drop the lines that can't match between the live and the replayed trace (timings and the tracedump headers).
+static void trace_text_filter(struct trace_text *trace) {
+
+	char	* from	= trace->text;
+	char	* to	= trace->text;
+
+	while(from && *from) {
+
+		char	* eol		= strchr(from,'\n');
+		size_t	  length	= eol ? (size_t) (eol - from) + 1 : strlen(from);
+
+		if(strncmp(from,"Session ",8) && strncmp(from,"< +",3) && strncmp(from,"> +",3)) {
+			memmove(to,from,length);
+			to += length;
+		}
+
+		from += length;
+	}
+
+	if(to)
+		*to = 0;
+
+}
+
+/// @brief Compare the data stream trace of a session with the one rebuilt by lib3270-tracedump --ds from its binary trace.
+static int trace_replay_test(const char *tracedump) {
+
+	static const unsigned char negotiation[] = {
+		0xff, 0xfd, 0x18,								// DO TERMINAL-TYPE
+		0xff, 0xfa, 0x18, 0x01, 0xff, 0xf0,				// SB TERMINAL-TYPE SEND SE
+		0xff, 0xfd, 0x19, 0xff, 0xfb, 0x19,				// DO/WILL EOR
+		0xff, 0xfd, 0x00, 0xff, 0xfb, 0x00				// DO/WILL BINARY
+	};
+
+	static const unsigned char write[] = {
+		0x7e, 0xc3, 0x11, 0x0c, 0x80,					// Erase/Write alternate, SBA 3200
+		0xc1, 0xc2, 0xc3, 0xff, 0xef					// 'ABC'
+	};
+
+	static const unsigned int models[] = { 4, 2, 5 };
+
+	const char	* filename	= "testprogram.bin.trace";
+	int			  failed	= 0;
+	size_t		  ix;
+
+	for(ix = 0; ix < (sizeof(models)/sizeof(models[0])); ix++) {
+
+		struct trace_text	  live		= { NULL, 0 };
+		struct trace_text	  replay	= { NULL, 0 };
+		H3270				* hSession	= lib3270_session_new("");
+		char				  command[4096];
+		char				  buffer[4096];
+		size_t				  length;
+		FILE				* pipe;
+
+		remove(filename);
+
+		lib3270_set_model_number(hSession,models[ix]);
+		lib3270_set_trace_handler(hSession,trace_text_handler,&live);
+		lib3270_set_toggle(hSession,LIB3270_TOGGLE_DS_TRACE,1);
+		lib3270_set_binary_trace_filename(hSession,filename);
+
+		lib3270_replay_connect(hSession);
+		lib3270_data_recv(hSession,sizeof(negotiation),negotiation);
+		lib3270_data_recv(hSession,sizeof(write),write);
+		lib3270_disconnect(hSession);
+
+		lib3270_set_binary_trace_filename(hSession,NULL);
+		lib3270_session_free(hSession);
+
+		snprintf(command,sizeof(command),"%s --ds %s",tracedump,filename);
+		pipe = popen(command,"r");
+		if(!pipe) {
+			printf("Can't run %s\n",command);
+			free(live.text);
+			return -1;
+		}
+
+		while((length = fread(buffer,1,sizeof(buffer),pipe)) > 0)
+			trace_text_append(&replay,buffer,length);
+
+		pclose(pipe);
+		remove(filename);
+
+		trace_text_filter(&live);
+		trace_text_filter(&replay);
+
+		if(!(live.text && replay.text && !strcmp(live.text,replay.text))) {
+			printf("Model %u: the replayed trace doesn't match the live one\n--- Live\n%s--- Replay\n%s",models[ix],live.text ? live.text : "",replay.text ? replay.text : "");
+			failed = 1;
+		}
+
+		free(live.text);
+		free(replay.text);
+
+	}
+
+	printf("Trace replay test %s\n",failed ? "failed" : "ok");
+
+	return failed ? -1 : 0;
+
+}
+
 int main(int argc, char *argv[]) {
 #ifdef _WIN32
 	debug("Process %s running on pid %u\n",argv[0],(unsigned int) GetCurrentProcessId());
@@ -89,6 +282,8 @@ int main(int argc, char *argv[]) {
 		{ "url",					required_argument,	0,	'U' },
 		{ "tracefile",				required_argument,	0,	't' },
 		{ "reconnect",				no_argument,		0,	'r' },
+		{ "macro",					no_argument,		0,	'm' },
+		{ "tracedump",				required_argument,	0,	'T' },
 
 		{ 0, 0, 0, 0}
 
@@ -115,7 +310,7 @@ int main(int argc, char *argv[]) {
 
 	int long_index =0;
 	int opt;
-	while((opt = getopt_long(argc, argv, "C:U:t:r", options, &long_index )) != -1) {
+	while((opt = getopt_long(argc, argv, "C:U:t:rmT:", options, &long_index )) != -1) {
 		switch(opt) {
 		case 'U':
 			lib3270_set_url(h,optarg);
@@ -133,6 +328,16 @@ int main(int argc, char *argv[]) {
 			reconnect_test(h);
 			return 0;
 
+		case 'm':
+			rc = macro_test(h);
+			lib3270_session_free(h);
+			return rc;
+
+		case 'T':
+			rc = trace_replay_test(optarg);
+			lib3270_session_free(h);
+			return rc;
+
 		case 't':
 			lib3270_set_trace_filename(h,optarg);
 			lib3270_set_toggle(h,LIB3270_TOGGLE_DS_TRACE,1);
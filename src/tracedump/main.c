@@ -0,0 +1,364 @@
+/*
+ * "Software PW3270, desenvolvido com base nos códigos fontes do WC3270  e  X3270
+ * (Paul Mattes Paul.Mattes@usa.net), de emulação de terminal 3270 para acesso a
+ * aplicativos mainframe. Registro no INPI sob o nome G3270.
+ *
+ * Copyright (C) <2008> <Banco do Brasil S.A.>
+ *
+ * Este programa é software livre. Você pode redistribuí-lo e/ou modificá-lo sob
+ * os termos da GPL v.2 - Licença Pública Geral  ',  conforme  publicado  pela
+ * Free Software Foundation.
+ *
+ * Este programa é distribuído na expectativa de  ser  útil,  mas  SEM  QUALQUER
+ * GARANTIA; sem mesmo a garantia implícita de COMERCIALIZAÇÃO ou  de  ADEQUAÇÃO
+ * A QUALQUER PROPÓSITO EM PARTICULAR. Consulte a Licença Pública Geral GNU para
+ * obter mais detalhes.
+ *
+ * Você deve ter recebido uma cópia da Licença Pública Geral GNU junto com este
+ * programa; se não, escreva para a Free Software Foundation, Inc., 51 Franklin
+ * St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Este programa está nomeado como main.c e possui - linhas de código.
+ *
+ * Contatos:
+ *
+ * perry.werneck@gmail.com	(Alexandre Perry de Souza Werneck)
+ * erico.mendonca@gmail.com	(Erico Mascarenhas de Mendonça)
+ *
+ */
+
+/**
+ * @brief Binary trace decoder.
+ *
+ * Usage: lib3270-tracedump [--ds] [--session=serial] tracefile [tracefile...]
+ *
+ * Renders binary trace files (lib3270_set_binary_trace_filename()) in the
+ * network trace format or, with --ds, replays the host data through a session
+ * with the data stream trace enabled.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <getopt.h>
+#include <time.h>
+
+#include <lib3270.h>
+#include <lib3270/internals.h>
+#include <lib3270/properties.h>
+#include <lib3270/toggle.h>
+#include <lib3270/trace.h>
+#include <lib3270/charset.h>
+
+#define NETDUMP_MAX 121
+
+/// @brief Replay session for data stream rendering.
+typedef struct _replay {
+	unsigned long	  serial;
+	H3270			* hSession;
+} REPLAY;
+
+static struct {
+	int				  ds;
+	unsigned long	  serial;		///< @brief Session filter (0 for all).
+	H3270			* hSession;		///< @brief Session for charset conversion.
+	size_t			  count;
+	REPLAY			* replays;
+} dump;
+
+/*---[ Implement ]------------------------------------------------------------------------------------------*/
+
+static unsigned long get_uint32(const unsigned char *ptr) {
+	return ((unsigned long) ptr[0]) | (((unsigned long) ptr[1]) << 8) | (((unsigned long) ptr[2]) << 16) | (((unsigned long) ptr[3]) << 24);
+}
+
+static unsigned long long get_uint64(const unsigned char *ptr) {
+	return ((unsigned long long) get_uint32(ptr)) | (((unsigned long long) get_uint32(ptr+4)) << 32);
+}
+
+static int trace_handler(const H3270 *hSession, void *userdata, const char *message) {
+	(void) hSession;
+	(void) userdata;
+	fputs(message,stdout);
+	return 0;
+}
+
+static H3270 * get_replay(unsigned long serial) {
+
+	size_t ix;
+
+	for(ix = 0; ix < dump.count; ix++) {
+		if(dump.replays[ix].serial == serial)
+			return dump.replays[ix].hSession;
+	}
+
+	dump.replays = realloc(dump.replays,(dump.count+1) * sizeof(REPLAY));
+	dump.replays[dump.count].serial = serial;
+	dump.replays[dump.count].hSession = lib3270_session_new("");
+
+	lib3270_set_trace_handler(dump.replays[dump.count].hSession,trace_handler,NULL);
+	lib3270_set_toggle(dump.replays[dump.count].hSession,LIB3270_TOGGLE_DS_TRACE,1);
+
+	return dump.replays[dump.count++].hSession;
+
+}
+
+/// @brief Apply the model of a LIB3270_BINARY_TRACE_MODEL record to the replay session.
+static void set_model(H3270 *hSession, const unsigned char *data, size_t length) {
+
+	char			text[40];
+	char			oversize[40];
+	unsigned int	model = 0;
+
+	if(length >= sizeof(text))
+		length = sizeof(text)-1;
+
+	memcpy(text,data,length);
+	text[length] = 0;
+	*oversize = 0;
+
+	if(sscanf(text,"%u %39s",&model,oversize) < 1)
+		return;
+
+	// lib3270_set_model_number() resets the terminal name and only rebuilds it when the
+	// screen size changes, don't call it (or change the oversize) without a reason.
+	if(lib3270_get_model_number(hSession) != model)
+		lib3270_set_model_number(hSession,model);
+
+	{
+		const char * current = lib3270_get_oversize(hSession);
+
+		if(*oversize ? (!current || strcasecmp(current,oversize)) : current != NULL)
+			lib3270_set_oversize(hSession,*oversize ? oversize : NULL);
+	}
+
+}
+
+/// @brief Render network data as trace_netdata() does.
+static void network_data(char direction, unsigned long long timestamp, const unsigned char *data, size_t length) {
+
+	static const char hexdigits[] = "0123456789abcdef";
+
+	char	  l1[NETDUMP_MAX+2];
+	char	  l2[NETDUMP_MAX+2];
+	char	  l3[NETDUMP_MAX+2];
+	time_t	  ltime = (time_t) (timestamp / 1000000ULL);
+	size_t	  offset;
+	int		  col = 0;
+
+	strftime(l1, 81, "%x %X", localtime(&ltime));
+	printf("%c %s %s data len=%u\n\n",direction,l1,direction == '>' ? "SEND" : "RECV", (unsigned int) length);
+
+	for(offset = 0; offset < length; offset++) {
+		unsigned char chr = data[offset];
+
+		lib3270_ebc2asc(dump.hSession,&chr,1);
+
+		l1[col] = (chr >= ' ' ? chr : '.');
+		l2[col] = hexdigits[data[offset] >> 4];
+		l3[col] = hexdigits[data[offset] & 0x0f];
+
+		if(++col >= NETDUMP_MAX) {
+			l1[col] = l2[col] = l3[col] = 0;
+			printf("\t%s\n\t%s\n\t%s\n\n",l1,l2,l3);
+			col = 0;
+		}
+	}
+
+	if(col) {
+		l1[col] = l2[col] = l3[col] = 0;
+		printf("\t%s\n\t%s\n\t%s\n\n",l1,l2,l3);
+	}
+
+}
+
+static void record(const LIB3270_BINARY_TRACE_RECORD *rec, const unsigned char *data, size_t length) {
+
+	unsigned long		  serial	= get_uint32(rec->serial);
+	unsigned long long	  timestamp	= get_uint64(rec->timestamp);
+
+	if(dump.serial && dump.serial != serial)
+		return;
+
+	if(!dump.ds) {
+
+		switch(rec->type) {
+		case LIB3270_BINARY_TRACE_DATA:
+			network_data((char) rec->direction,timestamp,data,length);
+			break;
+
+		case LIB3270_BINARY_TRACE_CONNECT:
+			printf("Session %lu connected to %.*s\n\n",serial,(int) length,(const char *) data);
+			break;
+
+		case LIB3270_BINARY_TRACE_DISCONNECT:
+			printf("Session %lu disconnected\n\n",serial);
+			break;
+
+		case LIB3270_BINARY_TRACE_MODEL:
+			printf("Session %lu model %.*s\n\n",serial,(int) length,(const char *) data);
+			break;
+		}
+
+		return;
+
+	}
+
+	// Data stream trace; replay the host data, the session traces its own responses.
+	{
+		H3270 * hSession = get_replay(serial);
+
+		switch(rec->type) {
+		case LIB3270_BINARY_TRACE_DATA:
+			if(rec->direction != '<')
+				break;
+
+			if(!lib3270_is_connected(hSession))
+				lib3270_replay_connect(hSession);
+
+			lib3270_data_recv(hSession,length,data);
+			break;
+
+		case LIB3270_BINARY_TRACE_CONNECT:
+			if(lib3270_is_connected(hSession))
+				lib3270_disconnect(hSession);
+			printf("Session %lu connected to %.*s\n",serial,(int) length,(const char *) data);
+			lib3270_replay_connect(hSession);
+			break;
+
+		case LIB3270_BINARY_TRACE_DISCONNECT:
+			if(lib3270_is_connected(hSession))
+				lib3270_disconnect(hSession);
+			break;
+
+		case LIB3270_BINARY_TRACE_MODEL:
+			// The model can't be changed on a connected session.
+			if(lib3270_is_connected(hSession))
+				lib3270_disconnect(hSession);
+			set_model(hSession,data,length);
+			break;
+		}
+
+	}
+
+}
+
+static int load(const char *filename) {
+
+	FILE							* in = fopen(filename,"rb");
+	LIB3270_BINARY_TRACE_HEADER		  header;
+	LIB3270_BINARY_TRACE_RECORD		  rec;
+	size_t							  record_size;
+	unsigned char					* data = NULL;
+	size_t							  size = 0;
+	int								  rc = 0;
+
+	if(!in) {
+		perror(filename);
+		return errno;
+	}
+
+	if(fread(&header,sizeof(header),1,in) != 1 || memcmp(header.magic,LIB3270_BINARY_TRACE_MAGIC,sizeof(header.magic))) {
+		fprintf(stderr,"%s: Not a lib3270 binary trace\n",filename);
+		fclose(in);
+		return EINVAL;
+	}
+
+	if((header.version[0] | (header.version[1] << 8)) > LIB3270_BINARY_TRACE_VERSION) {
+		fprintf(stderr,"%s: Unsupported trace version %u\n",filename,(unsigned int) (header.version[0] | (header.version[1] << 8)));
+		fclose(in);
+		return EINVAL;
+	}
+
+	// Newer versions can extend the record header.
+	record_size = header.record_size[0] | (header.record_size[1] << 8);
+	if(record_size < sizeof(rec)) {
+		fprintf(stderr,"%s: Invalid record size\n",filename);
+		fclose(in);
+		return EINVAL;
+	}
+
+	while(fread(&rec,sizeof(rec),1,in) == 1) {
+
+		size_t length = get_uint32(rec.length);
+
+		if(record_size > sizeof(rec) && fseek(in,record_size - sizeof(rec),SEEK_CUR)) {
+			rc = errno;
+			break;
+		}
+
+		if(length > size) {
+			size = length;
+			data = realloc(data,size);
+		}
+
+		if(length && fread(data,length,1,in) != 1) {
+			fprintf(stderr,"%s: Truncated record\n",filename);
+			rc = EINVAL;
+			break;
+		}
+
+		record(&rec,data,length);
+
+	}
+
+	free(data);
+	fclose(in);
+
+	return rc;
+}
+
+int main(int argc, char *argv[]) {
+
+	static const struct option options[] = {
+		{ "ds",			no_argument,		0,	'd' },
+		{ "network",	no_argument,		0,	'n' },
+		{ "session",	required_argument,	0,	's' },
+		{ 0, 0, 0, 0}
+	};
+
+	int		  opt;
+	int		  rc = 0;
+	size_t	  ix;
+
+	while((opt = getopt_long(argc, argv, "dns:", options, NULL)) != -1) {
+		switch(opt) {
+		case 'd':
+			dump.ds = 1;
+			break;
+
+		case 'n':
+			dump.ds = 0;
+			break;
+
+		case 's':
+			dump.serial = strtoul(optarg,NULL,10);
+			break;
+
+		default:
+			optind = argc;
+		}
+	}
+
+	if(optind >= argc) {
+		fprintf(stderr,"Usage: %s [--ds] [--session=serial] tracefile [tracefile...]\n",argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	dump.hSession = lib3270_session_new("");
+
+	for(; optind < argc && !rc; optind++)
+		rc = load(argv[optind]);
+
+	for(ix = 0; ix < dump.count; ix++)
+		lib3270_session_free(dump.replays[ix].hSession);
+	free(dump.replays);
+
+	lib3270_session_free(dump.hSession);
+
+	return rc ? EXIT_FAILURE : EXIT_SUCCESS;
+
+}